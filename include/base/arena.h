@@ -0,0 +1,71 @@
+/**
+ * @file include/base/arena.h
+ *
+ * Bump allocator over a pre-alloc'ed buffer. Everything alloc'ed from an arena
+ * is released at once, by reseting it
+ */
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <GFraMe/gfmError.h>
+
+#include <stddef.h>
+
+typedef struct stArena arena;
+
+/** An arena; It's never alloc'ed by itself, so it may be embedded into other
+ * structs */
+struct stArena {
+    /** The arena's buffer */
+    char *pBase;
+    /** Size of the buffer, in bytes */
+    size_t size;
+    /** How many bytes are currently in use */
+    size_t used;
+    /** Most bytes ever used at once (useful for tuning the arena's size) */
+    size_t highWater;
+};
+
+/**
+ * Initialize an arena over a buffer
+ *
+ * @param  [ in]pArena The arena
+ * @param  [ in]pMem   The buffer
+ * @param  [ in]size   The buffer's size, in bytes
+ */
+void arena_init(arena *pArena, void *pMem, size_t size);
+
+/**
+ * Alloc (and clean) a block from the arena, aligned to the architecture's word
+ *
+ * @param  [out]ppMem  The alloc'ed block
+ * @param  [ in]pArena The arena
+ * @param  [ in]size   How many bytes should be alloc'ed
+ * @return             GFraMe return value
+ */
+gfmRV arena_alloc(void **ppMem, arena *pArena, size_t size);
+
+/**
+ * Retrieve the arena's current position, so it may later be rewound
+ *
+ * @param  [ in]pArena The arena
+ * @return             The current position
+ */
+size_t arena_getMark(arena *pArena);
+
+/**
+ * Release everything alloc'ed after a given position
+ *
+ * @param  [ in]pArena The arena
+ * @param  [ in]mark   Position retrieved by arena_getMark
+ */
+void arena_rewind(arena *pArena, size_t mark);
+
+/**
+ * Release everything alloc'ed from the arena
+ *
+ * @param  [ in]pArena The arena
+ */
+void arena_reset(arena *pArena);
+
+#endif /* __ARENA_H__ */
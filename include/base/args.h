@@ -0,0 +1,36 @@
+/**
+ * @file include/base/args.h
+ *
+ * Parse the command line arguments
+ */
+#ifndef __ARGS_H__
+#define __ARGS_H__
+
+#include <GFraMe/gfmError.h>
+
+/**
+ * Parse every argument and set the related flags on pGame
+ *
+ * Accepted arguments:
+ *   --headless   Only simulate the game (no window, audio nor rendering)
+ *   --frames=N   Number of frames simulated in headless mode
+ *   --record=F   Record the input of every frame into the file F
+ *   --replay=F   Play back the input recorded into the file F
+ *   --profile=F  Measure every phase of the frame and write a report to F
+ *   --speed=N    Fast-forward the simulation N times (up to
+ *                FRAMESKIP_MAX_SPEED)
+ *   --seed=N     Session seed (by default, the current time; When playing
+ *                back, the recorded seed is used instead)
+ *   --software   Headless, but render every frame with the software renderer
+ *   --scale=N    Upscale software rendered frames N times (up to
+ *                SOFTRENDER_MAX_SCALE; By default, as much as fits the window)
+ *   --dump=P     Dump every software rendered frame into P000000.ppm,
+ *                P000001.ppm...
+ *
+ * @param  [ in]argc Number of arguments
+ * @param  [ in]argv List of arguments
+ * @return           GFraMe return value
+ */
+gfmRV args_parse(int argc, char *argv[]);
+
+#endif /* __ARGS_H__ */
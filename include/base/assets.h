@@ -8,6 +8,25 @@
 
 #include <GFraMe/gfmError.h>
 
+/**
+ * Retrieve the path of an asset, relative to the game's binary (i.e., where the
+ * framework loads every asset from), for assets not loaded by the framework
+ *
+ * @param  [out]pPath  The asset's path
+ * @param  [ in]maxLen How many characters fit into pPath
+ * @param  [ in]pAsset The asset, relative to the assets directory
+ * @return             GFraMe return value
+ */
+gfmRV assets_getPath(char *pPath, int maxLen, char *pAsset);
+
+/**
+ * Load only the texture and create its spritesets (e.g., when no audio will
+ * be played)
+ *
+ * @return GFraMe return value
+ */
+gfmRV assets_loadGraphics();
+
 /**
  * Load all assets
  *
@@ -0,0 +1,82 @@
+/**
+ * @file include/base/broadphase.h
+ *
+ * Persistent broad phase over the spatial grid. Bodies at rest stay bucketed
+ * on the grid (they're inserted only once, on level load) and only the bodies
+ * that moved on the current step are checked for overlaps
+ */
+#ifndef __BROADPHASE_STRUCT_H__
+#define __BROADPHASE_STRUCT_H__
+
+/** Export the broadPhase 'class' */
+typedef struct stBroadPhase broadPhase;
+
+#endif  /* __BROADPHASE_STRUCT_H__ */
+
+#ifndef __BROADPHASE_H__
+#define __BROADPHASE_H__
+
+#include <GFraMe/gfmError.h>
+
+#include <base/grid.h>
+
+/** Most overlaps reported for a single moving body */
+#define BP_MAX_OVERLAPS 32
+
+/**
+ * Release the broad phase (it belongs to the level arena, so this only clears
+ * the reference)
+ *
+ * @param  [ in]ppCtx The broad phase
+ */
+void broadphase_free(broadPhase **ppCtx);
+
+/**
+ * Alloc a new broad phase from the level arena
+ *
+ * @param  [out]ppCtx     The alloc'ed broad phase
+ * @param  [ in]pGrid     Grid where every body is bucketed
+ * @param  [ in]maxBodies How many bodies there may be (the same as the grid's
+ *                        entries)
+ * @return                GFraMe return value
+ */
+gfmRV broadphase_getNew(broadPhase **ppCtx, spatialGrid *pGrid, int maxBodies);
+
+/**
+ * Signal that a body moved (or must be checked) on the current step
+ *
+ * @param  [ in]pCtx The broad phase
+ * @param  [ in]id   The body's ID on the grid
+ * @return           GFraMe return value
+ */
+gfmRV broadphase_wake(broadPhase *pCtx, int id);
+
+/**
+ * Find every pair of overlapping bodies in which at least one was woken on
+ * this step. The pairs are stored on the broad phase (overwriting the previous
+ * run's) and every body goes back to rest
+ *
+ * @param  [ in]pCtx The broad phase
+ * @return           GFraMe return value
+ */
+gfmRV broadphase_run(broadPhase *pCtx);
+
+/**
+ * Retrieve the pairs found by the last broadphase_run
+ *
+ * @param  [out]ppPairs The pairs, as a list of IDs (i.e., the first pair is
+ *                      (ppPairs[0], ppPairs[1]))
+ * @param  [ in]pCtx    The broad phase
+ * @return              The number of pairs
+ */
+int broadphase_getPairs(int **ppPairs, broadPhase *pCtx);
+
+/**
+ * Mostly for debug, record the number of bodies checked and pairs found by the
+ * last run
+ *
+ * @param  [ in]pCtx The broad phase
+ */
+void broadphase_draw(broadPhase *pCtx);
+
+#endif /* __BROADPHASE_H__ */
@@ -8,13 +8,43 @@
 
 #include <GFraMe/gfmError.h>
 
+#include <ggj16/type.h>
+
+/**
+ * Handle two overlapping bodies; The bodies are always passed in the same
+ * order as their types were registered
+ *
+ * @param  [ in]id1 The first body's ID on the grid
+ * @param  [ in]id2 The second body's ID on the grid
+ * @return          GFraMe return value
+ */
+typedef gfmRV (*collisionHandler)(int id1, int id2);
+
 /**
- * Continue the currently executing collision and handle the interaction of
- * objects
+ * Register every collision handler
+ *
+ * @return GFraMe return value
+ */
+gfmRV collision_init();
+
+/**
+ * Register the handler for a pair of types (for both orders in which they may
+ * overlap)
+ *
+ * @param  [ in]type1   The first type
+ * @param  [ in]type2   The second type
+ * @param  [ in]handler The handler
+ * @return              GFraMe return value
+ */
+gfmRV collision_register(itemType type1, itemType type2,
+        collisionHandler handler);
+
+/**
+ * Find every pair of bodies overlapping on this step (through the broad phase)
+ * and handle the interaction of objects
  *
  * @return GFraMe return value
  */
 gfmRV collision_run();
 
 #endif /* __COLLISION_H__ */
-
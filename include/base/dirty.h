@@ -0,0 +1,106 @@
+/**
+ * @file include/base/dirty.h
+ *
+ * Tracks which regions of the virtual screen changed between rendered frames.
+ * Everything drawn is marked into a grid of cells along with a hash of what
+ * was drawn, so each cell ends up with a signature of its contents; Cells whose
+ * signature differs from the previously rendered frame are dirty, and are
+ * merged into as few rectangles as possible
+ */
+#ifndef __DIRTY_STRUCT_H__
+#define __DIRTY_STRUCT_H__
+
+/** Export the dirty regions 'class' */
+typedef struct stDirtyRects dirtyRects;
+/** Export the dirty rectangle */
+typedef struct stDirtyRect dirtyRect;
+
+#endif /* __DIRTY_STRUCT_H__ */
+
+#ifndef __DIRTY_H__
+#define __DIRTY_H__
+
+#include <GFraMe/gfmError.h>
+
+/** Dimensions of each of the grid's (square) cells, in pixels */
+#define DIRTY_CELL 8
+
+/** A region that must be redrawn */
+struct stDirtyRect {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+/**
+ * Release the dirty regions
+ *
+ * @param  [ in]ppCtx The dirty regions
+ */
+void dirty_free(dirtyRects **ppCtx);
+
+/**
+ * Alloc a new dirty regions tracker (everything is dirty on the first frame)
+ *
+ * @param  [out]ppCtx The alloc'ed dirty regions
+ * @return            GFraMe return value
+ */
+gfmRV dirty_getNew(dirtyRects **ppCtx);
+
+/**
+ * Make the whole screen dirty on the next frame (e.g., because whatever was
+ * rendered may no longer match its signature)
+ *
+ * @param  [ in]pCtx The dirty regions
+ */
+void dirty_invalidate(dirtyRects *pCtx);
+
+/**
+ * Start marking a new frame
+ *
+ * @param  [ in]pCtx The dirty regions
+ */
+void dirty_begin(dirtyRects *pCtx);
+
+/**
+ * Mark something drawn over an area. Its hash should identify what was drawn
+ * (but not where, as that's already accounted for), and the order in which
+ * things are marked matters
+ *
+ * @param  [ in]pCtx   The dirty regions
+ * @param  [ in]x      The area's horizontal position
+ * @param  [ in]y      The area's vertical position
+ * @param  [ in]width  The area's width
+ * @param  [ in]height The area's height
+ * @param  [ in]hash   Hash of what was drawn
+ */
+void dirty_mark(dirtyRects *pCtx, int x, int y, int width, int height,
+        unsigned int hash);
+
+/**
+ * Finish marking the frame, comparing it with the previous one and merging
+ * every dirty cell into rectangles
+ *
+ * @param  [ in]pCtx The dirty regions
+ */
+void dirty_end(dirtyRects *pCtx);
+
+/**
+ * Retrieve the rectangles that must be redrawn on the current frame
+ *
+ * @param  [out]ppRects The rectangles
+ * @param  [out]pNum    How many rectangles there are
+ * @param  [ in]pCtx    The dirty regions
+ */
+void dirty_getRects(dirtyRect **ppRects, int *pNum, dirtyRects *pCtx);
+
+/**
+ * Retrieve how many pixels must be redrawn on the current frame
+ *
+ * @param  [ in]pCtx The dirty regions
+ * @return           The number of pixels
+ */
+int dirty_getArea(dirtyRects *pCtx);
+
+#endif /* __DIRTY_H__ */
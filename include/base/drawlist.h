@@ -0,0 +1,193 @@
+/**
+ * @file include/base/drawlist.h
+ *
+ * Double-buffered list of draw commands. The state records everything that
+ * should be rendered into the back buffer (right after it's updated), and the
+ * renderer consumes the front buffer (i.e., the last completely recorded
+ * frame)
+ *
+ * Every command is recorded into a layer. When the back buffer is finished,
+ * its commands are (stably) sorted by layer and spriteset, so the renderer
+ * submits every quad of a layer/spriteset as a single run, regardless of the
+ * order in which they were recorded
+ */
+#ifndef __DRAWLIST_STRUCT__
+#define __DRAWLIST_STRUCT__
+
+typedef struct stDrawList drawList;
+
+#endif /* __DRAWLIST_STRUCT__ */
+
+#ifndef __DRAWLIST_H__
+#define __DRAWLIST_H__
+
+#include <GFraMe/gfmError.h>
+#include <GFraMe/gfmSprite.h>
+#include <GFraMe/gfmTilemap.h>
+
+/** Spritesets that may be referenced by a command (each one is twice as big
+ * as the previous, so its tile size is '2 << id') */
+enum enSpritesetId {
+    SSET_2x2 = 0,
+    SSET_4x4,
+    SSET_8x8,
+    SSET_16x16,
+    SSET_32x32,
+    SSET_64x64,
+    SSET_MAX
+};
+typedef enum enSpritesetId spritesetId;
+
+/** Retrieve the width/height of a spriteset's tile */
+#define SSET_TILE_SIZE(id) (2 << (id))
+
+/** Layers into which commands are recorded, from the bottom to the top; Within
+ * a layer, commands are grouped by spriteset (and keep the recorded order) */
+enum enDrawLayer {
+    DRAW_LAYER_BACKGROUND = 0,
+    DRAW_LAYER_RECIPE,
+    DRAW_LAYER_MASK,
+    DRAW_LAYER_CAULDRON,
+    DRAW_LAYER_FIRE,
+    DRAW_LAYER_ITEMS,
+    DRAW_LAYER_DEBUG,
+    DRAW_LAYER_MAX
+};
+typedef enum enDrawLayer drawLayer;
+
+/**
+ * Release the list
+ *
+ * @param  [ in]ppCtx The list
+ */
+void drawlist_free(drawList **ppCtx);
+
+/**
+ * Alloc a new list
+ *
+ * @param  [out]ppCtx The alloc'ed list
+ * @return            GFraMe return value
+ */
+gfmRV drawlist_getNew(drawList **ppCtx);
+
+/**
+ * Start recording a new frame into the back buffer
+ *
+ * @param  [ in]pCtx The list
+ */
+void drawlist_begin(drawList *pCtx);
+
+/**
+ * Finish recording the back buffer (sorting its commands) and make it the one
+ * rendered
+ *
+ * @param  [ in]pCtx The list
+ */
+void drawlist_swap(drawList *pCtx);
+
+/**
+ * Set the layer into which the following commands are recorded (reset to
+ * DRAW_LAYER_BACKGROUND on drawlist_begin)
+ *
+ * @param  [ in]pCtx  The list
+ * @param  [ in]layer The layer
+ */
+void drawlist_setLayer(drawList *pCtx, drawLayer layer);
+
+/**
+ * Record a single tile
+ *
+ * @param  [ in]pCtx  The list
+ * @param  [ in]sset  The tile's spriteset
+ * @param  [ in]x     The tile's horizontal position
+ * @param  [ in]y     The tile's vertical position
+ * @param  [ in]tile  The tile
+ * @param  [ in]isFlipped Whether the tile is horizontally flipped
+ * @return            GFraMe return value
+ */
+gfmRV drawlist_pushTile(drawList *pCtx, spritesetId sset, int x, int y,
+        int tile, int isFlipped);
+
+/**
+ * Record a number (each digit uses the atlas' ASCII glyphs, which start at tile
+ * 0 for ' ')
+ *
+ * @param  [ in]pCtx      The list
+ * @param  [ in]sset      The digits' spriteset
+ * @param  [ in]x         The number's horizontal position
+ * @param  [ in]y         The number's vertical position
+ * @param  [ in]num       The number
+ * @param  [ in]numDigits How many digits should be rendered
+ * @return                GFraMe return value
+ */
+gfmRV drawlist_pushNumber(drawList *pCtx, spritesetId sset, int x, int y,
+        int num, int numDigits);
+
+/**
+ * Record a sprite's current frame on its current position
+ *
+ * @param  [ in]pCtx The list
+ * @param  [ in]sset The sprite's spriteset
+ * @param  [ in]pSpr The sprite
+ * @return           GFraMe return value
+ */
+gfmRV drawlist_pushSprite(drawList *pCtx, spritesetId sset, gfmSprite *pSpr);
+
+/**
+ * Record every visible tile in a tilemap
+ *
+ * @param  [ in]pCtx  The list
+ * @param  [ in]sset  The tilemap's spriteset
+ * @param  [ in]pTMap The tilemap
+ * @param  [ in]x     The tilemap's horizontal position
+ * @param  [ in]y     The tilemap's vertical position
+ * @return            GFraMe return value
+ */
+gfmRV drawlist_pushTilemap(drawList *pCtx, spritesetId sset,
+        gfmTilemap *pTMap, int x, int y);
+
+/**
+ * Record a batch of tiles (all on the same spriteset). The batch is stored
+ * within the list, and the caller must fill every returned array (until the
+ * next command is recorded)
+ *
+ * @param  [out]ppX     The tiles' horizontal positions
+ * @param  [out]ppY     The tiles' vertical positions
+ * @param  [out]ppTiles The tiles
+ * @param  [ in]pCtx    The list
+ * @param  [ in]sset    The tiles' spriteset
+ * @param  [ in]num     How many tiles there are in the batch
+ * @return              GFraMe return value
+ */
+gfmRV drawlist_pushBatch(short **ppX, short **ppY, short **ppTiles,
+        drawList *pCtx, spritesetId sset, int num);
+
+/**
+ * Record a static batch of tiles (all on the same spriteset). Differently from
+ * drawlist_pushBatch, the tiles aren't copied: they must be kept unchanged
+ * (and alive) for as long as they may be rendered (e.g., alloc'ed from the
+ * level arena), so a backend may cache whatever it renders from them
+ *
+ * @param  [ in]pCtx  The list
+ * @param  [ in]sset  The tiles' spriteset
+ * @param  [ in]pData The tiles, as planes (every horizontal position, every
+ *                    vertical position and then every tile)
+ * @param  [ in]num   How many tiles there are in the batch
+ * @return            GFraMe return value
+ */
+gfmRV drawlist_pushStatic(drawList *pCtx, spritesetId sset, short *pData,
+        int num);
+
+/**
+ * Render every command on the front buffer, one run of quads (with the same
+ * layer and spriteset) at a time. If there's a software renderer, everything
+ * is rendered through it instead of the framework; And, if the dirty regions
+ * are being tracked, only what changed since the last rendered frame is
+ * redrawn
+ *
+ * @param  [ in]pCtx The list
+ * @return           GFraMe return value
+ */
+gfmRV drawlist_render(drawList *pCtx);
+
+#endif /* __DRAWLIST_H__ */
@@ -0,0 +1,53 @@
+/**
+ * @file include/base/frameskip.h
+ *
+ * Controls how much time is simulated and which frames are rendered, honoring
+ * GAME_RUN/GAME_STEP (pausing and stepping), GAME_SKIP_1/GAME_SKIP_2 (skipping
+ * the rendering when the update is over budget) and the fast-forward speed
+ */
+#ifndef __FRAMESKIP_H__
+#define __FRAMESKIP_H__
+
+#include <GFraMe/gfmError.h>
+
+/** Fastest fast-forward speed */
+#define FRAMESKIP_MAX_SPEED 8
+
+/**
+ * Handle the debug controls (pause, step and fast-forward). Must be called
+ * once every frame, even if paused
+ *
+ * @return GFraMe return value
+ */
+gfmRV frameskip_handleInput();
+
+/**
+ * Convert the time elapsed since the previous frame into how much time should
+ * be simulated
+ *
+ * @param  [ in]frameTime Time elapsed since the previous frame, in miliseconds
+ * @param  [ in]stepTime  Duration of the next simulation step, in miliseconds
+ * @return                Time that should be simulated, in miliseconds
+ */
+int frameskip_getSimulatedTime(int frameTime, int stepTime);
+
+/**
+ * Start measuring the cost of the current frame's update
+ */
+void frameskip_beginUpdate();
+
+/**
+ * Finish measuring the cost of the current frame's update and, if it went over
+ * the frame's budget, skip rendering one or two frames
+ */
+void frameskip_endUpdate();
+
+/**
+ * Check whether the current frame should be rendered (consuming any pending
+ * skip)
+ *
+ * @return GFMRV_TRUE, GFMRV_FALSE
+ */
+gfmRV frameskip_shouldDraw();
+
+#endif /* __FRAMESKIP_H__ */
@@ -34,6 +34,28 @@
  * which is called by default on debug mode */
 #define FPS_X       0
 #define FPS_Y       0
+/** Default number of steps simulated in headless mode (1 minute at 120 Hz) */
+#define HEADLESS_FRAMES 7200
+/** Atlas loaded by the software renderer (relative to the assets directory,
+ * just like the framework's texture) */
+#define SOFT_ATLAS      "gfx/atlas.bmp"
+/** Longest path to an asset not loaded by the framework */
+#define MAX_ASSET_PATH  1024
+/** Longest frame that is simulated, in miliseconds (anything longer is
+ * simulated as if it took only this long) */
+#define MAX_FRAME_TIME  250
+/** Most pointer positions sampled between two simulation steps (further ones
+ * replace the latest) */
+#define MAX_POINTER_SAMPLES 64
+/** Size of the arena used by the current level (state, objects,
+ * particles...) */
+#define LEVEL_ARENA_SIZE (2 * 1024 * 1024)
+/** Most items that may be placed on a board */
+#define MAX_BOARD_ITEMS 512
+/** Most particles that may be alive at once */
+#define MAX_PARTICLES   32768
+/** Size of the scratch arena, reset every frame */
+#define FRAME_ARENA_SIZE (16 * 1024)
 
 /* == Config file IDs ======================================================= */
 
@@ -43,12 +65,14 @@
 #define CONF_ID_WIDTH       "width"
 #define CONF_ID_HEIGHT      "height"
 #define CONF_ID_FPS         "fps"
+#define CONF_ID_UPS         "ups"
 #define CONF_ID_AUDIOQ      "audio"
 #define CONF_ID_LAST_FLAGS  "lFlags"
 #define CONF_ID_LAST_RES    "lRes"
 #define CONF_ID_LAST_WIDTH  "lWidth"
 #define CONF_ID_LAST_HEIGHT "lHeight"
 #define CONF_ID_LAST_FPS    "lFps"
+#define CONF_ID_LAST_UPS    "lUps"
 #define CONF_ID_LAST_AUDIOQ "lAudio"
 
 /* == Default configuration ================================================= */
@@ -58,22 +82,24 @@
 #define CONF_WIDTH  640
 #define CONF_HEIGHT 480
 #define CONF_FPS    60
+#define CONF_UPS    120
 #define CONF_AUDIOQ gfmAudio_defQuality
 
 /* == ... =================================================================== */
 
 /** Texture's transparent color */
 #define COLORKEY        0xFF00FF
-/** Quadtree position */
-#define QT_X            -8
-#define QT_Y            -8
-/** Quadtree dimensions */
-#define QT_WIDTH        V_WIDTH + 16
-#define QT_HEIGHT       V_HEIGHT + 16
-/** Maximum number of times the quadtree will subdivide */
-#define QT_MAX_DEPTH    6
-/** Number of nodes required for the quadtree to subdivide */
-#define QT_MAX_NODES    10
+/** Dimensions of each of the spatial grid's (square) cells */
+#define GRID_CELL       8
+/** Number of columns and rows on the spatial grid */
+#define GRID_WIDTH      (V_WIDTH / GRID_CELL)
+#define GRID_HEIGHT     (V_HEIGHT / GRID_CELL)
+/** Spatial grid layer of items that may be hovered and dragged */
+#define GRID_LAYER_ITEM     0x1
+/** Spatial grid layer of targets onto which items may be dropped */
+#define GRID_LAYER_TARGET   0x2
+/** Spatial grid ID of the cauldron (items use their index on the item store) */
+#define GRID_ID_CAULDRON    MAX_BOARD_ITEMS
 
 #endif /* __GAME_CONST_H__ */
 
@@ -8,16 +8,28 @@
 
 #include <GFraMe/gframe.h>
 #include <GFraMe/gfmInput.h>
-#include <GFraMe/gfmQuadtree.h>
 #include <GFraMe/gfmSpriteset.h>
 #include <GFraMe/core/gfmAudio_bkend.h>
 
 #include <ggj16/cauldron.h>
 #include <ggj16/gesture.h>
-#include <ggj16/object.h>
+#include <ggj16/itemStore.h>
 #include <ggj16/recipeScroll.h>
 #include <ggj16/state.h>
 
+#include <base/arena.h>
+#include <base/broadphase.h>
+#include <base/dirty.h>
+#include <base/drawlist.h>
+#include <base/game_const.h>
+#include <base/grid.h>
+#include <base/particles.h>
+#include <base/replay.h>
+#include <base/rng.h>
+#include <base/softrender.h>
+
+#include <gen/recipeGen.h>
+
 /* == Types declaration ===================================================== */
 
 typedef struct stGameCtx gameCtx;
@@ -27,6 +39,7 @@ typedef struct stButton button;
 typedef struct stButtonCtx buttonCtx;
 typedef struct stConfigCtx configCtx;
 typedef struct stGlobalCtx globalCtx;
+typedef struct stPointerSample pointerSample;
 
 /* == Aligned size of structs =============================================== */
 
@@ -46,9 +59,10 @@ typedef struct stGlobalCtx globalCtx;
 #define SIZEOF_GLOBALCTX ALIGNED_SIZEOF(globalCtx)
 
 /** Calculate the size of the complete game buffer (so everything is
- * contiguously alloc'ed) */
+ * contiguously alloc'ed, including the arenas' buffers) */
 #define SIZEOF_GAME_MEM (SIZEOF_GAMECTX + SIZEOF_GFXCTX + SIZEOF_AUDIOCTX + \
-        SIZEOF_BUTTONCTX + 2 * SIZEOF_CONFIGCTX + SIZEOF_GLOBALCTX)
+        SIZEOF_BUTTONCTX + 2 * SIZEOF_CONFIGCTX + SIZEOF_GLOBALCTX + \
+        LEVEL_ARENA_SIZE + FRAME_ARENA_SIZE)
 
 /** Define the offsets to each of the structs */
 #define GAME_OFFSET         0
@@ -58,6 +72,8 @@ typedef struct stGlobalCtx globalCtx;
 #define CONFIG_OFFSET       (BUTTON_OFFSET       + SIZEOF_BUTTONCTX)
 #define LASTCONFIG_OFFSET   (CONFIG_OFFSET       + SIZEOF_CONFIGCTX)
 #define GLOBAL_OFFSET       (LASTCONFIG_OFFSET   + SIZEOF_CONFIGCTX)
+#define LEVELARENA_OFFSET   (GLOBAL_OFFSET       + SIZEOF_GLOBALCTX)
+#define FRAMEARENA_OFFSET   (LEVELARENA_OFFSET   + LEVEL_ARENA_SIZE)
 
 /* == Global context declaration ============================================ */
 
@@ -95,11 +111,33 @@ enum enGameFlags {
     GAME_SKIP_2    = 0x00002000,
     /** Overrides 'GAME_STEP' and force the game loop to run normally */
     GAME_RUN       = 0x00020000,
-    /** Renders the quadtree */
-    DBG_RENDERQT   = 0x00000004
+    /** Only simulate the game, without a window, audio or rendering */
+    GAME_HEADLESS  = 0x00200000,
+    /** Record the input of every frame into pGame->pReplayFile */
+    GAME_RECORD    = 0x02000000,
+    /** Replace the input of every frame by the one in pGame->pReplayFile */
+    GAME_PLAYBACK  = 0x20000000,
+    /** Measure every phase of the frame and report it into
+     * pGame->pProfileFile on exit */
+    GAME_PROFILE   = 0x00000040,
+    /** While headless, render every frame with the software renderer */
+    GAME_SOFTWARE  = 0x00000400,
+    /** Renders the broad phase's statistics */
+    DBG_RENDERBP   = 0x00000004
 };
 typedef enum enGameFlags gameFlags;
 
+/** A pointer position, sampled as soon as its motion was handled */
+struct stPointerSample {
+    /** When it was sampled, in miliseconds (only meaningful relative to other
+     * samples) */
+    unsigned int time;
+    /** Horizontal position */
+    int x;
+    /** Vertical position */
+    int y;
+};
+
 /** Store data related to game */
 struct stGameCtx {
     /** The framework's context */
@@ -114,8 +152,43 @@ struct stGameCtx {
     /** If different from 'ST_NONE', the state to which the game must switch on
      * the end of this frame */
     enum enState nextState;
-    /** Time elapsed since the previous frame, in miliseconds */
+    /** Time elapsed since the previous simulation step, in miliseconds */
     int elapsed;
+    /** Number of simulation steps since the game started */
+    int step;
+    /** Time not yet simulated (i.e., less than a step), in miliseconds */
+    int accumulator;
+    /** How far (in the range [0, 1)) the rendered frame is between the
+     * previous and the current simulation step, for interpolation */
+    double alpha;
+    /** How many steps should be simulated in headless mode */
+    int maxFrames;
+    /** Fast-forward multiplier applied to the elapsed time (1 = real time) */
+    int speed;
+    /** Frames not rendered since the last one, while fast-forwarding */
+    int drawCount;
+    /** Pointer's horizontal position (i.e., its latest sample) */
+    int mouseX;
+    /** Pointer's vertical position (i.e., its latest sample) */
+    int mouseY;
+    /** Every position the pointer moved through since the previous
+     * simulation step, in order */
+    pointerSample pSamples[MAX_POINTER_SAMPLES];
+    /** Number of samples in pSamples */
+    int numSamples;
+    /** Input log written/read when recording/playing back */
+    char *pReplayFile;
+    /** CSV report written on exit when profiling */
+    char *pProfileFile;
+    /** Prefix of the images into which software rendered frames are dumped
+     * (none are dumped, if NULL) */
+    char *pDumpPrefix;
+    /** Factor by which software rendered frames are upscaled (derived from
+     * the window's dimensions, if 0) */
+    int scale;
+    /** Session seed, from which every random stream is derived (stored on
+     * the input log, so playing it back is deterministic) */
+    uint64_t seed;
 };
 
 /** Store all handles to texture and spritesets' pointers */
@@ -160,8 +233,14 @@ struct stButtonCtx {
     /** Mouse button */
     button click;
 #if defined(DEBUG)
-    /** Add button to switch rendering of the quadtree */
-    button qt;
+    /** Add button to switch rendering of the broad phase */
+    button bp;
+    /** Pause/resume the simulation */
+    button pause;
+    /** Simulate a single step, while paused */
+    button step;
+    /** Cycle through the fast-forward speeds */
+    button ffwd;
 #endif
 };
 
@@ -183,6 +262,8 @@ struct stConfigCtx {
     int height;
     /** How many frames should be updated and rendered per second */
     int fps;
+    /** How many fixed simulation steps should be run per second */
+    int ups;
     /** Audio quality (frequency, bits per samples and number of channels) */
     gfmAudioQuality audioQuality;
 };
@@ -191,16 +272,36 @@ struct stConfigCtx {
 struct stGlobalCtx {
     /** The cauldron */
     cauldron *pCauldron;
-    /** The quadtree for collision */
-    gfmQuadtreeRoot *pQt;
+    /** Spatial grid used to find what's under the pointer or a dropped item */
+    spatialGrid *pGrid;
+    /** Broad phase for collision, over the spatial grid */
+    broadPhase *pBroadPhase;
+    /** Every item on the board */
+    itemStore *pItems;
+    /** Particles (the fire and the explosion) */
+    particles *pParticles;
     /** Gesture recognizer */
     gesture *pGesture;
-    /** Current object being dragger */
-    object *pDragging;
     /** Current recipe */
     recipeScroll *pRecipe;
-    /** Whether an object is being dragged */
-    int isDragging;
+    /** Generates every recipe (from the data parsed on startup) */
+    recipeGen *pRecipeGen;
+    /** Index of the item being dragged (ITEM_NONE, if none) */
+    int dragging;
+    /** Input recorder/player (only alloc'ed on GAME_RECORD/GAME_PLAYBACK) */
+    replay *pReplay;
+    /** Commands recorded by the current state to be rendered */
+    drawList *pDrawList;
+    /** Software renderer (only alloc'ed on GAME_SOFTWARE) */
+    softRender *pSoftRender;
+    /** What changed since the last software rendered frame */
+    dirtyRects *pDirty;
+    /** Memory used by the current level; Reset when the state is released */
+    arena levelArena;
+    /** Scratch memory; Reset at the start of every frame */
+    arena frameArena;
+    /** Random streams, one for each subsystem (indexed by rngStream) */
+    rng pRng[RNG_MAX];
 };
 
 #endif /* __GAME_CTX_H__ */
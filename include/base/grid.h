@@ -0,0 +1,108 @@
+/**
+ * @file include/base/grid.h
+ *
+ * Uniform spatial grid over the play area. Each entry is a rectangle (with an
+ * ID and a layer) bucketed into every cell it touches, so looking up what's
+ * over a point (or overlapping a rectangle) only checks a few entries
+ */
+#ifndef __GRID_STRUCT_H__
+#define __GRID_STRUCT_H__
+
+/** Export the spatialGrid 'class' */
+typedef struct stSpatialGrid spatialGrid;
+
+#endif  /* __GRID_STRUCT_H__ */
+
+#ifndef __GRID_H__
+#define __GRID_H__
+
+#include <GFraMe/gfmError.h>
+
+/** Returned by queries that didn't find anything */
+#define GRID_NONE -1
+
+/**
+ * Release the grid (it belongs to the level arena, so this only clears the
+ * reference)
+ *
+ * @param  [ in]ppCtx The grid
+ */
+void grid_free(spatialGrid **ppCtx);
+
+/**
+ * Alloc a new grid from the level arena
+ *
+ * @param  [out]ppCtx      The alloc'ed grid
+ * @param  [ in]maxEntries How many entries the grid may hold (every ID must be
+ *                         less than this)
+ * @return                 GFraMe return value
+ */
+gfmRV grid_getNew(spatialGrid **ppCtx, int maxEntries);
+
+/**
+ * Add an entry to the grid
+ *
+ * @param  [ in]pCtx   The grid
+ * @param  [ in]id     The entry's ID
+ * @param  [ in]layer  The entry's layer (a bit mask, checked on queries)
+ * @param  [ in]x      The entry's horizontal position
+ * @param  [ in]y      The entry's vertical position
+ * @param  [ in]width  The entry's width
+ * @param  [ in]height The entry's height
+ * @return             GFraMe return value
+ */
+gfmRV grid_insert(spatialGrid *pCtx, int id, int layer, int x, int y,
+        int width, int height);
+
+/**
+ * Move an entry; It's only re-bucketed if it touches different cells
+ *
+ * @param  [ in]pCtx The grid
+ * @param  [ in]id   The entry's ID
+ * @param  [ in]x    The entry's new horizontal position
+ * @param  [ in]y    The entry's new vertical position
+ * @return           GFraMe return value
+ */
+gfmRV grid_move(spatialGrid *pCtx, int id, int x, int y);
+
+/**
+ * Retrieve the entry (on the given layers) that contains a point; If many do,
+ * the one with the lowest ID is returned
+ *
+ * @param  [ in]pCtx  The grid
+ * @param  [ in]layer Layers that should be checked
+ * @param  [ in]x     The point's horizontal position
+ * @param  [ in]y     The point's vertical position
+ * @return            The entry's ID or GRID_NONE
+ */
+int grid_queryPoint(spatialGrid *pCtx, int layer, int x, int y);
+
+/**
+ * Retrieve the entry (on the given layers) that overlaps a rectangle; If many
+ * do, the one with the lowest ID is returned
+ *
+ * @param  [ in]pCtx   The grid
+ * @param  [ in]layer  Layers that should be checked
+ * @param  [ in]x      The rectangle's horizontal position
+ * @param  [ in]y      The rectangle's vertical position
+ * @param  [ in]width  The rectangle's width
+ * @param  [ in]height The rectangle's height
+ * @return             The entry's ID or GRID_NONE
+ */
+int grid_queryRect(spatialGrid *pCtx, int layer, int x, int y, int width,
+        int height);
+
+/**
+ * Retrieve every entry (on the given layers) that overlaps another entry
+ *
+ * @param  [out]pOut   The overlapping entries' IDs
+ * @param  [ in]pCtx   The grid
+ * @param  [ in]id     The entry being checked
+ * @param  [ in]layer  Layers that should be checked
+ * @param  [ in]maxOut How many IDs fit into pOut
+ * @return             How many entries were found (at most maxOut)
+ */
+int grid_queryOverlaps(int *pOut, spatialGrid *pCtx, int id, int layer,
+        int maxOut);
+
+#endif /* __GRID_H__ */
@@ -9,6 +9,15 @@
 
 #include <GFraMe/gfmError.h>
 
+/**
+ * Sample the pointer as soon as its motion is handled, so the following
+ * simulation step sees every position it moved through (and not only where it
+ * was at the end of the frame). Should be called after handling events
+ *
+ * @return GFraMe return value
+ */
+gfmRV input_samplePointer();
+
 /**
  * Update all buttons' states
  *
@@ -16,6 +25,15 @@
  */
 gfmRV input_updateButtons();
 
+/**
+ * Update all buttons' states for a simulation step run on the same frame as
+ * the previous one. Since no events were handled in between, buttons keep
+ * their states, but nothing is 'just' pressed nor released anymore
+ *
+ * @return GFraMe return value
+ */
+gfmRV input_repeatButtons();
+
 /**
  * Initialize and bind all buttons
  *
@@ -0,0 +1,77 @@
+/**
+ * @file include/base/lod.h
+ *
+ * Level-of-detail controller for cosmetic effects. Tracks the rolling cost of
+ * updating and rendering the last few frames and lowers (or raises) the level
+ * to keep it within the frame's budget
+ */
+#ifndef __LOD_H__
+#define __LOD_H__
+
+/** Number of levels (0 is the highest quality) */
+#define LOD_LEVELS  4
+/** Number of frames averaged before the level may change */
+#define LOD_WINDOW  32
+/** Lower the quality if the average cost goes over this (percentage of the
+ * frame's budget) */
+#define LOD_HIGH_WATER  75
+/** Raise the quality if the average cost goes under this (percentage of the
+ * frame's budget) */
+#define LOD_LOW_WATER   40
+
+/** Attributes scaled by the current level */
+enum enLodAttr {
+    /** How many particles are spawned each frame */
+    LOD_SPAWN = 0,
+    /** How long particles live */
+    LOD_TTL,
+    /** How many particles may be alive at once */
+    LOD_POOL,
+    LOD_ATTR_MAX
+};
+typedef enum enLodAttr lodAttr;
+
+/**
+ * Go back to the highest quality and discard every sample
+ */
+void lod_reset();
+
+/**
+ * Start measuring a section that counts towards the frame's cost
+ */
+void lod_begin();
+
+/**
+ * Stop measuring a section and add its duration to the frame's cost
+ */
+void lod_end();
+
+/**
+ * Add the frame's cost to the rolling window and adjust the level, if needed.
+ * Must be called once every frame
+ */
+void lod_endFrame();
+
+/**
+ * Retrieve the current level
+ *
+ * @return The level (0 is the highest quality)
+ */
+int lod_getLevel();
+
+/**
+ * Scale a value according to the current level; Positive values never go
+ * below 1
+ *
+ * @param  [ in]value The value at the highest quality
+ * @param  [ in]attr  Which attribute is being scaled
+ * @return            The scaled value
+ */
+int lod_scale(int value, lodAttr attr);
+
+/**
+ * Record the current level into the draw list (only on debug mode)
+ */
+void lod_draw();
+
+#endif /* __LOD_H__ */
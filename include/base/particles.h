@@ -0,0 +1,112 @@
+/**
+ * @file include/base/particles.h
+ *
+ * Particle system. Every attribute is stored on its own (16 bytes aligned)
+ * array, so particles are integrated and culled 4 at a time (with SSE, if
+ * available), emitted in bulk and recorded as a single batch
+ */
+#ifndef __PARTICLES_STRUCT_H__
+#define __PARTICLES_STRUCT_H__
+
+/** Export the particles 'class' */
+typedef struct stParticles particles;
+/** Export the emitter 'class' */
+typedef struct stEmitter emitter;
+
+#endif  /* __PARTICLES_STRUCT_H__ */
+
+#ifndef __PARTICLES_H__
+#define __PARTICLES_H__
+
+#include <GFraMe/gfmError.h>
+
+#include <base/drawlist.h>
+
+/** Describes how particles are emitted; Every attribute is picked within its
+ * range ([min, max]) */
+struct stEmitter {
+    /** Spawn position */
+    float x;
+    float y;
+    /** Range of the horizontal velocity, in pixels per second */
+    float vxMin;
+    float vxMax;
+    /** Range of the vertical velocity, in pixels per second */
+    float vyMin;
+    float vyMax;
+    /** Acceleration, in pixels per second squared */
+    float ax;
+    float ay;
+    /** Range of the time to live, in miliseconds */
+    int ttlMin;
+    int ttlMax;
+    /** First tile and how many sequential tiles may be picked */
+    int firstTile;
+    int numTiles;
+};
+
+/**
+ * Release the particle system (it belongs to the level arena, so this only
+ * clears the reference)
+ *
+ * @param  [ in]ppCtx The particle system
+ */
+void particles_free(particles **ppCtx);
+
+/**
+ * Alloc a new particle system from the level arena
+ *
+ * @param  [out]ppCtx        The alloc'ed particle system
+ * @param  [ in]maxParticles How many particles may be alive at once
+ * @return                   GFraMe return value
+ */
+gfmRV particles_getNew(particles **ppCtx, int maxParticles);
+
+/**
+ * Spawn many particles at once; If there's no space for all of them (or if it
+ * would go over the limit), only as many as fit are spawned
+ *
+ * @param  [ in]pCtx     The particle system
+ * @param  [ in]pEmitter How the particles are spawned
+ * @param  [ in]count    How many particles should be spawned
+ * @return               GFraMe return value
+ */
+gfmRV particles_emit(particles *pCtx, emitter *pEmitter, int count);
+
+/**
+ * Set how many particles may be alive at once (clamped to the capacity);
+ * Particles already alive over the limit are kept until they die
+ *
+ * @param  [ in]pCtx  The particle system
+ * @param  [ in]limit The new limit
+ * @return            GFraMe return value
+ */
+gfmRV particles_setLimit(particles *pCtx, int limit);
+
+/**
+ * Integrate every particle and remove the ones that died (or left the screen)
+ *
+ * @param  [ in]pCtx    The particle system
+ * @param  [ in]elapsed Time elapsed since the previous update, in miliseconds
+ * @return              GFraMe return value
+ */
+gfmRV particles_update(particles *pCtx, int elapsed);
+
+/**
+ * Record every particle into the draw list, as a single batch
+ *
+ * @param  [ in]pCtx The particle system
+ * @param  [ in]sset The particles' spriteset
+ * @return           GFraMe return value
+ */
+gfmRV particles_draw(particles *pCtx, spritesetId sset);
+
+/**
+ * Retrieve how many particles are alive
+ *
+ * @param  [ in]pCtx The particle system
+ * @return           The number of particles
+ */
+int particles_getCount(particles *pCtx);
+
+#endif /* __PARTICLES_H__ */
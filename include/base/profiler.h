@@ -0,0 +1,68 @@
+/**
+ * @file include/base/profiler.h
+ *
+ * Measures how long each phase of a frame takes (with a monotonic clock) and
+ * reports its percentiles on exit
+ */
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <GFraMe/gfmError.h>
+
+/** Number of samples kept for each phase (must be a power of 2) */
+#define PROF_RING_SIZE 4096
+
+/** Every measured phase */
+enum enProfPhase {
+    /* Main loop */
+    PROF_EVENTS = 0,
+    PROF_INPUT,
+    PROF_UPDATE,
+    PROF_ANIMATE,
+    PROF_DRAW,
+    PROF_RENDER,
+    PROF_PRESENT,
+    /* gs_update */
+    PROF_GESTURE,
+    PROF_COLLISION,
+    PROF_SCROLL,
+    PROF_TILEMAP,
+    PROF_OBJECTS,
+    PROF_CAULDRON,
+    PROF_FIRE,
+    PROF_MAX
+};
+typedef enum enProfPhase profPhase;
+
+/**
+ * Retrieve the current time from a monotonic clock
+ *
+ * @return The time, in nanoseconds
+ */
+unsigned long long profiler_getTime();
+
+/**
+ * Start measuring a phase. Does nothing if GAME_PROFILE isn't set
+ *
+ * @param  [ in]phase The phase
+ */
+void profiler_begin(profPhase phase);
+
+/**
+ * Stop measuring a phase and store its sample. Does nothing if GAME_PROFILE
+ * isn't set
+ *
+ * @param  [ in]phase The phase
+ */
+void profiler_end(profPhase phase);
+
+/**
+ * Write the p50, p95, p99 and max of every phase (in microseconds) to a CSV
+ * file
+ *
+ * @param  [ in]pFilename The CSV file
+ * @return                GFraMe return value
+ */
+gfmRV profiler_writeReport(char *pFilename);
+
+#endif /* __PROFILER_H__ */
@@ -0,0 +1,66 @@
+/**
+ * @file include/base/replay.h
+ *
+ * Records the input of every frame into a compact binary log, so it may be
+ * later replayed deterministically
+ *
+ * The log starts with a header ("GGJR", the version, the number of buttons and
+ * the session seed, as 8 little-endian bytes), followed by one entry per
+ * frame:
+ *   - elapsed time, as an unsigned varint
+ *   - number of pointer samples, as an unsigned varint, followed by each
+ *     sample's time (delta from the previous sample), as an unsigned varint,
+ *     and its movement (delta from the previous sample), as zigzag varints
+ *   - a byte with the bit of every button that changed since the previous
+ *     frame, followed by the state and number of presses of each one of those
+ *     buttons, as unsigned varints
+ */
+#ifndef __REPLAY_STRUCT__
+#define __REPLAY_STRUCT__
+
+typedef struct stReplay replay;
+
+#endif /* __REPLAY_STRUCT__ */
+
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include <GFraMe/gfmError.h>
+
+/**
+ * Release the replay, closing its file
+ *
+ * @param  [ in]ppCtx The replay
+ */
+void replay_free(replay **ppCtx);
+
+/**
+ * Alloc a new replay and open its log
+ *
+ * @param  [out]ppCtx       The alloc'ed replay
+ * @param  [ in]pFilename   The log's path
+ * @param  [ in]isRecording Whether the log should be written (1) or read (0)
+ * @return                  GFraMe return value
+ */
+gfmRV replay_getNew(replay **ppCtx, char *pFilename, int isRecording);
+
+/**
+ * Write the current frame's input (i.e., pButton, the pointer samples and the
+ * elapsed time) to the log
+ *
+ * @param  [ in]pCtx The replay
+ * @return           GFraMe return value
+ */
+gfmRV replay_recordFrame(replay *pCtx);
+
+/**
+ * Overwrite the current frame's input (i.e., pButton, the pointer samples and
+ * the elapsed time) with the next one from the log
+ *
+ * @param  [ in]pCtx The replay
+ * @return           GFMRV_TRUE (read a frame), GFMRV_FALSE (reached the end of
+ *                   the log), ...
+ */
+gfmRV replay_playFrame(replay *pCtx);
+
+#endif /* __REPLAY_H__ */
@@ -0,0 +1,84 @@
+/**
+ * @file include/base/rng.h
+ *
+ * Seedable pseudo-random number generator (xoshiro256**). Each subsystem draws
+ * from its own stream, derived from a single session seed, so they're
+ * reproducible and don't disturb one another
+ *
+ * Doesn't depend on the framework, so it may also be used by the tools
+ */
+#ifndef __RNG_STRUCT_H__
+#define __RNG_STRUCT_H__
+
+/** Export the RNG 'class' */
+typedef struct stRng rng;
+
+#endif /* __RNG_STRUCT_H__ */
+
+#ifndef __RNG_H__
+#define __RNG_H__
+
+#include <stdint.h>
+
+/** Independent streams, one for each subsystem */
+enum enRngStream {
+    /** Cosmetic particles (their count depends on the level of detail, so
+     * they must never share a stream with the gameplay) */
+    RNG_PARTICLES = 0,
+    /** Recipe generation */
+    RNG_RECIPE,
+    /** Automated players */
+    RNG_BOTS,
+    RNG_MAX
+};
+typedef enum enRngStream rngStream;
+
+/** The generator's state */
+struct stRng {
+    uint64_t pState[4];
+};
+
+/**
+ * Initialize one of the streams derived from a session seed; Every stream
+ * starts 2^128 numbers after the previous one, so they never overlap
+ *
+ * @param  [ in]pCtx   The generator
+ * @param  [ in]seed   The session seed
+ * @param  [ in]stream Which stream should be used
+ */
+void rng_init(rng *pCtx, uint64_t seed, rngStream stream);
+
+/**
+ * Retrieve the next number
+ *
+ * @param  [ in]pCtx The generator
+ * @return           A number within [0, 2^64)
+ */
+uint64_t rng_next(rng *pCtx);
+
+/**
+ * Retrieve a number within a range (without the modulo bias)
+ *
+ * @param  [ in]pCtx The generator
+ * @param  [ in]min  The lowest value (inclusive)
+ * @param  [ in]max  The highest value (inclusive)
+ * @return           A number within [min, max]
+ */
+int rng_range(rng *pCtx, int min, int max);
+
+/**
+ * Retrieve a number within [0, 1)
+ *
+ * @param  [ in]pCtx The generator
+ * @return           The number
+ */
+float rng_nextFloat(rng *pCtx);
+
+/**
+ * Advance the generator by 2^128 numbers
+ *
+ * @param  [ in]pCtx The generator
+ */
+void rng_jump(rng *pCtx);
+
+#endif /* __RNG_H__ */
@@ -0,0 +1,141 @@
+/**
+ * @file include/base/softrender.h
+ *
+ * In-memory (software) video backend. Rasterizes the draw list into the
+ * V_WIDTH x V_HEIGHT virtual framebuffer, straight from the texture atlas
+ * (color-keyed blits, 4 pixels at a time with SSE, if available), and upscales
+ * it by an integer factor (nearest neighbour). Nothing is ever presented, but
+ * frames may be dumped to disk (e.g., for image diffs)
+ *
+ * Each frame may be rendered as a few regions (e.g., only what changed since
+ * the previous frame): everything is clipped to the current region, and only
+ * that region is cleared and upscaled
+ */
+#ifndef __SOFTRENDER_STRUCT_H__
+#define __SOFTRENDER_STRUCT_H__
+
+/** Export the software renderer 'class' */
+typedef struct stSoftRender softRender;
+
+#endif /* __SOFTRENDER_STRUCT_H__ */
+
+#ifndef __SOFTRENDER_H__
+#define __SOFTRENDER_H__
+
+#include <GFraMe/gfmError.h>
+
+#include <base/drawlist.h>
+
+/** Largest factor by which the framebuffer may be upscaled */
+#define SOFTRENDER_MAX_SCALE 8
+
+/**
+ * Release the renderer
+ *
+ * @param  [ in]ppCtx The renderer
+ */
+void softrender_free(softRender **ppCtx);
+
+/**
+ * Alloc a new renderer, loading its atlas from a (24 or 32 bits, uncompressed)
+ * bitmap
+ *
+ * @param  [out]ppCtx     The alloc'ed renderer
+ * @param  [ in]pFilename The atlas
+ * @param  [ in]scale     Factor by which every frame is upscaled (within [1,
+ *                        SOFTRENDER_MAX_SCALE])
+ * @return                GFraMe return value
+ */
+gfmRV softrender_getNew(softRender **ppCtx, char *pFilename, int scale);
+
+/**
+ * Forget every cached static batch (e.g., because the level that owned them
+ * was released)
+ *
+ * @param  [ in]pCtx The renderer
+ */
+void softrender_clearCache(softRender *pCtx);
+
+/**
+ * Start rendering a region of the frame, clearing it to the background color;
+ * Everything is clipped to the region until it's finished
+ *
+ * @param  [ in]pCtx   The renderer
+ * @param  [ in]x      The region's horizontal position
+ * @param  [ in]y      The region's vertical position
+ * @param  [ in]width  The region's width
+ * @param  [ in]height The region's height
+ */
+void softrender_begin(softRender *pCtx, int x, int y, int width, int height);
+
+/**
+ * Blit a single tile (clipped to the current region)
+ *
+ * @param  [ in]pCtx      The renderer
+ * @param  [ in]sset      The tile's spriteset
+ * @param  [ in]x         The tile's horizontal position
+ * @param  [ in]y         The tile's vertical position
+ * @param  [ in]tile      The tile
+ * @param  [ in]isFlipped Whether the tile is horizontally flipped
+ * @return                GFraMe return value
+ */
+gfmRV softrender_drawTile(softRender *pCtx, spritesetId sset, int x, int y,
+        int tile, int isFlipped);
+
+/**
+ * Blit a number (each digit uses the atlas' ASCII glyphs, which start at tile 0
+ * for ' '), padded with zeros to numDigits digits
+ *
+ * @param  [ in]pCtx      The renderer
+ * @param  [ in]sset      The digits' spriteset
+ * @param  [ in]x         The number's horizontal position
+ * @param  [ in]y         The number's vertical position
+ * @param  [ in]num       The number
+ * @param  [ in]numDigits How many digits should be rendered
+ * @return                GFraMe return value
+ */
+gfmRV softrender_drawNumber(softRender *pCtx, spritesetId sset, int x, int y,
+        int num, int numDigits);
+
+/**
+ * Blit a static batch of tiles. It's rasterized only the first time it's seen
+ * (into a cached layer), and the cached pixels are blitted from then on
+ *
+ * @param  [ in]pCtx  The renderer
+ * @param  [ in]sset  The tiles' spriteset
+ * @param  [ in]pData The tiles, as planes (every horizontal position, every
+ *                    vertical position and then every tile)
+ * @param  [ in]num   How many tiles there are in the batch
+ * @return            GFraMe return value
+ */
+gfmRV softrender_drawStatic(softRender *pCtx, spritesetId sset, short *pData,
+        int num);
+
+/**
+ * Finish rendering the current region, upscaling it
+ *
+ * @param  [ in]pCtx The renderer
+ */
+void softrender_end(softRender *pCtx);
+
+/**
+ * Retrieve the last finished (upscaled) frame
+ *
+ * @param  [out]ppPixels The frame's pixels, in 0x00RRGGBB format
+ * @param  [out]pWidth   The frame's width
+ * @param  [out]pHeight  The frame's height
+ * @param  [ in]pCtx     The renderer
+ */
+void softrender_getFrame(unsigned int **ppPixels, int *pWidth, int *pHeight,
+        softRender *pCtx);
+
+/**
+ * Write the last finished (upscaled) frame into a binary PPM (P6) image
+ *
+ * @param  [ in]pCtx      The renderer
+ * @param  [ in]pFilename The image
+ * @return                GFraMe return value
+ */
+gfmRV softrender_dumpFrame(softRender *pCtx, char *pFilename);
+
+#endif /* __SOFTRENDER_H__ */
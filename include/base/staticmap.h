@@ -0,0 +1,65 @@
+/**
+ * @file include/base/staticmap.h
+ *
+ * Tilemap whose static tiles are baked (once) into a static batch, so only the
+ * few animated ones are recorded every frame
+ */
+#ifndef __STATICMAP_STRUCT_H__
+#define __STATICMAP_STRUCT_H__
+
+/** Export the static map 'class' */
+typedef struct stStaticMap staticMap;
+
+#endif /* __STATICMAP_STRUCT_H__ */
+
+#ifndef __STATICMAP_H__
+#define __STATICMAP_H__
+
+#include <GFraMe/gfmError.h>
+#include <GFraMe/gfmTilemap.h>
+
+#include <base/drawlist.h>
+
+/**
+ * Release the static map (it belongs to the level arena, so this only clears
+ * the reference)
+ *
+ * @param  [ in]ppCtx The static map
+ */
+void staticmap_free(staticMap **ppCtx);
+
+/**
+ * Alloc a new static map from the level arena
+ *
+ * @param  [out]ppCtx The alloc'ed static map
+ * @return            GFraMe return value
+ */
+gfmRV staticmap_getNew(staticMap **ppCtx);
+
+/**
+ * Bake every visible tile that's never animated; The tilemap must be kept
+ * alive, as the animated tiles are read from it when drawing
+ *
+ * @param  [ in]pCtx      The static map
+ * @param  [ in]pTMap     The tilemap
+ * @param  [ in]sset      The tilemap's spriteset
+ * @param  [ in]x         The tilemap's horizontal position
+ * @param  [ in]y         The tilemap's vertical position
+ * @param  [ in]pAnimData The tilemap's animations (on the same format as
+ *                        gfmTilemap_addAnimations)
+ * @param  [ in]animLen   Number of integers in pAnimData
+ * @return                GFraMe return value
+ */
+gfmRV staticmap_init(staticMap *pCtx, gfmTilemap *pTMap, spritesetId sset,
+        int x, int y, int *pAnimData, int animLen);
+
+/**
+ * Record the baked tiles (as a single static batch) and the current frame of
+ * every animated tile
+ *
+ * @param  [ in]pCtx The static map
+ * @return           GFraMe return value
+ */
+gfmRV staticmap_draw(staticMap *pCtx);
+
+#endif /* __STATICMAP_H__ */
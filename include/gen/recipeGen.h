@@ -0,0 +1,88 @@
+/**
+ * @file include/gen/recipeGen.h
+ *
+ * Generates recipes from the files under data/. A recipe is a list of slots,
+ * each filled by one of a few variants of a template; Each template lists the
+ * items that compose it, and each item is either a fixed ingredient or a
+ * random pick among a few
+ *
+ * Every file is parsed only once, when the generator is alloc'ed, into a
+ * flat in-memory cache; Generating a recipe only draws random numbers, so it
+ * never touches the filesystem. The picks are made in the same order as the
+ * original standalone generator did, so a given stream always generates the
+ * same recipe
+ *
+ * Only uses the framework's headers (and takes the directory that holds data/
+ * as a parameter), so it may also be used by the tools
+ */
+#ifndef __RECIPEGEN_STRUCT_H__
+#define __RECIPEGEN_STRUCT_H__
+
+/** Export the recipe generator 'class' */
+typedef struct stRecipeGen recipeGen;
+
+#endif /* __RECIPEGEN_STRUCT_H__ */
+
+#ifndef __RECIPEGEN_H__
+#define __RECIPEGEN_H__
+
+#include <GFraMe/gfmError.h>
+
+#include <base/rng.h>
+
+#include <ggj16/type.h>
+
+/** Every recipe that may be generated */
+enum enRecipeId {
+    RECIPE_TUTORIAL = 0,
+    RECIPE_PHASE1,
+    RECIPE_MAX
+};
+typedef enum enRecipeId recipeId;
+
+/**
+ * Release the generator and its cache
+ *
+ * @param  [ in]ppCtx The generator
+ */
+void recipeGen_free(recipeGen **ppCtx);
+
+/**
+ * Alloc a new generator, parsing every recipe (as well as every template and
+ * item they reference) into its cache
+ *
+ * Every path is relative to pRoot (e.g., the game's assets/ directory)
+ *
+ * @param  [out]ppCtx The alloc'ed generator
+ * @param  [ in]pRoot Directory that holds data/ (with a trailing separator)
+ * @return            GFraMe return value
+ */
+gfmRV recipeGen_getNew(recipeGen **ppCtx, char *pRoot);
+
+/**
+ * Retrieve the most items a recipe may generate
+ *
+ * @param  [ in]pCtx   The generator
+ * @param  [ in]recipe The recipe
+ * @return             The number of items
+ */
+int recipeGen_getMaxLength(recipeGen *pCtx, recipeId recipe);
+
+/**
+ * Generate a recipe. Ingredients that can't be on a recipe (e.g., the
+ * cauldron) are still picked (so the stream advances the same), but skipped
+ *
+ * @param  [out]pItems The generated items
+ * @param  [out]pLen   How many items were generated
+ * @param  [ in]maxLen How many items fit into pItems (at least
+ *                     recipeGen_getMaxLength)
+ * @param  [ in]pCtx   The generator
+ * @param  [ in]recipe The recipe
+ * @param  [ in]pRng   Stream from which every pick is drawn
+ * @return             GFraMe return value
+ */
+gfmRV recipeGen_generate(itemType *pItems, int *pLen, int maxLen,
+        recipeGen *pCtx, recipeId recipe, rng *pRng);
+
+#endif /* __RECIPEGEN_H__ */
+
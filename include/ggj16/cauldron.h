@@ -26,7 +26,8 @@ struct stCauldron {
 };
 
 /**
- * Release all alloc'ed memory
+ * Release everything alloc'ed by the cauldron (the cauldron itself belongs to
+ * the level arena, so it's only released when the arena is reset)
  *
  * @param  [ in]ppObj The cauldron to be release
  * @return            GFraMe return value
@@ -34,7 +35,7 @@ struct stCauldron {
 void cauldron_free(cauldron **ppObj);
 
 /**
- * Alloc a new cauldron
+ * Alloc a new cauldron from the level arena
  *
  * @param  [out]ppObj The alloc'ed cauldron
  * @return            GFraMe return value
@@ -67,21 +68,12 @@ gfmRV cauldron_doExplode(cauldron *pCal);
 gfmRV cauldron_update(cauldron *pObj);
 
 /**
- * Draw the cauldron
+ * Record the cauldron into the draw list
  *
  * @param  [ in]pObj    The parsed cauldron
  * @return            GFraMe return value
  */
 gfmRV cauldron_draw(cauldron *pObj);
 
-/**
- * Check if a sprite is overlapping the cauldron
- *
- * @param  [ in]pCal The cauldron
- * @param  [ in]pSpr The other sprite
- * @return           GFraMe return value
- */
-gfmRV cauldron_isOverlapping(cauldron *pCal, gfmSprite *pSpr);
-
 #endif /* __CAULDRON_H__ */
 
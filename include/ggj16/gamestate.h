@@ -20,12 +20,18 @@ void gs_free();
 gfmRV gs_init();
 
 /**
- * Update everything
+ * Simulate a single (fixed) step of everything that affects the gameplay
  */
 gfmRV gs_update();
 
 /**
- * Draws everything
+ * Update everything that's purely cosmetic (i.e., the framework's animations
+ * and the fire), once per rendered frame
+ */
+gfmRV gs_animate();
+
+/**
+ * Records everything that should be drawn into the draw list
  */
 gfmRV gs_draw();
 
@@ -1,7 +1,9 @@
 /**
  * @file include/ggj16/gesture.h
  *
- * Recognizes gestures from the mouse
+ * Recognizes gestures from the mouse. The pointer's path since the last reset
+ * is kept as a stroke, which is classified against the templates of every
+ * known gesture (so new ones only need a new template)
  */
 #ifndef __GESTURE_STRUCT__
 #define __GESTURE_STRUCT__
@@ -18,14 +20,16 @@ typedef struct stGesture gesture;
 #include <ggj16/type.h>
 
 /**
- * Release the struct
+ * Release the struct (it belongs to the level arena, so this only clears the
+ * reference)
  *
  * @param  [ in]ppCtx The recognizer
  */
 void gesture_free(gesture **ppCtx);
 
 /**
- * Alloc and initialize a new recognizer
+ * Alloc (from the level arena) and initialize a new recognizer, normalizing
+ * the templates of every known gesture
  *
  * @param  [out]ppCtx The alloc'ed recognizer
  * @return            GFraMe return value
@@ -40,7 +44,9 @@ gfmRV gesture_getNew(gesture **ppCtx);
 void gesture_reset(gesture *pCtx);
 
 /**
- * Update the recognizer
+ * Update the recognizer, appending every pointer sample since the previous
+ * step to the stroke (so it has the whole path, regardless of the frame rate)
+ * and dropping the points older than GESTURE_MAX_AGE
  *
  * @param  [ in]pCtx The recognizer
  * @return           GFraMe return value
@@ -57,7 +63,8 @@ void gesture_draw(gesture *pGesture);
 /**
  * Retrieve the current gesture (if any)
  *
- * @param  [out]pItem The current gestures (must have 4 positions)
+ * @param  [out]pItem The current gestures, from the best match (must have 4
+ *                    positions; T_NONE on the unused ones)
  * @param  [ in]pCtx  The recognizer
  * @return            GFraMe return value
  */
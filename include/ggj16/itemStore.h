@@ -0,0 +1,99 @@
+/**
+ * @file include/ggj16/itemStore.h
+ *
+ * Store every item on the board as parallel arrays, bucketed into the spatial
+ * grid (so hovering only checks the items under the pointer). Also implements
+ * Drag 'n' Drop.
+ */
+#ifndef __ITEMSTORE_STRUCT_H__
+#define __ITEMSTORE_STRUCT_H__
+
+/** Export the itemStore 'class' */
+typedef struct stItemStore itemStore;
+
+#endif  /* __ITEMSTORE_STRUCT_H__ */
+
+#ifndef __ITEMSTORE_H__
+#define __ITEMSTORE_H__
+
+#include <GFraMe/gfmError.h>
+#include <GFraMe/gfmParser.h>
+
+#include <ggj16/type.h>
+
+/** Index used when no item is being dragged */
+#define ITEM_NONE -1
+
+/**
+ * Release the store (it belongs to the level arena, so this only clears the
+ * reference)
+ *
+ * @param  [ in]ppCtx The store
+ */
+void itemStore_free(itemStore **ppCtx);
+
+/**
+ * Alloc a new store (and all of its arrays) from the level arena
+ *
+ * @param  [out]ppCtx    The alloc'ed store
+ * @param  [ in]maxItems How many items the store may hold
+ * @return               GFraMe return value
+ */
+gfmRV itemStore_getNew(itemStore **ppCtx, int maxItems);
+
+/**
+ * Parse an item and add it to the store
+ *
+ * @param  [ in]pCtx    The store
+ * @param  [ in]pParser The parser
+ * @return              GFraMe return value
+ */
+gfmRV itemStore_add(itemStore *pCtx, gfmParser *pParser);
+
+/**
+ * Update every item (highlight the hovered one and handle dragging). Moved
+ * items are woken on the broad phase
+ *
+ * @param  [ in]pCtx The store
+ * @return           GFraMe return value
+ */
+gfmRV itemStore_update(itemStore *pCtx);
+
+/**
+ * Handle an item overlapping the cauldron; If it was just dropped, check
+ * whether it was the expected one
+ *
+ * @param  [ in]pCtx The store
+ * @param  [ in]id   The item
+ * @return           GFraMe return value
+ */
+gfmRV itemStore_onCauldron(itemStore *pCtx, int id);
+
+/**
+ * Return the item dropped on this step (if any) to its origin. Must be called
+ * after the collision was handled
+ *
+ * @param  [ in]pCtx The store
+ * @return           GFraMe return value
+ */
+gfmRV itemStore_settle(itemStore *pCtx);
+
+/**
+ * Retrieve an item's type
+ *
+ * @param  [out]pType The item's type
+ * @param  [ in]pCtx  The store
+ * @param  [ in]id    The item
+ * @return            GFraMe return value
+ */
+gfmRV itemStore_getType(itemType *pType, itemStore *pCtx, int id);
+
+/**
+ * Record every item into the draw list
+ *
+ * @param  [ in]pCtx The store
+ * @return           GFraMe return value
+ */
+gfmRV itemStore_draw(itemStore *pCtx);
+
+#endif /* __ITEMSTORE_H__ */
@@ -19,26 +19,52 @@ typedef struct stRecipeScroll recipeScroll;
 #include <ggj16/type.h>
 
 /**
- * Releases all memory
+ * Retrieve one of the recipe's items. Items are retrieved only once each, in
+ * order, as they scroll into view
+ *
+ * @param  [ in]pCtx  The source's context
+ * @param  [ in]index The item's position on the recipe
+ * @return            The item (anything outside [T_RAT_TAIL, T_MAX) ends the
+ *                    recipe)
+ */
+typedef itemType (*recipeSource)(void *pCtx, int index);
+
+/**
+ * Releases the scroller's mask (the scroller itself belongs to the level
+ * arena, so it's only released when the arena is reset)
  *
  * @param  [ in]ppScroll The object to be released
  */
 void recipeScroll_free(recipeScroll **ppScroll);
 
 /**
- * Alloc a new recipe scroller
+ * Alloc a new recipe scroller from the level arena
  *
  * @param  [out]ppScroll The alloc'ed object
  * @return               GFraMe return value
  */
 gfmRV recipeScroll_getNew(recipeScroll **ppScroll);
 
+/**
+ * Loads a new recipe into the scroller, retrieving its items as they scroll
+ * into view (so a recipe may be arbitrarily long, or even endless)
+ *
+ * @param  [ in]pScroll The object
+ * @param  [ in]source  Retrieves each of the recipe's items
+ * @param  [ in]pCtx    Context passed to the source
+ * @param  [ in]speed   Recipe' scrolling speed (in pixels-per-second)
+ * @return              GFraMe return value
+ */
+gfmRV recipeScroll_loadSource(recipeScroll *pScroll, recipeSource source,
+        void *pCtx, double speed);
+
 /**
  * Loads a new recipe into the scroller
  *
  * @param  [ in]pScroll The object
- * @param  [ in]pTypes  List of items in this recipe
- * @param  [ in]length  Number of entries in the items list
+ * @param  [ in]pItems  List of types in this recipe (it isn't copied, so it
+ *                      must be kept alive while the recipe is loaded)
+ * @param  [ in]length  Number of entries in the types list
  * @param  [ in]speed   Recipe' scrolling speed (in pixels-per-second)
  * @return              GFraMe return value
  */
@@ -71,7 +97,7 @@ gfmRV recipeScroll_didFail(recipeScroll *pScroll);
 gfmRV recipeScroll_update(recipeScroll *pScroll);
 
 /**
- * Draw the scroller
+ * Record the scroller into the draw list
  *
  * @param  [ in]pScroll The object
  * @return              GFraMe return value
@@ -0,0 +1,88 @@
+/**
+ * @file include/ggj16/templates.h
+ *
+ * Template-matching gesture engine (in the style of the $1 recognizer). Every
+ * template is resampled into a fixed number of points, translated to its
+ * centroid and uniformly scaled (and optionally rotated to its indicative
+ * angle) once, when it's added. Strokes are normalized the same way and scored
+ * against every template by their mean squared distance
+ *
+ * Since the pointer may keep on gesturing for as long as it wants (e.g.,
+ * spinning many times), a stroke is also tried from a few points along its
+ * path, so only its most recent part has to match a template
+ *
+ * Everything is computed in fixed point (angles with the same arctangent table
+ * the recognizer used), so matching is deterministic on every build
+ */
+#ifndef __TEMPLATES_STRUCT__
+#define __TEMPLATES_STRUCT__
+
+typedef struct stTemplateSet templateSet;
+
+#endif /* __TEMPLATES_STRUCT__ */
+
+#ifndef __TEMPLATES_H__
+#define __TEMPLATES_H__
+
+#include <GFraMe/gfmError.h>
+
+#include <ggj16/type.h>
+
+/** Number of points into which every stroke is resampled (a multiple of 4) */
+#define TEMPLATES_POINTS 64
+/** Most points on a stroke (or on a template's path) */
+#define TEMPLATES_MAX_STROKE 512
+/** Most templates in a set */
+#define TEMPLATES_MAX    32
+
+/** The template doesn't depend on where it starts (e.g., a circle) */
+#define TEMPLATES_ANY_ROTATION 0x1
+
+/**
+ * Release the template set (it belongs to the level arena, so this only clears
+ * the reference)
+ *
+ * @param  [ in]ppCtx The template set
+ */
+void templates_free(templateSet **ppCtx);
+
+/**
+ * Alloc a new (empty) template set from the level arena
+ *
+ * @param  [out]ppCtx The alloc'ed template set
+ * @return            GFraMe return value
+ */
+gfmRV templates_getNew(templateSet **ppCtx);
+
+/**
+ * Normalize and add a template. A type may have as many templates as needed
+ * (e.g., to accept a gesture starting in any direction)
+ *
+ * @param  [ in]pCtx    The template set
+ * @param  [ in]type    Item recognized by the template
+ * @param  [ in]pPoints The template's path, as interleaved horizontal and
+ *                      vertical positions (in any scale)
+ * @param  [ in]num     Number of points in the path
+ * @param  [ in]flags   TEMPLATES_ANY_ROTATION, or 0
+ * @return              GFraMe return value
+ */
+gfmRV templates_add(templateSet *pCtx, itemType type, const short *pPoints,
+        int num, int flags);
+
+/**
+ * Classify a stroke, retrieving every type whose template matched it (ordered
+ * from the best match)
+ *
+ * @param  [out]pTypes  The matched types (T_NONE on the unused positions)
+ * @param  [ in]maxType How many types may be retrieved
+ * @param  [ in]pCtx    The template set
+ * @param  [ in]pPoints The stroke, as interleaved horizontal and vertical
+ *                      positions (in pixels)
+ * @param  [ in]num     Number of points in the stroke
+ * @return              GFraMe return value
+ */
+gfmRV templates_match(itemType *pTypes, int maxType, templateSet *pCtx,
+        const short *pPoints, int num);
+
+#endif /* __TEMPLATES_H__ */
+
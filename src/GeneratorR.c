@@ -1,214 +1,82 @@
-#include <stdio.h>
-#include <time.h>
-#include "gen/recipe.h"
+/**
+ * @file src/GeneratorR.c
+ *
+ * Standalone recipe generator (not part of the game): generates a recipe and
+ * prints its length followed by every item. The session seed may be passed as
+ * the first argument, and the recipe (its index) as the second one
+ *
+ * Must be run from the directory that holds assets/ (e.g., the repository's
+ * root)
+ */
+#include <base/rng.h>
 
-#define   ARRAY_SIZE   120
-#define   ARRAY_SIZE_NAME 255
-#define   ARRAY_SIZE_ID 200
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
 
-int generateRandom(char* filename,int* values);
-Recipe* readRecipe(char* filename);
-Template* readTemplate(char* filename,int type,int numT );
-Item* readItem(char* filename);
-int getvalues(Recipe* r, int* values);
+#include <gen/recipeGen.h>
 
-void freeRecipe(Recipe *r);
-void freeTemplate(Template*t);
-void freeItem(Item* item);
+#include <ggj16/type.h>
 
-int main()
-{
-    //Sample use;
-    int tam=0;
-    int* values=(int*)malloc(ARRAY_SIZE*sizeof(int));
-    char* filename=(char*)malloc(ARRAY_SIZE_NAME*sizeof(char));
-    filename="data/recipes/recipe_tutorial.txt";
-    tam=generateRandom(filename,values);
-    printf("%d\n",tam);
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 
-    for(int i=0;i<tam;i++){
-        printf("%d ",values[i]);
+int main(int argc, char *argv[]) {
+    /** The generated items */
+    itemType *pItems;
+    /** The generator */
+    recipeGen *pGen;
+    /** Session seed */
+    uint64_t seed;
+    /** Stream used for every pick */
+    rng recipeRng;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The generated recipe */
+    recipeId recipe;
+    /** Number of generated items */
+    int len;
+    /** Iterate through the items */
+    int i;
+
+    pItems = 0;
+    pGen = 0;
+
+    seed = (uint64_t)time(NULL);
+    if (argc > 1) {
+        seed = (uint64_t)strtoull(argv[1], NULL, 0);
     }
-    //free memory
-    free(values);
-    free(filename);
-    return 0;
-}
-
-int generateRandom(char* filename,int* values)
-{
-    Recipe* r=readRecipe(filename); //read files;
-    int resul=getvalues(r, values);
-
-    freeRecipe(r);
-    return resul;// get list of int
-}
-
-Recipe* readRecipe(char* filename)
-{
-    FILE* file = fopen(filename,"r+");
-    if(file == NULL) printf("Error al abrir archivo");
-
-    //data
-    char* idRecipe=(char*)malloc(sizeof(char)*ARRAY_SIZE_ID);
-    int numTemplates=0;
-    char** paths = NULL;
-    Template** templates= NULL;
-
-    //read
-    fscanf(file, "%s", idRecipe);
-    fscanf (file, "%d", &numTemplates);
-    templates = (Template*)malloc(sizeof(Template*)* numTemplates);
-    //memory
-    paths=(char**)malloc(sizeof(char*)*ARRAY_SIZE_NAME);
-    for(int i=0;i<numTemplates;i++){
-        paths[i]=(char*)malloc(sizeof(char)*ARRAY_SIZE_NAME);
+    recipe = RECIPE_TUTORIAL;
+    if (argc > 2) {
+        recipe = (recipeId)atoi(argv[2]);
     }
-    for(int i=0;i<numTemplates;i++){
-       fscanf(file, "%s", paths[i]);
-       int type=0;
-       int numT=0;
-       fscanf (file, "%d", &type);
-       fscanf (file, "%d", &numT);
-       templates[i]=readTemplate(paths[i],type,numT);
+    ASSERT(recipe >= 0 && recipe < RECIPE_MAX, GFMRV_ARGUMENTS_BAD);
+    rng_init(&recipeRng, seed, RNG_RECIPE);
+
+    rv = recipeGen_getNew(&pGen, "assets/");
+    ASSERT(rv == GFMRV_OK, rv);
+
+    /* Alloc (at least) an item, even if the recipe is empty */
+    pItems = (itemType*)malloc(sizeof(itemType) *
+            (recipeGen_getMaxLength(pGen, recipe) + 1));
+    ASSERT(pItems, GFMRV_ALLOC_FAILED);
+    rv = recipeGen_generate(pItems, &len, recipeGen_getMaxLength(pGen,
+            recipe), pGen, recipe, &recipeRng);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    printf("%d\n", len);
+    i = 0;
+    while (i < len) {
+        printf("%d ", (int)pItems[i]);
+        i++;
     }
-    //fill
-    Recipe* recipe=(Recipe*)malloc(sizeof(Recipe));
-    recipe->id=idRecipe;
-    recipe->numTemplates=numTemplates;
-    recipe->templates=templates;
+    printf("\n");
 
-        //free
-    for(int i=0;i<numTemplates;i++){
-        free(paths[i]);
-    }
-    free(paths);
+    rv = GFMRV_OK;
+__ret:
+    free(pItems);
+    recipeGen_free(&pGen);
 
-    fclose(file);
-    return recipe;
+    return (rv == GFMRV_OK) ? 0 : 1;
 }
 
-Template* readTemplate(char* filename,int type,int numT )
-{
-    //get file
-    char* newname=(char*)malloc(sizeof(char)*ARRAY_SIZE_NAME);
-    int indice=0;
-    srand((int)time(NULL));
-    if(numT!=0)indice=rand() % numT;
-    sprintf(newname, "%s_%d_%d.txt",filename,type, indice);
-    FILE* file = fopen(newname,"r");
-    if(file == NULL) printf("Error al abrir archivo");
-    //data
-    char* id=(char*)malloc(sizeof(char)*ARRAY_SIZE_ID);
-    int numItems=0;
-    int type2=0;
-    char** itemPath=NULL;
-    Item** items = NULL;
-    //read
-    fscanf(file, "%s", id);
-    fscanf (file, "%d", &type2);
-    fscanf (file, "%d", &numItems);
-    //memory
-    items=(Item**)malloc(sizeof(Item*)* numItems);
-    itemPath=(char**)malloc(sizeof(char*)*ARRAY_SIZE_NAME);
-    for(int i=0;i<numItems;i++){
-        itemPath[i]=(char*)malloc(sizeof(char)*ARRAY_SIZE_NAME);
-    }
-    //read Items
-    for(int i=0;i<numItems;i++){
-       fscanf(file,"%s", itemPath[i]);
-       items[i]=readItem(itemPath[i]);
-    }
-    //fill
-    Template* templ=(Template*)malloc(sizeof(Template));
-    templ->id=id;
-    templ->type=type2;
-    templ->numItems=numItems;
-    templ->items=items;
-
-    //free
-    for(int i=0;i<numItems;i++){
-        free(itemPath[i]);
-    }
-    free(itemPath);
-
-    fclose(file);
-    return templ;
-}
-Item* readItem(char* filename)
-{
-    FILE* file = fopen(filename,"r");
-    if(file == NULL) printf("Error al abrir archivo");
-    //data;
-    char* id=(char*)malloc(sizeof(char)*ARRAY_SIZE_ID);
-    int type=0;
-    int numIngredients=0;
-    int* ingredients = (int*)malloc(sizeof(int)*ARRAY_SIZE);;
-    //read;
-    fscanf(file, "%s", id);
-    fscanf (file, "%d", &type);
-    fscanf (file, "%d", &numIngredients);
-    for(int i=0;i<numIngredients;i++){
-       fscanf(file, "%d", &ingredients[i]);
-    }
-    //fill
-    Item* item=(Item*)malloc(sizeof(Item));
-    item->id=id;
-    item->type=type;
-    item->numIngredients=numIngredients;
-    item->ingredients=ingredients;
-    fclose(file);
-    return item;
-}
-
-int getvalues(Recipe* r, int* values)
-{
-
-    int count=0;
-    int numTemplates=r->numTemplates;
-    for(int i= 0;i< numTemplates;i++){
-        Template* t=r->templates[i];
-        int numItems=t->numItems;
-        for(int j=0;j<numItems;j++){
-            Item* item= t->items[j];
-            int* ingredient=item->ingredients;
-            if(item->type==0){
-               //get value of the item
-               values[count++]=ingredient[0];
-            }else{
-                int numIngredients =item->numIngredients;
-                srand((int)time(NULL));
-                int indice=0;
-                if(numIngredients!=0)indice=rand() % numIngredients;
-                values[count++]=ingredient[indice];
-                //get value of the item
-            }
-        }
-    }
-    return count;
-}
-/*
-    free memory
-*/
-void freeRecipe(Recipe *r)
-{
-    for(int i=0;i<r->numTemplates;i++){
-        freeTemplate(r->templates[i]);
-    }
-    free(r->id);
-    free(r);
-}
-void freeTemplate(Template*t)
-{
-    for(int i=0;i<t->numItems;i++){
-        freeItem(t->items[i]);
-    }
-    free(t->id);
-    free(t);
-}
-void freeItem(Item*  item)
-{
-    free(item->id);
-    free(item->ingredients);
-    free(item);
-}
@@ -0,0 +1,96 @@
+/**
+ * @file src/arena.c
+ *
+ * Bump allocator over a pre-alloc'ed buffer. Everything alloc'ed from an arena
+ * is released at once, by reseting it
+ */
+#include <base/arena.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Initialize an arena over a buffer
+ *
+ * @param  [ in]pArena The arena
+ * @param  [ in]pMem   The buffer
+ * @param  [ in]size   The buffer's size, in bytes
+ */
+void arena_init(arena *pArena, void *pMem, size_t size) {
+    pArena->pBase = (char*)pMem;
+    pArena->size = size;
+    pArena->used = 0;
+    pArena->highWater = 0;
+}
+
+/**
+ * Alloc (and clean) a block from the arena, aligned to the architecture's word
+ *
+ * @param  [out]ppMem  The alloc'ed block
+ * @param  [ in]pArena The arena
+ * @param  [ in]size   How many bytes should be alloc'ed
+ * @return             GFraMe return value
+ */
+gfmRV arena_alloc(void **ppMem, arena *pArena, size_t size) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Address of the first free byte */
+    uintptr_t addr;
+    /** Bytes skipped to align the block */
+    size_t padding;
+
+    ASSERT(ppMem, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pArena, GFMRV_ARGUMENTS_BAD);
+
+    /* Align the actual address (the base itself may be unaligned) */
+    addr = (uintptr_t)(pArena->pBase + pArena->used);
+    padding = (ALIGN - (addr % ALIGN)) % ALIGN;
+    ASSERT(pArena->used + padding + size <= pArena->size, GFMRV_ALLOC_FAILED);
+
+    *ppMem = pArena->pBase + pArena->used + padding;
+    memset(*ppMem, 0x0, size);
+
+    pArena->used += padding + size;
+    if (pArena->used > pArena->highWater) {
+        pArena->highWater = pArena->used;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Retrieve the arena's current position, so it may later be rewound
+ *
+ * @param  [ in]pArena The arena
+ * @return             The current position
+ */
+size_t arena_getMark(arena *pArena) {
+    return pArena->used;
+}
+
+/**
+ * Release everything alloc'ed after a given position
+ *
+ * @param  [ in]pArena The arena
+ * @param  [ in]mark   Position retrieved by arena_getMark
+ */
+void arena_rewind(arena *pArena, size_t mark) {
+    if (mark < pArena->used) {
+        pArena->used = mark;
+    }
+}
+
+/**
+ * Release everything alloc'ed from the arena
+ *
+ * @param  [ in]pArena The arena
+ */
+void arena_reset(arena *pArena) {
+    pArena->used = 0;
+}
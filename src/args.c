@@ -0,0 +1,111 @@
+/**
+ * @file src/args.c
+ *
+ * Parse the command line arguments
+ */
+#include <base/args.h>
+#include <base/frameskip.h>
+#include <base/game_const.h>
+#include <base/game_ctx.h>
+#include <base/softrender.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** Check if an argument starts with a given (static) option */
+#define IS_OPTION(arg, opt) (strncmp(arg, opt, sizeof(opt) - 1) == 0)
+/** Retrieve the value of an option on the format '--opt=value' */
+#define GET_VALUE(arg, opt) (arg + sizeof(opt) - 1)
+
+/**
+ * Parse every argument and set the related flags on pGame
+ *
+ * Accepted arguments:
+ *   --headless   Only simulate the game (no window, audio nor rendering)
+ *   --frames=N   Number of frames simulated in headless mode
+ *   --record=F   Record the input of every frame into the file F
+ *   --replay=F   Play back the input recorded into the file F
+ *   --profile=F  Measure every phase of the frame and write a report to F
+ *   --speed=N    Fast-forward the simulation N times (up to
+ *                FRAMESKIP_MAX_SPEED)
+ *   --seed=N     Session seed (by default, the current time; When playing
+ *                back, the recorded seed is used instead)
+ *   --software   Headless, but render every frame with the software renderer
+ *   --scale=N    Upscale software rendered frames N times (up to
+ *                SOFTRENDER_MAX_SCALE; By default, as much as fits the window)
+ *   --dump=P     Dump every software rendered frame into P000000.ppm,
+ *                P000001.ppm...
+ *
+ * @param  [ in]argc Number of arguments
+ * @param  [ in]argv List of arguments
+ * @return           GFraMe return value
+ */
+gfmRV args_parse(int argc, char *argv[]) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the arguments */
+    int i;
+
+    pGame->maxFrames = HEADLESS_FRAMES;
+    pGame->speed = 1;
+    pGame->flags |= GAME_RUN;
+    pGame->seed = (uint64_t)time(0);
+
+    /* Skip the program's name */
+    i = 1;
+    while (i < argc) {
+        if (IS_OPTION(argv[i], "--headless")) {
+            pGame->flags |= GAME_HEADLESS;
+        }
+        else if (IS_OPTION(argv[i], "--frames=")) {
+            pGame->maxFrames = atoi(GET_VALUE(argv[i], "--frames="));
+            ASSERT(pGame->maxFrames > 0, GFMRV_ARGUMENTS_BAD);
+        }
+        else if (IS_OPTION(argv[i], "--record=")) {
+            pGame->flags |= GAME_RECORD;
+            pGame->pReplayFile = GET_VALUE(argv[i], "--record=");
+        }
+        else if (IS_OPTION(argv[i], "--replay=")) {
+            pGame->flags |= GAME_PLAYBACK;
+            pGame->pReplayFile = GET_VALUE(argv[i], "--replay=");
+        }
+        else if (IS_OPTION(argv[i], "--profile=")) {
+            pGame->flags |= GAME_PROFILE;
+            pGame->pProfileFile = GET_VALUE(argv[i], "--profile=");
+        }
+        else if (IS_OPTION(argv[i], "--speed=")) {
+            pGame->speed = atoi(GET_VALUE(argv[i], "--speed="));
+            ASSERT(pGame->speed > 0 && pGame->speed <= FRAMESKIP_MAX_SPEED,
+                    GFMRV_ARGUMENTS_BAD);
+        }
+        else if (IS_OPTION(argv[i], "--seed=")) {
+            pGame->seed = (uint64_t)strtoull(GET_VALUE(argv[i], "--seed="),
+                    0/*endptr*/, 0/*base*/);
+        }
+        else if (IS_OPTION(argv[i], "--software")) {
+            pGame->flags |= GAME_HEADLESS | GAME_SOFTWARE;
+        }
+        else if (IS_OPTION(argv[i], "--scale=")) {
+            pGame->scale = atoi(GET_VALUE(argv[i], "--scale="));
+            ASSERT(pGame->scale > 0 && pGame->scale <= SOFTRENDER_MAX_SCALE,
+                    GFMRV_ARGUMENTS_BAD);
+        }
+        else if (IS_OPTION(argv[i], "--dump=")) {
+            pGame->pDumpPrefix = GET_VALUE(argv[i], "--dump=");
+        }
+        /* Silently ignore anything else (e.g., OSX's -psn_*) */
+        i++;
+    }
+
+    /* Can't both record and play back the input */
+    ASSERT((pGame->flags & (GAME_RECORD | GAME_PLAYBACK)) !=
+            (GAME_RECORD | GAME_PLAYBACK), GFMRV_ARGUMENTS_BAD);
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
@@ -10,23 +10,51 @@
 #include <GFraMe/gfmError.h>
 #include <GFraMe/gframe.h>
 
+#include <stdio.h>
+
 /**
- * Load all assets
+ * Retrieve the path of an asset, relative to the game's binary (i.e., where the
+ * framework loads every asset from), for assets not loaded by the framework
+ *
+ * @param  [out]pPath  The asset's path
+ * @param  [ in]maxLen How many characters fit into pPath
+ * @param  [ in]pAsset The asset, relative to the assets directory
+ * @return             GFraMe return value
+ */
+gfmRV assets_getPath(char *pPath, int maxLen, char *pAsset) {
+    /** Path to the game's binary (with a trailing separator) */
+    char *pBinPath;
+    /** Return value */
+    gfmRV rv;
+
+    ASSERT(pPath, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pAsset, GFMRV_ARGUMENTS_BAD);
+
+    rv = gfm_getBinaryPath(&pBinPath, pGame->pCtx);
+    ASSERT(rv == GFMRV_OK, rv);
+    ASSERT(snprintf(pPath, maxLen, "%sassets/%s", pBinPath, pAsset) < maxLen,
+            GFMRV_ARGUMENTS_BAD);
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Load only the texture and create its spritesets (e.g., when no audio will
+ * be played)
  *
  * @return GFraMe return value
  */
-gfmRV assets_load() {
+gfmRV assets_loadGraphics() {
     /** Return value */
     gfmRV rv;
 
-    /* Macros for loading stuff... */
+    /* Macro for creating the spritesets... */
 #define GEN_SPRITESET(W, H, TEX) \
     rv = gfm_createSpritesetCached(&(pGfx->pSset##W##x##H), pGame->pCtx, TEX, \
             W, H); \
     ASSERT(rv == GFMRV_OK, rv);
-#define LOAD_SFX(var, name) \
-    rv = gfm_loadAudio(&(pAudio->var), pGame->pCtx, name, sizeof(name) - 1); \
-    ASSERT(rv == GFMRV_OK, rv)
 
     /* Load the texture and its spritesets */
     rv = gfm_loadTextureStatic(&(pGfx->texHandle), pGame->pCtx, "gfx/atlas.bmp",
@@ -39,6 +67,28 @@ gfmRV assets_load() {
     GEN_SPRITESET(32, 32, pGfx->texHandle);
     GEN_SPRITESET(64, 64, pGfx->texHandle);
 
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Load all assets
+ *
+ * @return GFraMe return value
+ */
+gfmRV assets_load() {
+    /** Return value */
+    gfmRV rv;
+
+    /* Macro for loading stuff... */
+#define LOAD_SFX(var, name) \
+    rv = gfm_loadAudio(&(pAudio->var), pGame->pCtx, name, sizeof(name) - 1); \
+    ASSERT(rv == GFMRV_OK, rv)
+
+    rv = assets_loadGraphics();
+    ASSERT(rv == GFMRV_OK, rv);
+
     LOAD_SFX(song, "mml/song.mml");
 
     rv = GFMRV_OK;
@@ -0,0 +1,217 @@
+/**
+ * @file src/broadphase.c
+ *
+ * Persistent broad phase over the spatial grid. Bodies at rest stay bucketed
+ * on the grid (they're inserted only once, on level load) and only the bodies
+ * that moved on the current step are checked for overlaps
+ */
+#include <base/arena.h>
+#include <base/broadphase.h>
+#include <base/drawlist.h>
+#include <base/game_ctx.h>
+#include <base/grid.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+struct stBroadPhase {
+    /** Grid where every body is bucketed */
+    spatialGrid *pGrid;
+    /** Bodies woken on the current step */
+    int *pAwake;
+    /** Whether each body is on the awake list */
+    unsigned char *pIsAwake;
+    /** Pairs found by the last run (enough for every body overlapping as
+     * many bodies as may be reported) */
+    int *pPairs;
+    /** Number of bodies on the awake list */
+    int numAwake;
+    /** Number of bodies checked by the last run */
+    int numChecked;
+    /** Number of pairs found by the last run */
+    int numPairs;
+    /** How many bodies there may be */
+    int maxBodies;
+};
+
+/**
+ * Release the broad phase (it belongs to the level arena, so this only clears
+ * the reference)
+ *
+ * @param  [ in]ppCtx The broad phase
+ */
+void broadphase_free(broadPhase **ppCtx) {
+    if (!ppCtx) {
+        return;
+    }
+
+    *ppCtx = 0;
+}
+
+/**
+ * Alloc a new broad phase from the level arena
+ *
+ * @param  [out]ppCtx     The alloc'ed broad phase
+ * @param  [ in]pGrid     Grid where every body is bucketed
+ * @param  [ in]maxBodies How many bodies there may be (the same as the grid's
+ *                        entries)
+ * @return                GFraMe return value
+ */
+gfmRV broadphase_getNew(broadPhase **ppCtx, spatialGrid *pGrid, int maxBodies) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The new broad phase */
+    broadPhase *pCtx;
+
+    ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pGrid, GFMRV_ARGUMENTS_BAD);
+    ASSERT(maxBodies > 0, GFMRV_ARGUMENTS_BAD);
+
+    rv = arena_alloc((void**)&pCtx, &(pGlobal->levelArena),
+            sizeof(broadPhase));
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = arena_alloc((void**)&(pCtx->pAwake), &(pGlobal->levelArena),
+            sizeof(int) * maxBodies);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = arena_alloc((void**)&(pCtx->pIsAwake), &(pGlobal->levelArena),
+            sizeof(unsigned char) * maxBodies);
+    ASSERT(rv == GFMRV_OK, rv);
+    /* The pairs are kept for the whole level, since many steps may run on a
+     * single frame (which would exhaust the frame arena) */
+    rv = arena_alloc((void**)&(pCtx->pPairs), &(pGlobal->levelArena),
+            sizeof(int) * 2 * BP_MAX_OVERLAPS * maxBodies);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    pCtx->pGrid = pGrid;
+    pCtx->maxBodies = maxBodies;
+
+    *ppCtx = pCtx;
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Signal that a body moved (or must be checked) on the current step
+ *
+ * @param  [ in]pCtx The broad phase
+ * @param  [ in]id   The body's ID on the grid
+ * @return           GFraMe return value
+ */
+gfmRV broadphase_wake(broadPhase *pCtx, int id) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(id >= 0 && id < pCtx->maxBodies, GFMRV_ARGUMENTS_BAD);
+
+    if (!pCtx->pIsAwake[id]) {
+        pCtx->pIsAwake[id] = 1;
+        pCtx->pAwake[pCtx->numAwake] = id;
+        pCtx->numAwake++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Find every pair of overlapping bodies in which at least one was woken on
+ * this step. The pairs are stored on the broad phase (overwriting the previous
+ * run's) and every body goes back to rest
+ *
+ * @param  [ in]pCtx The broad phase
+ * @return           GFraMe return value
+ */
+gfmRV broadphase_run(broadPhase *pCtx) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the awake bodies */
+    int i;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+
+    pCtx->numPairs = 0;
+    pCtx->numChecked = pCtx->numAwake;
+    if (pCtx->numAwake == 0) {
+        /* Nothing moved, so nothing new may be overlapping */
+        rv = GFMRV_OK;
+        goto __ret;
+    }
+
+    i = 0;
+    while (i < pCtx->numAwake) {
+        /** Bodies overlapping the current one */
+        int pOverlaps[BP_MAX_OVERLAPS];
+        /** The current body */
+        int id;
+        /** Number of overlapping bodies */
+        int num;
+        /** Iterate through the overlapping bodies */
+        int j;
+
+        id = pCtx->pAwake[i];
+        num = grid_queryOverlaps(pOverlaps, pCtx->pGrid, id, ~0/*layer*/,
+                BP_MAX_OVERLAPS);
+
+        j = 0;
+        while (j < num) {
+            /* If both bodies are awake, only report the pair once */
+            if (!pCtx->pIsAwake[pOverlaps[j]] || id < pOverlaps[j]) {
+                pCtx->pPairs[pCtx->numPairs * 2 + 0] = id;
+                pCtx->pPairs[pCtx->numPairs * 2 + 1] = pOverlaps[j];
+                pCtx->numPairs++;
+            }
+            j++;
+        }
+        i++;
+    }
+
+    /* Put every body back to rest */
+    i = 0;
+    while (i < pCtx->numAwake) {
+        pCtx->pIsAwake[pCtx->pAwake[i]] = 0;
+        i++;
+    }
+    pCtx->numAwake = 0;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Retrieve the pairs found by the last broadphase_run
+ *
+ * @param  [out]ppPairs The pairs, as a list of IDs (i.e., the first pair is
+ *                      (ppPairs[0], ppPairs[1]))
+ * @param  [ in]pCtx    The broad phase
+ * @return              The number of pairs
+ */
+int broadphase_getPairs(int **ppPairs, broadPhase *pCtx) {
+    *ppPairs = pCtx->pPairs;
+    return pCtx->numPairs;
+}
+
+/**
+ * Mostly for debug, record the number of bodies checked and pairs found by the
+ * last run
+ *
+ * @param  [ in]pCtx The broad phase
+ */
+void broadphase_draw(broadPhase *pCtx) {
+#if defined(DEBUG)
+    /* Debug the bodies checked */
+    drawlist_pushTile(pGlobal->pDrawList, SSET_8x8, 160-40/*x*/, 120-16/*y*/,
+            'B' - '!', 0/*isFlipped*/);
+    drawlist_pushNumber(pGlobal->pDrawList, SSET_8x8, 160-32/*x*/, 120-16/*y*/,
+            pCtx->numChecked, 3/*numDigits*/);
+
+    /* Debug the pairs found */
+    drawlist_pushTile(pGlobal->pDrawList, SSET_8x8, 160-40/*x*/, 120-8/*y*/,
+            'P' - '!', 0/*isFlipped*/);
+    drawlist_pushNumber(pGlobal->pDrawList, SSET_8x8, 160-32/*x*/, 120-8/*y*/,
+            pCtx->numPairs, 3/*numDigits*/);
+#endif
+}
@@ -3,7 +3,12 @@
  *
  * Parser for cauldrons. Also implements Drag 'n' Drop.
  */
+#include <base/arena.h>
+#include <base/drawlist.h>
 #include <base/game_ctx.h>
+#include <base/grid.h>
+#include <base/lod.h>
+#include <base/particles.h>
 
 #include <GFraMe/gfmAssert.h>
 #include <GFraMe/gfmError.h>
@@ -19,15 +24,19 @@
 
 static int pCauldronAnim[] = {9, 10, 11, 12};
 
+/** How many particles are spawned when the cauldron explodes */
+#define EXPLOSION_PARTICLES 20000
+
 /**
- * Release all alloc'ed memory
+ * Release everything alloc'ed by the cauldron (the cauldron itself belongs to
+ * the level arena, so it's only released when the arena is reset)
  *
  * @param  [ in]ppCal The cauldron to be release
  * @return            GFraMe return value
  */
 void cauldron_free(cauldron **ppCal) {
     /** Avoid errors */
-    if (!ppCal) {
+    if (!ppCal || !*ppCal) {
         return;
     }
 
@@ -36,13 +45,11 @@ void cauldron_free(cauldron **ppCal) {
         gfmSprite_free(&((*ppCal)->pSelf));
     }
 
-    /** Release the cauldron */
-    free(ppCal);
     *ppCal = 0;
 }
 
 /**
- * Alloc a new cauldron
+ * Alloc a new cauldron from the level arena
  *
  * @param  [out]ppCal The alloc'ed cauldron
  * @return            GFraMe return value
@@ -53,12 +60,12 @@ gfmRV cauldron_getNew(cauldron **ppCal) {
     /** The new cauldron */
     cauldron *pCal;
 
+    pCal = 0;
     ASSERT(ppCal, GFMRV_ARGUMENTS_BAD);
 
     /** Alloc the cauldron and every reference within it */
-    pCal = (cauldron*)malloc(sizeof(cauldron));
-    ASSERT(pCal, GFMRV_ALLOC_FAILED);
-    memset(pCal, 0x0, sizeof(cauldron));
+    rv = arena_alloc((void**)&pCal, &(pGlobal->levelArena), sizeof(cauldron));
+    ASSERT(rv == GFMRV_OK, rv);
     rv = gfmSprite_getNew(&(pCal->pSelf));
     ASSERT(rv == GFMRV_OK, rv);
 
@@ -133,6 +140,11 @@ gfmRV cauldron_init(cauldron *pCal, gfmParser *pParser) {
             0 /* loop */);
     ASSERT(rv == GFMRV_OK, rv);
 
+    /* Make it a drop target */
+    rv = grid_insert(pGlobal->pGrid, GRID_ID_CAULDRON, GRID_LAYER_TARGET, x, y,
+            width, height);
+    ASSERT(rv == GFMRV_OK, rv);
+
     rv = GFMRV_OK;
 __ret:
     return GFMRV_OK;
@@ -147,10 +159,43 @@ __ret:
 gfmRV cauldron_doExplode(cauldron *pCal) {
     /** GFraMe return value */
     gfmRV rv;
+    /** How the explosion's particles are spawned */
+    emitter explosion;
+    /** The cauldron's position and dimensions */
+    int x, y, width, height;
+
+    /* Only explode once */
+    if (pCal->anim == -1) {
+        return GFMRV_OK;
+    }
 
     rv = gfmSprite_playAnimation(pCal->pSelf, pCal->anim);
+    ASSERT(rv == GFMRV_OK, rv);
     pCal->anim = -1;
 
+    /* Burst from the cauldron's center */
+    rv = gfmSprite_getPosition(&x, &y, pCal->pSelf);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = gfmSprite_getDimensions(&width, &height, pCal->pSelf);
+    ASSERT(rv == GFMRV_OK, rv);
+    explosion.x = (float)(x + width / 2);
+    explosion.y = (float)(y + height / 2);
+    explosion.vxMin = -90;
+    explosion.vxMax = 90;
+    explosion.vyMin = -120;
+    explosion.vyMax = 20;
+    explosion.ax = 0;
+    explosion.ay = 60;
+    explosion.ttlMin = lod_scale(600, LOD_TTL);
+    explosion.ttlMax = lod_scale(2000, LOD_TTL);
+    explosion.firstTile = 12;
+    explosion.numTiles = 4;
+    rv = particles_emit(pGlobal->pParticles, &explosion,
+            lod_scale(EXPLOSION_PARTICLES, LOD_SPAWN));
+    ASSERT(rv == GFMRV_OK, rv);
+
+    rv = GFMRV_OK;
+__ret:
     return rv;
 }
 
@@ -165,23 +210,11 @@ gfmRV cauldron_update(cauldron *pCal) {
 }
 
 /**
- * Draw the cauldron
+ * Record the cauldron into the draw list
  *
  * @param  [ in]pCal The cauldron
  * @return           GFraMe return value
  */
 gfmRV cauldron_draw(cauldron *pCal) {
-    return gfmSprite_draw(pCal->pSelf, pGame->pCtx);
-}
-
-/**
- * Check if a sprite is overlapping the cauldron
- *
- * @param  [ in]pCal The cauldron
- * @param  [ in]pSpr The other sprite
- * @return           GFraMe return value
- */
-gfmRV cauldron_isOverlapping(cauldron *pCal, gfmSprite *pSpr) {
-    return gfmSprite_isOverlaping(pCal->pSelf, pSpr);
+    return drawlist_pushSprite(pGlobal->pDrawList, SSET_64x64, pCal->pSelf);
 }
-
@@ -3,47 +3,138 @@
  *
  * @file src/collision.c
  */
+#include <base/broadphase.h>
 #include <base/collision.h>
+#include <base/game_const.h>
 #include <base/game_ctx.h>
 
 #include <GFraMe/gfmAssert.h>
 #include <GFraMe/gfmError.h>
-#include <GFraMe/gfmObject.h>
-#include <GFraMe/gfmQuadtree.h>
-#include <GFraMe/gfmSprite.h>
-#include <GFraMe/gfmTypes.h>
+
+#include <ggj16/itemStore.h>
+#include <ggj16/type.h>
 
 #if defined(DEBUG) && !(defined(__WIN32) || defined(__WIN32__))
-#include <stdlib.h>
 #  include <signal.h>
 #endif
 
+/** Handler registered for a pair of types */
+struct stCollisionEntry {
+    /** The handler (NULL, if the pair wasn't registered) */
+    collisionHandler handler;
+    /** Whether the bodies must be swapped before calling the handler (i.e.,
+     * the pair was registered in the other order) */
+    int doSwap;
+};
+typedef struct stCollisionEntry collisionEntry;
+
+/** Handler of every pair of types, indexed by [type1][type2] */
+static collisionEntry pTable[T_MAX][T_MAX];
+
 /**
- * Retrieve a object's main subtype
+ * Retrieve a body's type
  *
- * @param  [out]ppObj The object's pointer
- * @param  [out]pType The object's type
- * @param  [ in]pObj  The gfmObject being collided/overlaped
+ * @param  [out]pType The body's type
+ * @param  [ in]id    The body's ID on the grid
  * @param             GFraMe return value
  */
-static inline gfmRV collision_getSubtype(void **ppObj, int *pType, gfmObject *pObj) {
+static inline gfmRV collision_getType(itemType *pType, int id) {
     /** GFraMe return value */
     gfmRV rv;
 
-    /** Get the object's child, if any (it's usually a sprite, but tilemaps, for
-     * examples, doesn't  have a child even though they have a type (which is
-     * OK) */
-    rv = gfmObject_getChild(ppObj, pType, pObj);
-    ASSERT(rv == GFMRV_OK, rv);
+    if (id == GRID_ID_CAULDRON) {
+        *pType = T_CAULDRON;
+    }
+    else {
+        /* Every other body is an item, whose ID is its index on the store */
+        rv = itemStore_getType(pType, pGlobal->pItems, id);
+        ASSERT(rv == GFMRV_OK, rv);
+    }
 
-    if (*pType == gfmType_sprite) {
-        /** The object's child, a sprite */
-        gfmSprite *pSpr;
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
 
-        /** Retrieve the child of the sprite */
-        pSpr = *((gfmSprite**)ppObj);
-        rv = gfmSprite_getChild(ppObj, pType, pSpr);
+/**
+ * Handle pairs that overlap but don't interact (e.g., dragging an item over
+ * another)
+ *
+ * @param  [ in]id1 The first body's ID on the grid
+ * @param  [ in]id2 The second body's ID on the grid
+ * @return          GFraMe return value
+ */
+static gfmRV collision_ignore(int id1, int id2) {
+    return GFMRV_OK;
+}
+
+/**
+ * Handle an item overlapping the cauldron
+ *
+ * @param  [ in]cauldronId The cauldron's ID on the grid
+ * @param  [ in]itemId     The item's ID on the grid
+ * @return                 GFraMe return value
+ */
+static gfmRV collision_cauldronItem(int cauldronId, int itemId) {
+    return itemStore_onCauldron(pGlobal->pItems, itemId);
+}
+
+/**
+ * Register every collision handler
+ *
+ * @return GFraMe return value
+ */
+gfmRV collision_init() {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the items' types */
+    itemType type, other;
+
+    type = T_CAULDRON + 1;
+    while (type < T_MAX) {
+        /* Check if items were dropped onto the cauldron */
+        rv = collision_register(T_CAULDRON, type, collision_cauldronItem);
         ASSERT(rv == GFMRV_OK, rv);
+
+        /* Items may be dragged over each other */
+        other = type;
+        while (other < T_MAX) {
+            rv = collision_register(type, other, collision_ignore);
+            ASSERT(rv == GFMRV_OK, rv);
+            other++;
+        }
+
+        type++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Register the handler for a pair of types (for both orders in which they may
+ * overlap)
+ *
+ * @param  [ in]type1   The first type
+ * @param  [ in]type2   The second type
+ * @param  [ in]handler The handler
+ * @return              GFraMe return value
+ */
+gfmRV collision_register(itemType type1, itemType type2,
+        collisionHandler handler) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(type1 >= 0 && type1 < T_MAX, GFMRV_ARGUMENTS_BAD);
+    ASSERT(type2 >= 0 && type2 < T_MAX, GFMRV_ARGUMENTS_BAD);
+    ASSERT(handler, GFMRV_ARGUMENTS_BAD);
+
+    pTable[type1][type2].handler = handler;
+    pTable[type1][type2].doSwap = 0;
+    if (type1 != type2) {
+        pTable[type2][type1].handler = handler;
+        pTable[type2][type1].doSwap = 1;
     }
 
     rv = GFMRV_OK;
@@ -52,77 +143,64 @@ __ret:
 }
 
 /**
- * Continue the currently executing collision and handle the interaction of
- * objects
+ * Find every pair of bodies overlapping on this step (through the broad phase)
+ * and handle the interaction of objects
  *
  * @return GFraMe return value
  */
 gfmRV collision_run() {
     /** GFraMe return value */
     gfmRV rv;
+    /** Overlapping pairs */
+    int *pPairs;
+    /** Number of pairs */
+    int numPairs;
+    /** Iterate through the pairs */
+    int i;
 
-    /* Continue colliding until the quadtree finishes */
-    rv = GFMRV_QUADTREE_OVERLAPED;
-    while (rv != GFMRV_QUADTREE_DONE) {
-        /** Overlaping gfmObjects */
-        gfmObject *pObj1, *pObj2;
-        /** gfmObjects children (if any) */
-        void *pChild1, *pChild2;
-        int type1, type2;
-#if 0
-        /** Objects' types OR'd together */
-        int orType;
-#endif /* 0 */
-
-        /* Retrieve the two overlaping objects and their types */
-        rv = gfmQuadtree_getOverlaping(&pObj1, &pObj2, pGlobal->pQt);
-        ASSERT(rv == GFMRV_OK, rv);
-        rv = collision_getSubtype(&pChild1, &type1, pObj1);
+    rv = broadphase_run(pGlobal->pBroadPhase);
+    ASSERT(rv == GFMRV_OK, rv);
+    numPairs = broadphase_getPairs(&pPairs, pGlobal->pBroadPhase);
+
+    i = 0;
+    while (i < numPairs) {
+        /** Overlapping bodies */
+        int id1, id2;
+        /** Bodies' types */
+        itemType type1, type2;
+        /** Handler for this pair */
+        collisionEntry *pEntry;
+
+        id1 = pPairs[i * 2 + 0];
+        id2 = pPairs[i * 2 + 1];
+        rv = collision_getType(&type1, id1);
         ASSERT(rv == GFMRV_OK, rv);
-        rv = collision_getSubtype(&pChild2, &type2, pObj2);
+        rv = collision_getType(&type2, id2);
         ASSERT(rv == GFMRV_OK, rv);
 
-#if 0
-        /* If types have at most 16 bits, one could easily OR them together to
-         * use a nice case to filter collision/handle */
-        orType = type1 | (type2 << 16);
-
         /* Handle the collision */
-        rv = GFMRV_OK;
-        switch (orType) {
-            /* e.g.: Handle collision between A and B the same as A and C */
-            case TYPE_A | (TYPE_B << 16):
-            case TYPE_A | (TYPE_C << 16): {
-                /* Handle it here */
-                rv = handleFunction((typeA*)pChild1, pObj2);
-            } break;
-            case TYPE_B | (TYPE_A << 16):
-            case TYPE_C | (TYPE_A << 16): {
-                /* Handle it here */
-                rv = handleFunction((typeA*)pChild2, pObj1);
-            } break;
+        pEntry = &(pTable[type1][type2]);
+        if (pEntry->handler && pEntry->doSwap) {
+            rv = pEntry->handler(id2, id1);
+        }
+        else if (pEntry->handler) {
+            rv = pEntry->handler(id1, id2);
+        }
+        else {
             /* On Linux, a SIGINT is raised any time a unhandled collision
-             * happens. When debugging, GDB will stop here and allow the user to
-             * check which types weren't handled */
-            default: {
-#  if defined(DEBUG) && !(defined(__WIN32) || defined(__WIN32__))
-                /* Unfiltered collision, do something about it */
-                raise(SIGINT);
-                rv = GFMRV_INTERNAL_ERROR;
-#  endif
-            }
-        } /* switch (orType) */
-        ASSERT(rv == GFMRV_OK, rv);
+             * happens. When debugging, GDB will stop here and allow the user
+             * to check which types weren't handled */
+#if defined(DEBUG) && !(defined(__WIN32) || defined(__WIN32__))
+            raise(SIGINT);
 #endif
+            rv = GFMRV_OK;
+        }
+        ASSERT(rv == GFMRV_OK, rv);
 
-        /** Update the quadtree (so any other collision is detected) */
-        rv = gfmQuadtree_continue(pGlobal->pQt);
-        ASSERT(rv == GFMRV_QUADTREE_OVERLAPED || rv == GFMRV_QUADTREE_DONE,
-                rv);
+        i++;
     }
 
     rv = GFMRV_OK;
 __ret:
     return rv;
 }
-
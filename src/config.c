@@ -28,6 +28,8 @@ static gfmRV config_saveCur(gfmSave *pSave) {
     ASSERT(rv == GFMRV_OK, rv);
     rv = gfmSave_writeStatic(pSave, CONF_ID_FPS, pConfig->fps);
     ASSERT(rv == GFMRV_OK, rv);
+    rv = gfmSave_writeStatic(pSave, CONF_ID_UPS, pConfig->ups);
+    ASSERT(rv == GFMRV_OK, rv);
     rv = gfmSave_writeStatic(pSave, CONF_ID_AUDIOQ, pConfig->audioQuality);
     ASSERT(rv == GFMRV_OK, rv);
 
@@ -55,6 +57,8 @@ static gfmRV config_saveLastValid(gfmSave *pSave) {
     ASSERT(rv == GFMRV_OK, rv);
     rv = gfmSave_writeStatic(pSave, CONF_ID_LAST_FPS, pConfig->pLast->fps);
     ASSERT(rv == GFMRV_OK, rv);
+    rv = gfmSave_writeStatic(pSave, CONF_ID_LAST_UPS, pConfig->pLast->ups);
+    ASSERT(rv == GFMRV_OK, rv);
     rv = gfmSave_writeStatic(pSave, CONF_ID_LAST_AUDIOQ,
             pConfig->pLast->audioQuality);
     ASSERT(rv == GFMRV_OK, rv);
@@ -80,6 +84,8 @@ static gfmRV config_firstLoad(gfmSave *pSave) {
     pConfig->pLast->height = CONF_HEIGHT;
     pConfig->fps = CONF_FPS;
     pConfig->pLast->fps = CONF_FPS;
+    pConfig->ups = CONF_UPS;
+    pConfig->pLast->ups = CONF_UPS;
     pConfig->pLast->audioQuality = CONF_AUDIOQ;
 
     /* Save it to the file */
@@ -116,6 +122,13 @@ static gfmRV config_doLoad(gfmSave *pSave) {
     ASSERT(rv == GFMRV_OK, rv);
     rv = gfmSave_readStatic(&(pConfig->fps), pSave, CONF_ID_FPS);
     ASSERT(rv == GFMRV_OK, rv);
+    /* The simulation rate was added later, so older files may not have it */
+    rv = gfmSave_readStatic(&(pConfig->ups), pSave, CONF_ID_UPS);
+    if (rv == GFMRV_SAVE_ID_NOT_FOUND) {
+        pConfig->ups = CONF_UPS;
+        rv = GFMRV_OK;
+    }
+    ASSERT(rv == GFMRV_OK, rv);
     rv = gfmSave_readStatic((int*)&(pConfig->audioQuality), pSave,
             CONF_ID_AUDIOQ);
     ASSERT(rv == GFMRV_OK, rv);
@@ -133,6 +146,12 @@ static gfmRV config_doLoad(gfmSave *pSave) {
     ASSERT(rv == GFMRV_OK, rv);
     rv = gfmSave_readStatic(&(pConfig->pLast->fps), pSave, CONF_ID_LAST_FPS);
     ASSERT(rv == GFMRV_OK, rv);
+    rv = gfmSave_readStatic(&(pConfig->pLast->ups), pSave, CONF_ID_LAST_UPS);
+    if (rv == GFMRV_SAVE_ID_NOT_FOUND) {
+        pConfig->pLast->ups = CONF_UPS;
+        rv = GFMRV_OK;
+    }
+    ASSERT(rv == GFMRV_OK, rv);
     rv = gfmSave_readStatic((int*)&(pConfig->pLast->audioQuality), pSave,
             CONF_ID_LAST_AUDIOQ);
     ASSERT(rv == GFMRV_OK, rv);
@@ -184,6 +203,7 @@ gfmRV config_load() {
         pConfig->width = pConfig->pLast->width;
         pConfig->height = pConfig->pLast->height;
         pConfig->fps = pConfig->pLast->fps;
+        pConfig->ups = pConfig->pLast->ups;
         pConfig->audioQuality = pConfig->pLast->audioQuality;
     }
 
@@ -266,6 +286,7 @@ gfmRV config_saveCurAsValid() {
     pConfig->pLast->width = pConfig->width;
     pConfig->pLast->height = pConfig->height;
     pConfig->pLast->fps = pConfig->fps;
+    pConfig->pLast->ups = pConfig->ups;
     pConfig->pLast->audioQuality = pConfig->audioQuality;
     /* Save it to the file */
     rv = config_saveLastValid(pSave);
@@ -0,0 +1,280 @@
+/**
+ * @file src/dirty.c
+ *
+ * Tracks which regions of the virtual screen changed between rendered frames.
+ * Everything drawn is marked into a grid of cells along with a hash of what
+ * was drawn, so each cell ends up with a signature of its contents; Cells whose
+ * signature differs from the previously rendered frame are dirty, and are
+ * merged into as few rectangles as possible
+ */
+#include <base/dirty.h>
+#include <base/game_const.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/** Number of columns and rows on the grid */
+#define DIRTY_COLS  ((V_WIDTH + DIRTY_CELL - 1) / DIRTY_CELL)
+#define DIRTY_ROWS  ((V_HEIGHT + DIRTY_CELL - 1) / DIRTY_CELL)
+/** Number of cells on the grid */
+#define DIRTY_CELLS (DIRTY_COLS * DIRTY_ROWS)
+/** Signature of a cell onto which nothing was drawn */
+#define DIRTY_EMPTY 0x811c9dc5
+/** Mix a hash into a signature (FNV-1a-like, so the order matters) */
+#define DIRTY_MIX(sig, hash) (((sig) ^ (hash)) * 0x01000193)
+
+struct stDirtyRects {
+    /** Signature of every cell on the current and on the previous frame */
+    unsigned int pSig[2][DIRTY_CELLS];
+    /** Rectangles that must be redrawn (there are never more than cells) */
+    dirtyRect pRects[DIRTY_CELLS];
+    /** Index of the current frame's signatures */
+    int cur;
+    /** Number of rectangles */
+    int numRects;
+    /** Number of pixels within the rectangles */
+    int area;
+    /** Whether the whole screen is dirty */
+    int isInvalid;
+};
+
+/**
+ * Release the dirty regions
+ *
+ * @param  [ in]ppCtx The dirty regions
+ */
+void dirty_free(dirtyRects **ppCtx) {
+    if (!ppCtx || !*ppCtx) {
+        return;
+    }
+
+    free(*ppCtx);
+    *ppCtx = 0;
+}
+
+/**
+ * Alloc a new dirty regions tracker (everything is dirty on the first frame)
+ *
+ * @param  [out]ppCtx The alloc'ed dirty regions
+ * @return            GFraMe return value
+ */
+gfmRV dirty_getNew(dirtyRects **ppCtx) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
+
+    *ppCtx = (dirtyRects*)malloc(sizeof(dirtyRects));
+    ASSERT(*ppCtx, GFMRV_ALLOC_FAILED);
+    memset(*ppCtx, 0x0, sizeof(dirtyRects));
+    (*ppCtx)->isInvalid = 1;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Make the whole screen dirty on the next frame (e.g., because whatever was
+ * rendered may no longer match its signature)
+ *
+ * @param  [ in]pCtx The dirty regions
+ */
+void dirty_invalidate(dirtyRects *pCtx) {
+    pCtx->isInvalid = 1;
+}
+
+/**
+ * Start marking a new frame
+ *
+ * @param  [ in]pCtx The dirty regions
+ */
+void dirty_begin(dirtyRects *pCtx) {
+    /** The current frame's signatures */
+    unsigned int *pSig;
+    /** Iterate through the cells */
+    int i;
+
+    pCtx->cur ^= 1;
+    pSig = pCtx->pSig[pCtx->cur];
+    i = 0;
+    while (i < DIRTY_CELLS) {
+        pSig[i] = DIRTY_EMPTY;
+        i++;
+    }
+}
+
+/**
+ * Mark something drawn over an area. Its hash should identify what was drawn
+ * (but not where, as that's already accounted for), and the order in which
+ * things are marked matters
+ *
+ * @param  [ in]pCtx   The dirty regions
+ * @param  [ in]x      The area's horizontal position
+ * @param  [ in]y      The area's vertical position
+ * @param  [ in]width  The area's width
+ * @param  [ in]height The area's height
+ * @param  [ in]hash   Hash of what was drawn
+ */
+void dirty_mark(dirtyRects *pCtx, int x, int y, int width, int height,
+        unsigned int hash) {
+    /** The current frame's signatures */
+    unsigned int *pSig;
+    /** Cells covered by the area (inclusive) */
+    int x0, y0, x1, y1;
+    /** Iterate through the cells */
+    int i, j;
+
+    /* Clip the area to the screen */
+    x0 = (x < 0) ? 0 : x;
+    y0 = (y < 0) ? 0 : y;
+    x1 = (x + width > V_WIDTH) ? V_WIDTH : x + width;
+    y1 = (y + height > V_HEIGHT) ? V_HEIGHT : y + height;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    /* The position is also mixed in, so moving something always changes the
+     * signature (even within the same cells) */
+    hash = DIRTY_MIX(DIRTY_MIX(hash, (unsigned int)x),
+            (unsigned int)y);
+
+    x0 /= DIRTY_CELL;
+    y0 /= DIRTY_CELL;
+    x1 = (x1 - 1) / DIRTY_CELL;
+    y1 = (y1 - 1) / DIRTY_CELL;
+    pSig = pCtx->pSig[pCtx->cur];
+    j = y0;
+    while (j <= y1) {
+        i = x0;
+        while (i <= x1) {
+            pSig[j * DIRTY_COLS + i] = DIRTY_MIX(pSig[j * DIRTY_COLS + i],
+                    hash);
+            i++;
+        }
+        j++;
+    }
+}
+
+/**
+ * Finish marking the frame, comparing it with the previous one and merging
+ * every dirty cell into rectangles
+ *
+ * @param  [ in]pCtx The dirty regions
+ */
+void dirty_end(dirtyRects *pCtx) {
+    /** Signatures of the current and of the previous frame */
+    unsigned int *pCur, *pLast;
+    /** Iterate through the cells */
+    int i, j;
+
+    pCur = pCtx->pSig[pCtx->cur];
+    pLast = pCtx->pSig[pCtx->cur ^ 1];
+    pCtx->numRects = 0;
+    pCtx->area = 0;
+
+    if (pCtx->isInvalid) {
+        pCtx->pRects[0].x = 0;
+        pCtx->pRects[0].y = 0;
+        pCtx->pRects[0].width = V_WIDTH;
+        pCtx->pRects[0].height = V_HEIGHT;
+        pCtx->numRects = 1;
+        pCtx->area = V_WIDTH * V_HEIGHT;
+        pCtx->isInvalid = 0;
+        return;
+    }
+
+/** Check whether a cell is dirty */
+#define IS_DIRTY(i, j) \
+    (pCur[(j) * DIRTY_COLS + (i)] != pLast[(j) * DIRTY_COLS + (i)])
+
+    j = 0;
+    while (j < DIRTY_ROWS) {
+        i = 0;
+        while (i < DIRTY_COLS) {
+            /** The rectangle that covers the run of dirty cells */
+            dirtyRect *pRect;
+            /** First dirty cell on the run */
+            int start;
+            /** Iterate through the rectangles */
+            int k;
+
+            if (!IS_DIRTY(i, j)) {
+                i++;
+                continue;
+            }
+            start = i;
+            while (i < DIRTY_COLS && IS_DIRTY(i, j)) {
+                i++;
+            }
+
+            /* Grow a rectangle from the previous row, if it spans exactly the
+             * same columns */
+            pRect = 0;
+            k = 0;
+            while (k < pCtx->numRects) {
+                if (pCtx->pRects[k].x == start * DIRTY_CELL &&
+                        pCtx->pRects[k].width == (i - start) * DIRTY_CELL &&
+                        pCtx->pRects[k].y + pCtx->pRects[k].height ==
+                        j * DIRTY_CELL) {
+                    pRect = &(pCtx->pRects[k]);
+                    break;
+                }
+                k++;
+            }
+            if (pRect) {
+                pRect->height += DIRTY_CELL;
+            }
+            else {
+                pRect = &(pCtx->pRects[pCtx->numRects]);
+                pRect->x = start * DIRTY_CELL;
+                pRect->y = j * DIRTY_CELL;
+                pRect->width = (i - start) * DIRTY_CELL;
+                pRect->height = DIRTY_CELL;
+                pCtx->numRects++;
+            }
+        }
+        j++;
+    }
+
+#undef IS_DIRTY
+
+    /* Keep the rectangles within the screen (if it isn't a multiple of the
+     * cell) and count their area */
+    i = 0;
+    while (i < pCtx->numRects) {
+        if (pCtx->pRects[i].x + pCtx->pRects[i].width > V_WIDTH) {
+            pCtx->pRects[i].width = V_WIDTH - pCtx->pRects[i].x;
+        }
+        if (pCtx->pRects[i].y + pCtx->pRects[i].height > V_HEIGHT) {
+            pCtx->pRects[i].height = V_HEIGHT - pCtx->pRects[i].y;
+        }
+        pCtx->area += pCtx->pRects[i].width * pCtx->pRects[i].height;
+        i++;
+    }
+}
+
+/**
+ * Retrieve the rectangles that must be redrawn on the current frame
+ *
+ * @param  [out]ppRects The rectangles
+ * @param  [out]pNum    How many rectangles there are
+ * @param  [ in]pCtx    The dirty regions
+ */
+void dirty_getRects(dirtyRect **ppRects, int *pNum, dirtyRects *pCtx) {
+    *ppRects = pCtx->pRects;
+    *pNum = pCtx->numRects;
+}
+
+/**
+ * Retrieve how many pixels must be redrawn on the current frame
+ *
+ * @param  [ in]pCtx The dirty regions
+ * @return           The number of pixels
+ */
+int dirty_getArea(dirtyRects *pCtx) {
+    return pCtx->area;
+}
@@ -0,0 +1,809 @@
+/**
+ * @file src/drawlist.c
+ *
+ * Double-buffered list of draw commands. The state records everything that
+ * should be rendered into the back buffer (right after it's updated), and the
+ * renderer consumes the front buffer (i.e., the last completely recorded
+ * frame)
+ *
+ * Every command is recorded into a layer. When the back buffer is finished,
+ * its commands are (stably) sorted by layer and spriteset, so the renderer
+ * submits every quad of a layer/spriteset as a single run, regardless of the
+ * order in which they were recorded
+ */
+#include <base/dirty.h>
+#include <base/drawlist.h>
+#include <base/game_const.h>
+#include <base/game_ctx.h>
+#include <base/softrender.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+#include <GFraMe/gframe.h>
+#include <GFraMe/gfmSprite.h>
+#include <GFraMe/gfmTilemap.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/** Initial number of commands on each buffer (it's expanded as required) */
+#define DRAWLIST_INIT_CMDS  1024
+/** Maximum number of batches (dynamic or static) recorded per frame */
+#define DRAWLIST_MAX_BATCHES 8
+/** Initial number of values (positions and tiles) shared by every batch (it's
+ * expanded as required) */
+#define DRAWLIST_INIT_BATCH 4096
+/** Number of distinct sort keys (layer and spriteset) */
+#define DRAWLIST_NUM_KEYS   (DRAW_LAYER_MAX * SSET_MAX)
+/** Retrieve a command's sort key */
+#define DRAWLIST_KEY(pCmd)  ((pCmd)->layer * SSET_MAX + (pCmd)->sset)
+/** Mix a value into a hash (used to detect what changed between frames) */
+#define DRAWLIST_HASH(hash, val) (((hash) ^ (val)) * 0x9e3779b1)
+
+/** Every kind of command */
+enum enDrawCmdType {
+    DC_TILE = 0,
+    DC_NUMBER,
+    DC_BATCH,
+    DC_STATIC
+};
+
+/** A single command, packed into 12 bytes */
+struct stDrawCmd {
+    /** Command's type (enDrawCmdType) */
+    unsigned char type;
+    /** Command's spriteset (spritesetId) */
+    unsigned char sset;
+    /** Whether the tile is flipped (DC_TILE) or the number of digits
+     * (DC_NUMBER) */
+    unsigned char extra;
+    /** Command's layer (drawLayer) */
+    unsigned char layer;
+    /** Horizontal position */
+    short x;
+    /** Vertical position */
+    short y;
+    /** The tile (DC_TILE), the number (DC_NUMBER) or the index of the batch
+     * (DC_BATCH and DC_STATIC) */
+    int value;
+};
+typedef struct stDrawCmd drawCmd;
+
+/** A batch of tiles, stored as planes (every horizontal position, followed
+ * by every vertical position and then every tile) */
+struct stDrawBatch {
+    /** The tiles of a static batch (owned by whoever recorded it) */
+    short *pStatic;
+    /** Position of the batch within the buffer's batch data (DC_BATCH) */
+    int offset;
+    /** Number of tiles in the batch */
+    int num;
+};
+typedef struct stDrawBatch drawBatch;
+
+/** Everything recorded for a single frame */
+struct stDrawBuffer {
+    /** Recorded commands */
+    drawCmd *pCmds;
+    /** Indices of the commands, sorted by layer and spriteset */
+    int *pOrder;
+    /** Batches referenced by DC_BATCH and DC_STATIC commands */
+    drawBatch pBatches[DRAWLIST_MAX_BATCHES];
+    /** Data of every batch */
+    short *pBatchData;
+    /** Number of commands that fit on pCmds */
+    int len;
+    /** Number of recorded commands */
+    int used;
+    /** Number of recorded batches */
+    int numBatches;
+    /** Number of values that fit on pBatchData */
+    int batchLen;
+    /** Number of values used on pBatchData */
+    int batchUsed;
+};
+typedef struct stDrawBuffer drawBuffer;
+
+struct stDrawList {
+    /** Both buffers */
+    drawBuffer pBuffers[2];
+    /** Index of the buffer being recorded (the other one is rendered) */
+    int back;
+    /** Layer into which commands are currently recorded */
+    drawLayer layer;
+};
+
+/**
+ * Release the list
+ *
+ * @param  [ in]ppCtx The list
+ */
+void drawlist_free(drawList **ppCtx) {
+    if (!ppCtx || !*ppCtx) {
+        return;
+    }
+
+    free((*ppCtx)->pBuffers[0].pCmds);
+    free((*ppCtx)->pBuffers[1].pCmds);
+    free((*ppCtx)->pBuffers[0].pOrder);
+    free((*ppCtx)->pBuffers[1].pOrder);
+    free((*ppCtx)->pBuffers[0].pBatchData);
+    free((*ppCtx)->pBuffers[1].pBatchData);
+    free(*ppCtx);
+    *ppCtx = 0;
+}
+
+/**
+ * Alloc a new list
+ *
+ * @param  [out]ppCtx The alloc'ed list
+ * @return            GFraMe return value
+ */
+gfmRV drawlist_getNew(drawList **ppCtx) {
+    /** The alloc'ed list */
+    drawList *pCtx;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the buffers */
+    int i;
+
+    /* Sanitize arguments */
+    ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
+
+    pCtx = (drawList*)malloc(sizeof(drawList));
+    ASSERT(pCtx, GFMRV_ALLOC_FAILED);
+    memset(pCtx, 0x0, sizeof(drawList));
+
+    i = 0;
+    while (i < 2) {
+        pCtx->pBuffers[i].pCmds = (drawCmd*)malloc(sizeof(drawCmd) *
+                DRAWLIST_INIT_CMDS);
+        ASSERT(pCtx->pBuffers[i].pCmds, GFMRV_ALLOC_FAILED);
+        pCtx->pBuffers[i].pOrder = (int*)malloc(sizeof(int) *
+                DRAWLIST_INIT_CMDS);
+        ASSERT(pCtx->pBuffers[i].pOrder, GFMRV_ALLOC_FAILED);
+        pCtx->pBuffers[i].len = DRAWLIST_INIT_CMDS;
+        pCtx->pBuffers[i].pBatchData = (short*)malloc(sizeof(short) *
+                DRAWLIST_INIT_BATCH);
+        ASSERT(pCtx->pBuffers[i].pBatchData, GFMRV_ALLOC_FAILED);
+        pCtx->pBuffers[i].batchLen = DRAWLIST_INIT_BATCH;
+        i++;
+    }
+
+    *ppCtx = pCtx;
+    rv = GFMRV_OK;
+__ret:
+    if (rv != GFMRV_OK) {
+        drawlist_free(&pCtx);
+    }
+
+    return rv;
+}
+
+/**
+ * Start recording a new frame into the back buffer
+ *
+ * @param  [ in]pCtx The list
+ */
+void drawlist_begin(drawList *pCtx) {
+    pCtx->pBuffers[pCtx->back].used = 0;
+    pCtx->pBuffers[pCtx->back].numBatches = 0;
+    pCtx->pBuffers[pCtx->back].batchUsed = 0;
+    pCtx->layer = DRAW_LAYER_BACKGROUND;
+}
+
+/**
+ * Finish recording the back buffer (sorting its commands) and make it the one
+ * rendered
+ *
+ * @param  [ in]pCtx The list
+ */
+void drawlist_swap(drawList *pCtx) {
+    /** The buffer that was recorded */
+    drawBuffer *pBuf;
+    /** First position of each key on the sorted order */
+    int pStart[DRAWLIST_NUM_KEYS + 1];
+    /** Iterate through the commands and keys */
+    int i;
+
+    /* Counting sort the commands (which keeps the recorded order within each
+     * key) */
+    pBuf = &(pCtx->pBuffers[pCtx->back]);
+    memset(pStart, 0x0, sizeof(pStart));
+    i = 0;
+    while (i < pBuf->used) {
+        pStart[DRAWLIST_KEY(&(pBuf->pCmds[i])) + 1]++;
+        i++;
+    }
+    i = 1;
+    while (i <= DRAWLIST_NUM_KEYS) {
+        pStart[i] += pStart[i - 1];
+        i++;
+    }
+    i = 0;
+    while (i < pBuf->used) {
+        pBuf->pOrder[pStart[DRAWLIST_KEY(&(pBuf->pCmds[i]))]++] = i;
+        i++;
+    }
+
+    pCtx->back ^= 1;
+}
+
+/**
+ * Set the layer into which the following commands are recorded (reset to
+ * DRAW_LAYER_BACKGROUND on drawlist_begin)
+ *
+ * @param  [ in]pCtx  The list
+ * @param  [ in]layer The layer
+ */
+void drawlist_setLayer(drawList *pCtx, drawLayer layer) {
+    pCtx->layer = layer;
+}
+
+/**
+ * Retrieve a new command from the back buffer, expanding it as necessary
+ *
+ * @param  [out]ppCmd The command
+ * @param  [ in]pCtx  The list
+ * @return            GFraMe return value
+ */
+static gfmRV drawlist_getNextCmd(drawCmd **ppCmd, drawList *pCtx) {
+    /** The buffer being recorded */
+    drawBuffer *pBuf;
+    /** GFraMe return value */
+    gfmRV rv;
+
+    pBuf = &(pCtx->pBuffers[pCtx->back]);
+    if (pBuf->used >= pBuf->len) {
+        /** The expanded buffer */
+        drawCmd *pTmp;
+        /** The expanded order */
+        int *pTmpOrder;
+
+        pTmp = (drawCmd*)realloc(pBuf->pCmds, sizeof(drawCmd) * pBuf->len * 2);
+        ASSERT(pTmp, GFMRV_ALLOC_FAILED);
+        pBuf->pCmds = pTmp;
+        pTmpOrder = (int*)realloc(pBuf->pOrder, sizeof(int) * pBuf->len * 2);
+        ASSERT(pTmpOrder, GFMRV_ALLOC_FAILED);
+        pBuf->pOrder = pTmpOrder;
+        pBuf->len *= 2;
+    }
+
+    *ppCmd = &(pBuf->pCmds[pBuf->used]);
+    (*ppCmd)->layer = (unsigned char)pCtx->layer;
+    pBuf->used++;
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Record a single tile
+ *
+ * @param  [ in]pCtx  The list
+ * @param  [ in]sset  The tile's spriteset
+ * @param  [ in]x     The tile's horizontal position
+ * @param  [ in]y     The tile's vertical position
+ * @param  [ in]tile  The tile
+ * @param  [ in]isFlipped Whether the tile is horizontally flipped
+ * @return            GFraMe return value
+ */
+gfmRV drawlist_pushTile(drawList *pCtx, spritesetId sset, int x, int y,
+        int tile, int isFlipped) {
+    /** The recorded command */
+    drawCmd *pCmd;
+    /** GFraMe return value */
+    gfmRV rv;
+
+    rv = drawlist_getNextCmd(&pCmd, pCtx);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    pCmd->type = DC_TILE;
+    pCmd->sset = (unsigned char)sset;
+    pCmd->extra = (unsigned char)(isFlipped != 0);
+    pCmd->x = (short)x;
+    pCmd->y = (short)y;
+    pCmd->value = tile;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Record a number (each digit uses the atlas' ASCII glyphs, which start at tile
+ * 0 for ' ')
+ *
+ * @param  [ in]pCtx      The list
+ * @param  [ in]sset      The digits' spriteset
+ * @param  [ in]x         The number's horizontal position
+ * @param  [ in]y         The number's vertical position
+ * @param  [ in]num       The number
+ * @param  [ in]numDigits How many digits should be rendered
+ * @return                GFraMe return value
+ */
+gfmRV drawlist_pushNumber(drawList *pCtx, spritesetId sset, int x, int y,
+        int num, int numDigits) {
+    /** The recorded command */
+    drawCmd *pCmd;
+    /** GFraMe return value */
+    gfmRV rv;
+
+    rv = drawlist_getNextCmd(&pCmd, pCtx);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    pCmd->type = DC_NUMBER;
+    pCmd->sset = (unsigned char)sset;
+    pCmd->extra = (unsigned char)numDigits;
+    pCmd->x = (short)x;
+    pCmd->y = (short)y;
+    pCmd->value = num;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Record a sprite's current frame on its current position
+ *
+ * @param  [ in]pCtx The list
+ * @param  [ in]sset The sprite's spriteset
+ * @param  [ in]pSpr The sprite
+ * @return           GFraMe return value
+ */
+gfmRV drawlist_pushSprite(drawList *pCtx, spritesetId sset, gfmSprite *pSpr) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Sprite's position */
+    int x, y;
+    /** Sprite's offset from its position */
+    int offX, offY;
+    /** Sprite's current frame */
+    int tile;
+
+    rv = gfmSprite_getPosition(&x, &y, pSpr);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = gfmSprite_getOffset(&offX, &offY, pSpr);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = gfmSprite_getFrame(&tile, pSpr);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    rv = drawlist_pushTile(pCtx, sset, x + offX, y + offY, tile,
+            0/*isFlipped*/);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Record every visible tile in a tilemap
+ *
+ * @param  [ in]pCtx  The list
+ * @param  [ in]sset  The tilemap's spriteset
+ * @param  [ in]pTMap The tilemap
+ * @param  [ in]x     The tilemap's horizontal position
+ * @param  [ in]y     The tilemap's vertical position
+ * @return            GFraMe return value
+ */
+gfmRV drawlist_pushTilemap(drawList *pCtx, spritesetId sset,
+        gfmTilemap *pTMap, int x, int y) {
+    /** Tilemap's tiles */
+    int *pData;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Tilemap's dimensions, in tiles */
+    int width, height;
+    /** Current tile */
+    int i, j;
+    /** Tile's dimensions, in pixels */
+    int size;
+
+    size = SSET_TILE_SIZE(sset);
+    rv = gfmTilemap_getDimension(&width, &height, pTMap);
+    ASSERT(rv == GFMRV_OK, rv);
+    width /= size;
+    height /= size;
+    rv = gfmTilemap_getData(&pData, pTMap);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    /* Only record the rows that are within the screen */
+    j = 0;
+    if (y < -size) {
+        j = (-y) / size - 1;
+    }
+    while (j < height && y + j * size < V_HEIGHT) {
+        i = 0;
+        while (i < width) {
+            /** The current tile */
+            int tile;
+
+            tile = pData[j * width + i];
+            /* Negative tiles are empty */
+            if (tile >= 0 && x + i * size > -size && x + i * size < V_WIDTH) {
+                rv = drawlist_pushTile(pCtx, sset, x + i * size, y + j * size,
+                        tile, 0/*isFlipped*/);
+                ASSERT(rv == GFMRV_OK, rv);
+            }
+            i++;
+        }
+        j++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Record a batch of tiles (all on the same spriteset). The batch is stored
+ * within the list, and the caller must fill every returned array (until the
+ * next command is recorded)
+ *
+ * @param  [out]ppX     The tiles' horizontal positions
+ * @param  [out]ppY     The tiles' vertical positions
+ * @param  [out]ppTiles The tiles
+ * @param  [ in]pCtx    The list
+ * @param  [ in]sset    The tiles' spriteset
+ * @param  [ in]num     How many tiles there are in the batch
+ * @return              GFraMe return value
+ */
+gfmRV drawlist_pushBatch(short **ppX, short **ppY, short **ppTiles,
+        drawList *pCtx, spritesetId sset, int num) {
+    /** The buffer being recorded */
+    drawBuffer *pBuf;
+    /** The recorded command */
+    drawCmd *pCmd;
+    /** The recorded batch */
+    drawBatch *pBatch;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Values required by the batch (kept aligned to 8 values) */
+    int len;
+
+    pBuf = &(pCtx->pBuffers[pCtx->back]);
+    ASSERT(pBuf->numBatches < DRAWLIST_MAX_BATCHES, GFMRV_INTERNAL_ERROR);
+    ASSERT(num >= 0, GFMRV_ARGUMENTS_BAD);
+
+    len = (3 * num + 7) & ~7;
+    if (pBuf->batchUsed + len > pBuf->batchLen) {
+        /** The expanded buffer */
+        short *pTmp;
+        /** The expanded length */
+        int newLen;
+
+        newLen = pBuf->batchLen * 2;
+        while (pBuf->batchUsed + len > newLen) {
+            newLen *= 2;
+        }
+        pTmp = (short*)realloc(pBuf->pBatchData, sizeof(short) * newLen);
+        ASSERT(pTmp, GFMRV_ALLOC_FAILED);
+        pBuf->pBatchData = pTmp;
+        pBuf->batchLen = newLen;
+    }
+
+    rv = drawlist_getNextCmd(&pCmd, pCtx);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    pCmd->type = DC_BATCH;
+    pCmd->sset = (unsigned char)sset;
+    pCmd->value = pBuf->numBatches;
+
+    pBatch = &(pBuf->pBatches[pBuf->numBatches]);
+    pBatch->pStatic = 0;
+    pBatch->offset = pBuf->batchUsed;
+    pBatch->num = num;
+    pBuf->numBatches++;
+    pBuf->batchUsed += len;
+
+    *ppX = pBuf->pBatchData + pBatch->offset;
+    *ppY = *ppX + num;
+    *ppTiles = *ppY + num;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Record a static batch of tiles (all on the same spriteset). Differently from
+ * drawlist_pushBatch, the tiles aren't copied: they must be kept unchanged
+ * (and alive) for as long as they may be rendered (e.g., alloc'ed from the
+ * level arena), so a backend may cache whatever it renders from them
+ *
+ * @param  [ in]pCtx  The list
+ * @param  [ in]sset  The tiles' spriteset
+ * @param  [ in]pData The tiles, as planes (every horizontal position, every
+ *                    vertical position and then every tile)
+ * @param  [ in]num   How many tiles there are in the batch
+ * @return            GFraMe return value
+ */
+gfmRV drawlist_pushStatic(drawList *pCtx, spritesetId sset, short *pData,
+        int num) {
+    /** The buffer being recorded */
+    drawBuffer *pBuf;
+    /** The recorded command */
+    drawCmd *pCmd;
+    /** The recorded batch */
+    drawBatch *pBatch;
+    /** GFraMe return value */
+    gfmRV rv;
+
+    pBuf = &(pCtx->pBuffers[pCtx->back]);
+    ASSERT(pBuf->numBatches < DRAWLIST_MAX_BATCHES, GFMRV_INTERNAL_ERROR);
+    ASSERT(pData, GFMRV_ARGUMENTS_BAD);
+    ASSERT(num >= 0, GFMRV_ARGUMENTS_BAD);
+
+    rv = drawlist_getNextCmd(&pCmd, pCtx);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    pCmd->type = DC_STATIC;
+    pCmd->sset = (unsigned char)sset;
+    pCmd->value = pBuf->numBatches;
+
+    pBatch = &(pBuf->pBatches[pBuf->numBatches]);
+    pBatch->pStatic = pData;
+    pBatch->offset = 0;
+    pBatch->num = num;
+    pBuf->numBatches++;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Retrieve the framework's spriteset from its ID
+ *
+ * @param  [ in]sset The spriteset's ID
+ * @return           The spriteset
+ */
+static gfmSpriteset* drawlist_getSpriteset(spritesetId sset) {
+    switch (sset) {
+        case SSET_2x2: return pGfx->pSset2x2;
+        case SSET_4x4: return pGfx->pSset4x4;
+        case SSET_8x8: return pGfx->pSset8x8;
+        case SSET_16x16: return pGfx->pSset16x16;
+        case SSET_32x32: return pGfx->pSset32x32;
+        case SSET_64x64: return pGfx->pSset64x64;
+        default: return 0;
+    }
+}
+
+/**
+ * Render every command on a buffer, one run of quads (with the same layer and
+ * spriteset) at a time
+ *
+ * @param  [ in]pBuf  The buffer
+ * @param  [ in]pSoft The software renderer (if NULL, the framework is used)
+ * @return            GFraMe return value
+ */
+static gfmRV drawlist_renderBuffer(drawBuffer *pBuf, softRender *pSoft) {
+    /** The current command */
+    drawCmd *pCmd;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Spriteset of the current run */
+    gfmSpriteset *pSset;
+    /** Iterate through the commands */
+    int i;
+    /** Spriteset ID of the current run */
+    int curSset;
+
+    pSset = 0;
+    curSset = -1;
+    i = 0;
+    while (i < pBuf->used) {
+        pCmd = &(pBuf->pCmds[pBuf->pOrder[i]]);
+
+        /* Only look up the spriteset when a new run starts */
+        if (pCmd->sset != curSset) {
+            curSset = pCmd->sset;
+            pSset = drawlist_getSpriteset(pCmd->sset);
+        }
+
+        switch (pCmd->type) {
+            case DC_TILE: {
+                if (pSoft) {
+                    rv = softrender_drawTile(pSoft, (spritesetId)pCmd->sset,
+                            pCmd->x, pCmd->y, pCmd->value, pCmd->extra);
+                }
+                else {
+                    rv = gfm_drawTile(pGame->pCtx, pSset, pCmd->x, pCmd->y,
+                            pCmd->value, pCmd->extra);
+                }
+            } break;
+            case DC_NUMBER: {
+                if (pSoft) {
+                    rv = softrender_drawNumber(pSoft, (spritesetId)pCmd->sset,
+                            pCmd->x, pCmd->y, pCmd->value, pCmd->extra);
+                }
+                else {
+                    rv = gfm_drawNumber(pGame->pCtx, pSset, pCmd->x, pCmd->y,
+                            pCmd->value, pCmd->extra, 0/*first ascii tile*/);
+                }
+            } break;
+            case DC_BATCH:
+            case DC_STATIC: {
+                /** The batch */
+                drawBatch *pBatch;
+                /** The batch's data */
+                short *pX, *pY, *pTiles;
+                /** Iterate through the tiles */
+                int j;
+
+                pBatch = &(pBuf->pBatches[pCmd->value]);
+                if (pSoft && pCmd->type == DC_STATIC) {
+                    /* Rasterized only once, and cached from then on */
+                    rv = softrender_drawStatic(pSoft, (spritesetId)pCmd->sset,
+                            pBatch->pStatic, pBatch->num);
+                    break;
+                }
+                else if (pCmd->type == DC_STATIC) {
+                    pX = pBatch->pStatic;
+                }
+                else {
+                    pX = pBuf->pBatchData + pBatch->offset;
+                }
+                pY = pX + pBatch->num;
+                pTiles = pY + pBatch->num;
+
+                rv = GFMRV_OK;
+                j = 0;
+                while (rv == GFMRV_OK && j < pBatch->num) {
+                    if (pSoft) {
+                        rv = softrender_drawTile(pSoft,
+                                (spritesetId)pCmd->sset, pX[j], pY[j],
+                                pTiles[j], 0/*isFlipped*/);
+                    }
+                    else {
+                        rv = gfm_drawTile(pGame->pCtx, pSset, pX[j], pY[j],
+                                pTiles[j], 0/*isFlipped*/);
+                    }
+                    j++;
+                }
+            } break;
+            default: rv = GFMRV_INTERNAL_ERROR;
+        }
+        ASSERT(rv == GFMRV_OK, rv);
+
+        i++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Mark everything on a buffer into the dirty regions (hashing each command's
+ * contents)
+ *
+ * @param  [ in]pBuf   The buffer
+ * @param  [ in]pDirty The dirty regions
+ */
+static void drawlist_markDirty(drawBuffer *pBuf, dirtyRects *pDirty) {
+    /** Iterate through the commands */
+    int i;
+
+    i = 0;
+    while (i < pBuf->used) {
+        /** The current command */
+        drawCmd *pCmd;
+        /** Hash of what's drawn */
+        unsigned int hash;
+        /** Dimensions of the command's tiles */
+        int size;
+
+        pCmd = &(pBuf->pCmds[pBuf->pOrder[i]]);
+        size = SSET_TILE_SIZE(pCmd->sset);
+        hash = DRAWLIST_HASH(pCmd->type | (pCmd->sset << 8) |
+                (pCmd->extra << 16) | (pCmd->layer << 24),
+                (unsigned int)pCmd->value);
+
+        switch (pCmd->type) {
+            case DC_TILE: {
+                dirty_mark(pDirty, pCmd->x, pCmd->y, size, size, hash);
+            } break;
+            case DC_NUMBER: {
+                dirty_mark(pDirty, pCmd->x, pCmd->y, size * pCmd->extra, size,
+                        hash);
+            } break;
+            case DC_BATCH: {
+                /** The batch */
+                drawBatch *pBatch;
+                /** The batch's data */
+                short *pX, *pY, *pTiles;
+                /** Iterate through the tiles */
+                int j;
+
+                pBatch = &(pBuf->pBatches[pCmd->value]);
+                pX = pBuf->pBatchData + pBatch->offset;
+                pY = pX + pBatch->num;
+                pTiles = pY + pBatch->num;
+                j = 0;
+                while (j < pBatch->num) {
+                    dirty_mark(pDirty, pX[j], pY[j], size, size,
+                            DRAWLIST_HASH(hash, (unsigned int)pTiles[j]));
+                    j++;
+                }
+            } break;
+            case DC_STATIC: {
+                /** The batch */
+                drawBatch *pBatch;
+
+                /* Its tiles never change, so it's identified by its data */
+                pBatch = &(pBuf->pBatches[pCmd->value]);
+                hash = DRAWLIST_HASH(DRAWLIST_HASH(hash,
+                        (unsigned int)((size_t)pBatch->pStatic >> 1)),
+                        (unsigned int)pBatch->num);
+                dirty_mark(pDirty, 0, 0, V_WIDTH, V_HEIGHT, hash);
+            } break;
+            default: {}
+        }
+
+        i++;
+    }
+}
+
+/**
+ * Render every command on the front buffer, one run of quads (with the same
+ * layer and spriteset) at a time. If there's a software renderer, everything
+ * is rendered through it instead of the framework; And, if the dirty regions
+ * are being tracked, only what changed since the last rendered frame is
+ * redrawn
+ *
+ * @param  [ in]pCtx The list
+ * @return           GFraMe return value
+ */
+gfmRV drawlist_render(drawList *pCtx) {
+    /** The buffer being rendered */
+    drawBuffer *pBuf;
+    /** The dirty regions */
+    dirtyRect *pRects;
+    /** The software renderer (if any) */
+    softRender *pSoft;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the dirty regions */
+    int i;
+    /** Number of dirty regions */
+    int num;
+
+    pBuf = &(pCtx->pBuffers[pCtx->back ^ 1]);
+    pSoft = pGlobal->pSoftRender;
+    if (!pSoft) {
+        rv = drawlist_renderBuffer(pBuf, 0/*pSoft*/);
+        ASSERT(rv == GFMRV_OK, rv);
+    }
+    else if (!pGlobal->pDirty) {
+        softrender_begin(pSoft, 0/*x*/, 0/*y*/, V_WIDTH, V_HEIGHT);
+        rv = drawlist_renderBuffer(pBuf, pSoft);
+        ASSERT(rv == GFMRV_OK, rv);
+        softrender_end(pSoft);
+    }
+    else {
+        /* Compare what's drawn with the last rendered frame */
+        dirty_begin(pGlobal->pDirty);
+        drawlist_markDirty(pBuf, pGlobal->pDirty);
+        dirty_end(pGlobal->pDirty);
+
+        /* Redraw (and upscale) only what changed */
+        dirty_getRects(&pRects, &num, pGlobal->pDirty);
+        i = 0;
+        while (i < num) {
+            softrender_begin(pSoft, pRects[i].x, pRects[i].y, pRects[i].width,
+                    pRects[i].height);
+            rv = drawlist_renderBuffer(pBuf, pSoft);
+            ASSERT(rv == GFMRV_OK, rv);
+            softrender_end(pSoft);
+            i++;
+        }
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file src/frameskip.c
+ *
+ * Controls how much time is simulated and which frames are rendered, honoring
+ * GAME_RUN/GAME_STEP (pausing and stepping), GAME_SKIP_1/GAME_SKIP_2 (skipping
+ * the rendering when the update is over budget) and the fast-forward speed
+ */
+#include <base/frameskip.h>
+#include <base/game_ctx.h>
+#include <base/profiler.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+#include <GFraMe/gfmInput.h>
+
+/** Time when the current frame's update started, in nanoseconds */
+static unsigned long long updateStart = 0;
+
+/**
+ * Handle the debug controls (pause, step and fast-forward). Must be called
+ * once every frame, even if paused
+ *
+ * @return GFraMe return value
+ */
+gfmRV frameskip_handleInput() {
+#if defined(DEBUG)
+    /** GFraMe return value */
+    gfmRV rv;
+
+    /** Check if a button was just released (the simulation may be paused, so
+     * the buttons are read directly) */
+#  define JUST_RELEASED(bt) \
+    rv = gfm_getKeyState(&(pButton->bt.state), &(pButton->bt.numPressed), \
+            pGame->pCtx, pButton->bt.handle); \
+    ASSERT(rv == GFMRV_OK, rv); \
+    if ((pButton->bt.state & gfmInput_justReleased) == gfmInput_justReleased)
+
+    /* Pause/resume */
+    JUST_RELEASED(pause) {
+        pGame->flags ^= GAME_RUN;
+    }
+    /* Simulate a single step (only while paused) */
+    JUST_RELEASED(step) {
+        pGame->flags |= GAME_STEP;
+    }
+    /* Cycle through the fast-forward speeds (1x, 2x, 4x, 8x) */
+    JUST_RELEASED(ffwd) {
+        pGame->speed *= 2;
+        if (pGame->speed > FRAMESKIP_MAX_SPEED) {
+            pGame->speed = 1;
+        }
+    }
+
+#  undef JUST_RELEASED
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+#else
+    /* The controls only exist on debug builds */
+    return GFMRV_OK;
+#endif
+}
+
+/**
+ * Convert the time elapsed since the previous frame into how much time should
+ * be simulated
+ *
+ * @param  [ in]frameTime Time elapsed since the previous frame, in miliseconds
+ * @param  [ in]stepTime  Duration of the next simulation step, in miliseconds
+ * @return                Time that should be simulated, in miliseconds
+ */
+int frameskip_getSimulatedTime(int frameTime, int stepTime) {
+    if (!(pGame->flags & GAME_RUN)) {
+        /* Paused; Simulate exactly one step, if signaled. Since less than a
+         * step is accumulated, adding a whole step runs it only once */
+        if (pGame->flags & GAME_STEP) {
+            pGame->flags &= ~GAME_STEP;
+            return stepTime;
+        }
+        return 0;
+    }
+
+    return frameTime * pGame->speed;
+}
+
+/**
+ * Start measuring the cost of the current frame's update
+ */
+void frameskip_beginUpdate() {
+    updateStart = profiler_getTime();
+}
+
+/**
+ * Finish measuring the cost of the current frame's update and, if it went over
+ * the frame's budget, skip rendering one or two frames
+ */
+void frameskip_endUpdate() {
+    /** How long the update took, in nanoseconds */
+    unsigned long long cost;
+    /** How long the whole frame should take, in nanoseconds */
+    unsigned long long budget;
+
+    cost = profiler_getTime() - updateStart;
+    budget = 1000000000ull / (unsigned long long)pConfig->fps;
+
+    /* Never skip more than two frames in a row, so something is always
+     * rendered */
+    if (pGame->flags & (GAME_SKIP_1 | GAME_SKIP_2)) {
+        return;
+    }
+
+    if (cost > 2 * budget) {
+        pGame->flags |= GAME_SKIP_2;
+    }
+    else if (cost > budget) {
+        pGame->flags |= GAME_SKIP_1;
+    }
+}
+
+/**
+ * Check whether the current frame should be rendered (consuming any pending
+ * skip)
+ *
+ * @return GFMRV_TRUE, GFMRV_FALSE
+ */
+gfmRV frameskip_shouldDraw() {
+    if (pGame->flags & GAME_SKIP_2) {
+        /* Skip this one, and the next */
+        pGame->flags &= ~GAME_SKIP_2;
+        pGame->flags |= GAME_SKIP_1;
+        return GFMRV_FALSE;
+    }
+    else if (pGame->flags & GAME_SKIP_1) {
+        pGame->flags &= ~GAME_SKIP_1;
+        return GFMRV_FALSE;
+    }
+
+    /* When fast-forwarding, only render one of every 'speed' frames */
+    pGame->drawCount++;
+    if (pGame->drawCount < pGame->speed) {
+        return GFMRV_FALSE;
+    }
+    pGame->drawCount = 0;
+
+    return GFMRV_TRUE;
+}
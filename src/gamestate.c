@@ -4,39 +4,42 @@
  * Main game state. Handles game logic, win/lose condition... pretty much
  * everything
  */
+#include <base/arena.h>
+#include <base/broadphase.h>
+#include <base/collision.h>
 #include <base/game_const.h>
+#include <base/drawlist.h>
+#include <base/grid.h>
 #include <base/game_ctx.h>
+#include <base/lod.h>
+#include <base/particles.h>
+#include <base/profiler.h>
+#include <base/staticmap.h>
 
 #include <GFraMe/gfmAssert.h>
 #include <GFraMe/gfmError.h>
-#include <GFraMe/gfmGenericArray.h>
-#include <GFraMe/gfmGroup.h>
 #include <GFraMe/gfmParser.h>
 #include <GFraMe/gfmTilemap.h>
 
+#include <gen/recipeGen.h>
+
 #include <ggj16/cauldron.h>
 #include <ggj16/gesture.h>
 #include <ggj16/gamestate.h>
-#include <ggj16/object.h>
+#include <ggj16/itemStore.h>
 #include <ggj16/type.h>
 
 #include <stdlib.h>
 #include <string.h>
 
-gfmGenArr_define(object);
-
 #define gfmTilemap_loadfStatic(pTMap, pCtx, pFilename, pDictNames, pDictTypes, dictLen) \
     gfmTilemap_loadf(pTMap, pCtx, pFilename, sizeof(pFilename) - 1, pDictNames, pDictTypes, dictLen)
 
 struct stGamestate {
     /** The background */
     gfmTilemap *pBackground;
-    /** List of objects */
-    gfmGenArr_var(object, pObjects);
-    /** Fire particles */
-    gfmGroup *pFire;
-    /** Iterator for spawn fire particles */
-    int curFire;
+    /** The background's static tiles, baked on load */
+    staticMap *pBgCache;
 };
 typedef struct stGamestate gamestate;
 
@@ -44,6 +47,19 @@ static char *dictStr[] = { "dummy" };
 static int dictType[] = { 0 };
 static int dictLen = sizeof(dictType) / sizeof(int);
 
+/** How the fire's particles are spawned */
+static emitter fireEmitter = {
+    79 /* x */, 104 /* y */,
+    -9 /* vxMin */, 13 /* vxMax */,
+    -8 /* vyMin */, -2 /* vyMax */,
+    0 /* ax */, 6 /* ay */,
+    825 /* ttlMin */, 1200 /* ttlMax */,
+    12 /* firstTile */, 4 /* numTiles */
+};
+/** How many fire particles are spawned every frame (on the highest level of
+ * detail) */
+#define FIRE_PER_FRAME 5
+
 static int pBgAnim[] = {
 /* len|fps|loop|data */
     2 , 8 ,  1 ,79,82,
@@ -54,7 +70,8 @@ static int pBgAnim[] = {
 };
 
 /**
- * Release everything alloc'ed on init
+ * Release everything alloc'ed on init. Everything that isn't a framework object
+ * was alloc'ed from the level arena, so it's released at once
  */
 void gs_free() {
     /** The new state */
@@ -64,10 +81,17 @@ void gs_free() {
     pState = (gamestate*)pGame->pState;
 
     cauldron_free(&(pGlobal->pCauldron));
-    gfmGroup_free(&(pState->pFire));
-    gfmGenArr_clean(pState->pObjects, object_free);
+    particles_free(&(pGlobal->pParticles));
+    itemStore_free(&(pGlobal->pItems));
+    staticmap_free(&(pState->pBgCache));
     gfmTilemap_free(&(pState->pBackground));
     recipeScroll_free(&(pGlobal->pRecipe));
+    gesture_free(&(pGlobal->pGesture));
+    broadphase_free(&(pGlobal->pBroadPhase));
+    grid_free(&(pGlobal->pGrid));
+
+    arena_reset(&(pGlobal->levelArena));
+    pGame->pState = 0;
 }
 
 /**
@@ -76,20 +100,30 @@ void gs_free() {
 gfmRV gs_init() {
     /** Parse the objects in the map */
     gfmParser *pParser;
+    /** The level's recipe (the scroller only references it, so it's alloc'ed
+     * from the level arena) */
+    itemType *pRecipeItems;
     /** GFraMe return value */
     gfmRV rv;
     /** The new state */
     gamestate *pState;
+    /** Number of items on the recipe (and how many could be generated) */
+    int recipeLen, maxRecipeLen;
 
     pParser = 0;
+    pState = 0;
 
     /* Check that the state is correct and there's none loaded */
     ASSERT(pGame->nextState == ST_GAME, GFMRV_INTERNAL_ERROR);
     ASSERT(pGame->pState == 0, GFMRV_INTERNAL_ERROR);
 
-    pState = (gamestate*)malloc(sizeof(gamestate));
-    ASSERT(pState, GFMRV_ALLOC_FAILED);
-    memset(pState, 0x0, sizeof(gamestate));
+    rv = arena_alloc((void**)&pState, &(pGlobal->levelArena),
+            sizeof(gamestate));
+    ASSERT(rv == GFMRV_OK, rv);
+
+    /* Initialize the gesture recognizer */
+    rv = gesture_getNew(&(pGlobal->pGesture));
+    ASSERT(rv == GFMRV_OK, rv);
 
     /* Load the background */
     rv = gfmTilemap_getNew(&(pState->pBackground));
@@ -103,8 +137,21 @@ gfmRV gs_init() {
     ASSERT(rv == GFMRV_OK, rv);
     rv = gfmTilemap_recacheAnimations(pState->pBackground);
     ASSERT(rv == GFMRV_OK, rv);
+    /* Bake everything that isn't animated */
+    rv = staticmap_getNew(&(pState->pBgCache));
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = staticmap_init(pState->pBgCache, pState->pBackground, SSET_8x8,
+            0/*x*/, 0/*y*/, pBgAnim, sizeof(pBgAnim) / sizeof(int));
+    ASSERT(rv == GFMRV_OK, rv);
 
-    /* Load all objects */
+    /* Load all objects (bucketing them into the spatial grid) */
+    rv = grid_getNew(&(pGlobal->pGrid), MAX_BOARD_ITEMS + 1/*cauldron*/);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = broadphase_getNew(&(pGlobal->pBroadPhase), pGlobal->pGrid,
+            MAX_BOARD_ITEMS + 1/*cauldron*/);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = itemStore_getNew(&(pGlobal->pItems), MAX_BOARD_ITEMS);
+    ASSERT(rv == GFMRV_OK, rv);
     rv = gfmParser_getNew(&pParser);
     ASSERT(rv == GFMRV_OK, rv);
     rv = gfmParser_initStatic(pParser, pGame->pCtx, "map/map_obj.gfm");
@@ -145,15 +192,9 @@ gfmRV gs_init() {
                 ASSERT(rv == GFMRV_OK, rv);
             }
             else {
-                /** Alloc'ed object */
-                object *pObj;
-
-                /* Parse and spawn the object */
-                gfmGenArr_getNextRef(object, pState->pObjects, 1/* inc */, pObj,
-                        object_getNew);
-                rv = object_init(pObj, pParser);
+                /* Parse and spawn the item */
+                rv = itemStore_add(pGlobal->pItems, pParser);
                 ASSERT(rv == GFMRV_OK, rv);
-                gfmGenArr_push(pState->pObjects);
             }
         }
         else {
@@ -162,69 +203,27 @@ gfmRV gs_init() {
         }
     } /* while(1) parser */
 
-    /* Initialize the fire particles */
-    rv = gfmGroup_getNew(&(pState->pFire));
-    ASSERT(rv == GFMRV_OK, rv);
-    rv = gfmGroup_setDefSpriteset(pState->pFire, pGfx->pSset2x2);
+    /* Initialize the particles (the fire and the explosion) */
+    rv = particles_getNew(&(pGlobal->pParticles), MAX_PARTICLES);
     ASSERT(rv == GFMRV_OK, rv);
-    rv = gfmGroup_setDefDimensions(pState->pFire, 2 /* width */, 2 /* height */,
-            0 /* offX */, 0 /* offY */);
-    ASSERT(rv == GFMRV_OK, rv);
-    rv = gfmGroup_setDefVelocity(pState->pFire, 0 /* vx */, -25 /* vy */);
-    ASSERT(rv == GFMRV_OK, rv);
-    rv = gfmGroup_setDefAcceleration(pState->pFire, 0 /* ax */, 6 /* ay */);
-    ASSERT(rv == GFMRV_OK, rv);
-    rv = gfmGroup_setDeathOnLeave(pState->pFire, 1 /* doDie */);
+    lod_reset();
+
+    /* Generate the recipe (from the cached data, on its own stream) */
+    maxRecipeLen = recipeGen_getMaxLength(pGlobal->pRecipeGen,
+            RECIPE_TUTORIAL);
+    rv = arena_alloc((void**)&pRecipeItems, &(pGlobal->levelArena),
+            sizeof(itemType) * maxRecipeLen);
     ASSERT(rv == GFMRV_OK, rv);
-    rv = gfmGroup_preCache(pState->pFire, 1024, 0/* infinite */);
+    rv = recipeGen_generate(pRecipeItems, &recipeLen, maxRecipeLen,
+            pGlobal->pRecipeGen, RECIPE_TUTORIAL,
+            &(pGlobal->pRng[RNG_RECIPE]));
     ASSERT(rv == GFMRV_OK, rv);
 
     /* Initialize the recipe */
     rv = recipeScroll_getNew(&(pGlobal->pRecipe));
     ASSERT(rv == GFMRV_OK, rv);
-    do {
-		int MAX_ITEMS = 32;
-		
-        itemType pData[MAX_ITEMS];
-		pData[0] = T_EYE;
-		pData[1] = T_PHOENIX_FEATHER;
-		pData[2] = T_WEB;
-		pData[3] = T_ROTATE_CW;
-		pData[4] = T_BONE;
-		pData[5] = T_MONKEY_EAR;
-		pData[6] = T_WAIT;
-		pData[7] = T_BAT_WING;
-		pData[8] = T_RAT_TAIL;
-		
-		pData[9] = T_EYE;
-		pData[10] = T_WEB;
-		pData[11] = T_ROTATE_CW;
-		pData[12] = T_WAIT;
-		pData[13] = T_MONKEY_EAR;
-		pData[14] = T_MOVE_HORIZONTAL;
-		pData[15] = T_BAT_WING;
-		pData[16] = T_RAT_TAIL;
-
-		pData[17] = T_EYE;
-		pData[18] = T_WAIT;
-		pData[19] = T_ROTATE_CW;
-		pData[20] = T_BONE;
-		pData[21] = T_MONKEY_EAR;
-		pData[22] = T_MOVE_HORIZONTAL;
-		pData[23] = T_WAIT;
-		pData[24] = T_RAT_TAIL;
-
-		pData[25] = T_EYE;
-		pData[26] = T_WEB;
-		pData[27] = T_ROTATE_CW;
-		pData[28] = T_WAIT;
-		pData[29] = T_MONKEY_EAR;
-		pData[30] = T_MOVE_HORIZONTAL;
-		pData[31] = T_BAT_WING;
-			
-        rv = recipeScroll_load(pGlobal->pRecipe, pData, sizeof(pData) / sizeof(int), -8);
-        ASSERT(rv == GFMRV_OK, rv);
-    } while(0);
+    rv = recipeScroll_load(pGlobal->pRecipe, pRecipeItems, recipeLen, -8);
+    ASSERT(rv == GFMRV_OK, rv);
 
     pGame->pState = pState;
     rv = GFMRV_OK;
@@ -240,70 +239,40 @@ __ret:
 }
 
 /**
- * Update everything
+ * Simulate a single (fixed) step of everything that affects the gameplay
  */
 gfmRV gs_update() {
     /** GFraMe return value */
     gfmRV rv;
-    /** The new state */
-    gamestate *pState;
-    /** Count how many particles were spawned */
-    int i;
 
-    /* Check that the state is correct and retrieve it*/
+    /* Check that the state is correct */
     ASSERT(pGame->curState == ST_GAME, GFMRV_INTERNAL_ERROR);
     ASSERT(pGame->pState != 0, GFMRV_INTERNAL_ERROR);
-    pState = (gamestate*)pGame->pState;
 
     /* Update the gesture recognizer */
+    profiler_begin(PROF_GESTURE);
     rv = gesture_update(pGlobal->pGesture);
     ASSERT(rv == GFMRV_OK, rv);
-
-    /* Initialize the quadtree */
-    rv = gfmQuadtree_initRoot(pGlobal->pQt, QT_X, QT_Y, QT_WIDTH, QT_HEIGHT,
-            QT_MAX_DEPTH, QT_MAX_NODES);
-    ASSERT(rv == GFMRV_OK, rv);
+    profiler_end(PROF_GESTURE);
 
     /* Update the scroller */
+    profiler_begin(PROF_SCROLL);
     rv = recipeScroll_update(pGlobal->pRecipe);
     ASSERT(rv == GFMRV_OK, rv);
-    /* Update the tilemap (e.g., if it's animated) */
-    rv = gfmTilemap_update(pState->pBackground, pGame->pCtx);
-    ASSERT(rv == GFMRV_OK, rv);
+    profiler_end(PROF_SCROLL);
     /* Update all objects */
-    gfmGenArr_callAll(pState->pObjects, object_update);
-
-    /* Update the cauldron */
-    rv = cauldron_update(pGlobal->pCauldron);
+    profiler_begin(PROF_OBJECTS);
+    rv = itemStore_update(pGlobal->pItems);
     ASSERT(rv == GFMRV_OK, rv);
-    i = 0;
-    while (i < 5) {
-        gfmSprite *pSpr;
+    profiler_end(PROF_OBJECTS);
 
-        /* Spawn some new particles */
-        rv = gfmGroup_setDeathOnTime(pState->pFire,
-                800 + (pState->curFire % 16 + 1) * 25 /* time to live */);
-        ASSERT(rv == GFMRV_OK, rv);
-        rv = gfmGroup_recycle(&pSpr, pState->pFire);
-        ASSERT(rv == GFMRV_OK, rv);
-        rv = gfmGroup_setPosition(pState->pFire, 79 /* x */, 104 /* y */);
-        ASSERT(rv == GFMRV_OK, rv);
-        rv = gfmGroup_setFrame(pState->pFire, 
-                12 + ((19 * pState->curFire) % 4) /* tile */);
-        ASSERT(rv == GFMRV_OK, rv);
-        rv = gfmGroup_setVelocity(pState->pFire,
-                -10 + (1 + pState->curFire % 23) /* vx */,
-                -2 - (pState->curFire % 7) /* vy */);
-        ASSERT(rv == GFMRV_OK, rv);
-
-        /* Update the "RNG" */
-        pState->curFire += 17;
-        pState->curFire %= 32;
-
-        i++;
-    }
-    rv = gfmGroup_update(pState->pFire, pGame->pCtx);
+    /* Collide everything that moved */
+    profiler_begin(PROF_COLLISION);
+    rv = collision_run();
     ASSERT(rv == GFMRV_OK, rv);
+    rv = itemStore_settle(pGlobal->pItems);
+    ASSERT(rv == GFMRV_OK, rv);
+    profiler_end(PROF_COLLISION);
 
     /* Everything was updated, check if the user failed */
     rv = recipeScroll_didFail(pGlobal->pRecipe);
@@ -318,7 +287,66 @@ __ret:
 }
 
 /**
- * Draws everything
+ * Update everything that's purely cosmetic (i.e., the framework's animations
+ * and the fire), once per rendered frame
+ */
+gfmRV gs_animate() {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The new state */
+    gamestate *pState;
+    /** Time elapsed since the previous frame, in miliseconds */
+    int elapsed;
+    /** The fire's emitter, scaled to the current level of detail */
+    emitter fire;
+
+    /* Check that the state is correct and retrieve it*/
+    ASSERT(pGame->curState == ST_GAME, GFMRV_INTERNAL_ERROR);
+    ASSERT(pGame->pState != 0, GFMRV_INTERNAL_ERROR);
+    pState = (gamestate*)pGame->pState;
+
+    /* Update the tilemap (e.g., if it's animated) */
+    profiler_begin(PROF_TILEMAP);
+    rv = gfmTilemap_update(pState->pBackground, pGame->pCtx);
+    ASSERT(rv == GFMRV_OK, rv);
+    profiler_end(PROF_TILEMAP);
+
+    /* Update the cauldron */
+    profiler_begin(PROF_CAULDRON);
+    rv = cauldron_update(pGlobal->pCauldron);
+    ASSERT(rv == GFMRV_OK, rv);
+    profiler_end(PROF_CAULDRON);
+    profiler_begin(PROF_FIRE);
+    /* Spawn fewer (and shorter lived) particles if running over budget */
+    fire = fireEmitter;
+    fire.ttlMin = lod_scale(fire.ttlMin, LOD_TTL);
+    fire.ttlMax = lod_scale(fire.ttlMax, LOD_TTL);
+    rv = particles_setLimit(pGlobal->pParticles,
+            lod_scale(MAX_PARTICLES, LOD_POOL));
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = particles_emit(pGlobal->pParticles, &fire,
+            lod_scale(FIRE_PER_FRAME, LOD_SPAWN));
+    ASSERT(rv == GFMRV_OK, rv);
+    if (pGame->flags & GAME_HEADLESS) {
+        /* There's no frame timer without a window (e.g., when rendering in
+         * software), so follow the virtual clock (one step per frame) */
+        elapsed = pGame->elapsed;
+    }
+    else {
+        rv = gfm_getElapsedTime(&elapsed, pGame->pCtx);
+        ASSERT(rv == GFMRV_OK, rv);
+    }
+    rv = particles_update(pGlobal->pParticles, elapsed);
+    ASSERT(rv == GFMRV_OK, rv);
+    profiler_end(PROF_FIRE);
+
+    rv = GFMRV_OK;
+__ret:
+    return GFMRV_OK;
+}
+
+/**
+ * Records everything that should be drawn into the draw list
  */
 gfmRV gs_draw() {
     /** GFraMe return value */
@@ -332,23 +360,33 @@ gfmRV gs_draw() {
     pState = (gamestate*)pGame->pState;
 
     /* Draw the background */
-    rv = gfmTilemap_draw(pState->pBackground, pGame->pCtx);
+    drawlist_setLayer(pGlobal->pDrawList, DRAW_LAYER_BACKGROUND);
+    rv = staticmap_draw(pState->pBgCache);
     ASSERT(rv == GFMRV_OK, rv);
     /* Draw the scroll */
     rv = recipeScroll_draw(pGlobal->pRecipe);
     ASSERT(rv == GFMRV_OK, rv);
 
     /* Draw the cauldron */
+    drawlist_setLayer(pGlobal->pDrawList, DRAW_LAYER_CAULDRON);
     rv = cauldron_draw(pGlobal->pCauldron);
     ASSERT(rv == GFMRV_OK, rv);
-    rv = gfmGroup_draw(pState->pFire, pGame->pCtx);
+    drawlist_setLayer(pGlobal->pDrawList, DRAW_LAYER_FIRE);
+    rv = particles_draw(pGlobal->pParticles, SSET_2x2);
     ASSERT(rv == GFMRV_OK, rv);
 
     /* Draw all objects */
-    gfmGenArr_callAll(pState->pObjects, object_draw);
+    drawlist_setLayer(pGlobal->pDrawList, DRAW_LAYER_ITEMS);
+    rv = itemStore_draw(pGlobal->pItems);
+    ASSERT(rv == GFMRV_OK, rv);
 
     /* Draw info about the gesture */
+    drawlist_setLayer(pGlobal->pDrawList, DRAW_LAYER_DEBUG);
     gesture_draw(pGlobal->pGesture);
+    lod_draw();
+    if (pGame->flags & DBG_RENDERBP) {
+        broadphase_draw(pGlobal->pBroadPhase);
+    }
 
     rv = GFMRV_OK;
 __ret:
@@ -1,8 +1,13 @@
 /**
  * @file src/gesture.c
  *
- * Recognizes gestures from the mouse
+ * Recognizes gestures from the mouse. The pointer's path since the last reset
+ * (up to GESTURE_MAX_AGE old, measured with the samples' timestamps) is kept
+ * as a stroke, which is classified against the templates of every known
+ * gesture (so new ones only need a new template)
  */
+#include <base/arena.h>
+#include <base/drawlist.h>
 #include <base/game_const.h>
 #include <base/game_ctx.h>
 
@@ -11,54 +16,78 @@
 #include <GFraMe/gfmInput.h>
 
 #include <ggj16/gesture.h>
+#include <ggj16/templates.h>
 #include <ggj16/type.h>
 
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define PI           3.1415926
-#define GESTURE_MOVE 15
+/** Most points kept on a stroke (once full, every other one is dropped) */
+#define GESTURE_MAX_POINTS TEMPLATES_MAX_STROKE
+/** For how long a point is kept on the stroke, in miliseconds (so anything
+ * done well before the gesture doesn't distort its shape) */
+#define GESTURE_MAX_AGE 1500
 
 #if defined(DEBUG) && !(defined(__WIN32) || defined(__WIN32__))
 #  include <signal.h>
 #endif
 
-enum enMoveState {
-    MOVE_LEFT  = 0x0001,
-    MOVE_RIGHT = 0x0002,
-    MOVE_UP    = 0x0004,
-    MOVE_DOWN  = 0x0008
+/** Paths of the known gestures (in screen coordinates, so y grows downward) */
+static const short pCircleCCW[] = {
+    100, 0, 87, -50, 50, -87, 0, -100, -50, -87, -87, -50, -100, 0,
+    -87, 50, -50, 87, 0, 100, 50, 87, 87, 50, 100, 0
+};
+static const short pCircleCW[] = {
+    100, 0, 87, 50, 50, 87, 0, 100, -50, 87, -87, 50, -100, 0,
+    -87, -50, -50, -87, 0, -100, 50, -87, 87, -50, 100, 0
+};
+static const short pShakeDown[] = { 0, 0, 0, 100, 0, 0 };
+static const short pShakeUp[] = { 0, 0, 0, -100, 0, 0 };
+static const short pShakeRight[] = { 0, 0, 100, 0, 0, 0 };
+static const short pShakeLeft[] = { 0, 0, -100, 0, 0, 0 };
+
+/** Number of points in a path */
+#define GESTURE_LEN(pPath) ((int)(sizeof(pPath) / (2 * sizeof(short))))
+
+/** A known gesture */
+struct stGestureTemplate {
+    /** Item it's recognized as */
+    itemType type;
+    /** Its path, as interleaved positions */
+    const short *pPath;
+    /** Number of points in the path */
+    int len;
+    /** TEMPLATES_ANY_ROTATION, or 0 */
+    int flags;
+};
+
+/** Every known gesture (NOTE: 'horizontal' is moving up and down, and vice
+ * versa) */
+static const struct stGestureTemplate pGestureList[] = {
+    { T_ROTATE_CCW, pCircleCCW, GESTURE_LEN(pCircleCCW),
+            TEMPLATES_ANY_ROTATION },
+    { T_ROTATE_CW, pCircleCW, GESTURE_LEN(pCircleCW),
+            TEMPLATES_ANY_ROTATION },
+    { T_MOVE_HORIZONTAL, pShakeDown, GESTURE_LEN(pShakeDown), 0 },
+    { T_MOVE_HORIZONTAL, pShakeUp, GESTURE_LEN(pShakeUp), 0 },
+    { T_MOVE_VERTICAL, pShakeRight, GESTURE_LEN(pShakeRight), 0 },
+    { T_MOVE_VERTICAL, pShakeLeft, GESTURE_LEN(pShakeLeft), 0 }
 };
-typedef enum enMoveState moveState;
 
 struct stGesture {
-    /** Last angle */
-    double lastAng;
-    /** Delta angle */
-    double dAng;
-    /** Delta horizontal movement */
-    int dX;
-    /** Delta vertical movement */
-    int dY;
-    /** Last horizontal position in the screen */
-    int lastX;
-    /** Last vertical position in the screen */
-    int lastY;
-    /** Flag that signals when the struct has been just reset, so it's properly
-     * initialized */
-    int justReset;
-    /** Allow a few frames (urg) of error when spinning */
-    int angErr;
-    /** Allow a few frames (urg) of error when moving */
-    int xErr;
-    int yErr;
-    /** Check the movement state */
-    moveState move;
+    /** Templates of every known gesture */
+    templateSet *pTemplates;
+    /** Pointer's path since the last reset, as interleaved positions */
+    short pStroke[GESTURE_MAX_POINTS * 2];
+    /** When each of the stroke's points was sampled, in miliseconds */
+    unsigned int pTimes[GESTURE_MAX_POINTS];
+    /** Number of points on the stroke */
+    int numPoints;
 };
 
 /**
- * Release the struct
+ * Release the struct (it belongs to the level arena, so this only clears the
+ * reference)
  *
  * @param  [ in]ppCtx The recognizer
  */
@@ -67,12 +96,15 @@ void gesture_free(gesture **ppCtx) {
         return;
     }
 
-    free(*ppCtx);
+    if (*ppCtx) {
+        templates_free(&((*ppCtx)->pTemplates));
+    }
     *ppCtx = 0;
 }
 
 /**
- * Alloc and initialize a new recognizer
+ * Alloc (from the level arena) and initialize a new recognizer, normalizing
+ * the templates of every known gesture
  *
  * @param  [out]ppCtx The alloc'ed recognizer
  * @return            GFraMe return value
@@ -82,12 +114,25 @@ gfmRV gesture_getNew(gesture **ppCtx) {
     gesture *pCtx;
     /** GFraMe return value */
     gfmRV rv;
+    /** Iterate through the known gestures */
+    int i;
 
     /* Sanitize arguments */
     ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
 
-    pCtx = (gesture*)malloc(sizeof(gesture));
-    ASSERT(pCtx, GFMRV_ALLOC_FAILED);
+    rv = arena_alloc((void**)&pCtx, &(pGlobal->levelArena), sizeof(gesture));
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = templates_getNew(&(pCtx->pTemplates));
+    ASSERT(rv == GFMRV_OK, rv);
+
+    i = 0;
+    while (i < (int)(sizeof(pGestureList) / sizeof(pGestureList[0]))) {
+        rv = templates_add(pCtx->pTemplates, pGestureList[i].type,
+                pGestureList[i].pPath, pGestureList[i].len,
+                pGestureList[i].flags);
+        ASSERT(rv == GFMRV_OK, rv);
+        i++;
+    }
     gesture_reset(pCtx);
 
     *ppCtx = pCtx;
@@ -102,173 +147,71 @@ __ret:
  * @param  [ in]pCtx The recognizer
  */
 void gesture_reset(gesture *pCtx) {
-    memset(pCtx, 0x0, sizeof(gesture));
-    pCtx->justReset = 1;
+    pCtx->numPoints = 0;
 }
 
 /**
- * Update the recognizer
+ * Update the recognizer, appending every pointer sample since the previous
+ * step to the stroke (so it has the whole path, regardless of the frame rate)
+ * and dropping the points older than GESTURE_MAX_AGE
  *
  * @param  [ in]pCtx The recognizer
  * @return           GFraMe return value
  */
 gfmRV gesture_update(gesture *pCtx) {
-    /** Angle moved since the last frame (range: [0, 2*pi] )*/
-    double curAng;
-    /** Framework's input context */
-    gfmInput *pInput;
     /** GFraMe return value */
     gfmRV rv;
-    /** Distance of the mouse from the center of the screen */
-    int distCX, distCY;
-    /** Current mouse position on the screen */
-    int mouseX, mouseY;
-
-    /* Retrieve the current mouse position */
-    rv = gfm_getInput(&pInput, pGame->pCtx);
-    ASSERT(rv == GFMRV_OK, rv);
-    rv = gfmInput_getPointerPosition(&mouseX, &mouseY, pInput);
-    ASSERT(rv == GFMRV_OK, rv);
-
-    /* Calculate the current angle (NOTE: The vertical distance must be
-     * inverted since the origin is on the top left corner) */
-    distCX = mouseX - V_CENTER_X;
-    distCY = -(mouseY - V_CENTER_Y);
-    /* Avoid corner cases */
-    if (distCX == 0) {
-        if (distCY > 0) {
-            curAng = PI / 2;
-        }
-        else {
-            curAng = 3 * PI / 2;
-        }
-    }
-    else if (distCY == 0) {
-        if (distCX > 0) {
-            curAng = 0.0;
-        }
-        else {
-            curAng = PI;
-        }
-    }
-    else {
-        /* Get the angle in [0, PI/2] */
-        curAng = atan(((double)distCX) / (double)distCY);
-        if (curAng < 0.0) {
-            curAng = -curAng;
-        }
-
-        /* Convert it to [0, 2*PI] */
-        if (distCX >= 0 && distCY >= 0) {
-            /* Q1 [0, PI/2) */
-            curAng = PI / 2.0 - curAng;
-        }
-        else if (distCX < 0 && distCY >= 0) {
-            /* Q2 [PI/2, PI) */
-            curAng = curAng + PI / 2.0;
-        }
-        else if (distCX < 0 && distCY < 0) {
-            /* Q3 [PI, 3*PI/2) */
-            curAng = 3 * PI / 2.0 - curAng;
-        }
-        else if (distCX >= 0 && distCY < 0) {
-            /* Q4 [3*PI/2, 2*PI) */
-            curAng = curAng + 3 * PI / 2.0;
-        }
-    }
+    /** Time of the newest point */
+    unsigned int now;
+    /** Iterate through the samples (and the expired points) */
+    int i;
 
-    /** Only update the state if we know the previous state */
-    if (!pCtx->justReset) {
-        double deltaAng;
-        int dX, dY;
-
-        /* Update the movement state */
-        dX = mouseX - pCtx->lastX;
-        dY = mouseY - pCtx->lastY;
-        if (dX != 0) {
-            /* Few frames of leeway */
-            if ((pCtx->dX >= 0 && dX < 0) || (pCtx->dX <= 0 && dX > 0)) {
-                pCtx->xErr++;
-                if (pCtx->xErr > 3) {
-                    pCtx->dX = 0;
-                }
-            }
-            else {
-                pCtx->xErr = 0;
-            }
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
 
-            /* Update movement */
-            pCtx->dX += dX;
-            if (pCtx->dX > GESTURE_MOVE) {
-                pCtx->move |= MOVE_RIGHT;
-            }
-            else if (pCtx->dX < -GESTURE_MOVE) {
-                pCtx->move |= MOVE_LEFT;
+    i = 0;
+    while (i < pGame->numSamples) {
+        if (pCtx->numPoints == GESTURE_MAX_POINTS) {
+            /** Iterate through the stroke */
+            int j;
+
+            /* Drop every other point (as the stroke is resampled, only its
+             * shape matters) */
+            j = 0;
+            while (j < GESTURE_MAX_POINTS / 2) {
+                pCtx->pStroke[j * 2] = pCtx->pStroke[j * 4];
+                pCtx->pStroke[j * 2 + 1] = pCtx->pStroke[j * 4 + 1];
+                pCtx->pTimes[j] = pCtx->pTimes[j * 2];
+                j++;
             }
+            pCtx->numPoints = GESTURE_MAX_POINTS / 2;
         }
-        if (dY != 0) {
-            /* Few frames of leeway */
-            if ((pCtx->dY >= 0 && dY < 0) || (pCtx->dY <= 0 && dY > 0)) {
-                pCtx->yErr++;
-                if (pCtx->yErr > 3) {
-                    pCtx->dY = 0;
-                }
-            }
-            else {
-                pCtx->yErr = 0;
-            }
 
-            /* Update movemente */
-            pCtx->dY += dY;
-            if (pCtx->dY > GESTURE_MOVE) {
-                pCtx->move |= MOVE_DOWN;
-            }
-            else if (pCtx->dY < -GESTURE_MOVE) {
-                pCtx->move |= MOVE_UP;
-            }
-        }
+        pCtx->pStroke[pCtx->numPoints * 2] = (short)pGame->pSamples[i].x;
+        pCtx->pStroke[pCtx->numPoints * 2 + 1] = (short)pGame->pSamples[i].y;
+        pCtx->pTimes[pCtx->numPoints] = pGame->pSamples[i].time;
+        pCtx->numPoints++;
+        i++;
+    }
 
-        /* Update the angular state */
-        deltaAng = curAng - pCtx->lastAng;
-        if ((deltaAng >= 0.0 && pCtx->dAng >= 0.0)) {
-            pCtx->dAng += deltaAng;
-            pCtx->angErr = 0;
-        }
-        else if (curAng < PI / 2 &&
-                pCtx->lastAng > 3 * PI / 2 &&
-                2 * PI + deltaAng >= 0.0 &&
-                pCtx->dAng >= 0.0) {
-            /* Just went over 2*PI (corner case) */
-            pCtx->dAng += 2 * PI + deltaAng;
-            pCtx->angErr = 0;
-        }
-        else if (deltaAng <= 0.0 && pCtx->dAng <= 0.0) {
-            pCtx->dAng += deltaAng;
-            pCtx->angErr = 0;
-        }
-        else if (curAng > 3 * PI / 2 &&
-                pCtx->lastAng < PI / 2 &&
-                deltaAng - 2 * PI <= 0.0 &&
-                pCtx->dAng <= 0.0) {
-            /* Just went over 0 (corner case) */
-            pCtx->dAng += deltaAng - 2 * PI;
-            pCtx->angErr = 0;
-        }
-        else if (deltaAng != 0.0) {
-            /* Mouse on the opposite direction, reset */
-            pCtx->angErr++;
-            if (pCtx->angErr > 3) {
-                pCtx->dAng = 0.0;
-                pCtx->angErr = 0;
-            }
-        }
+    if (pCtx->numPoints == 0) {
+        rv = GFMRV_OK;
+        goto __ret;
     }
 
-    /* Store the current state to compare on the next frame */
-    pCtx->lastX = mouseX;
-    pCtx->lastY = mouseY;
-    pCtx->lastAng = curAng;
-    pCtx->justReset = 0;
+    /* Expire the old points (the timestamps are unsigned, so they may wrap
+     * around) */
+    now = pCtx->pTimes[pCtx->numPoints - 1];
+    i = 0;
+    while (i < pCtx->numPoints && now - pCtx->pTimes[i] > GESTURE_MAX_AGE) {
+        i++;
+    }
+    if (i > 0) {
+        memmove(pCtx->pStroke, pCtx->pStroke + i * 2,
+                sizeof(short) * 2 * (pCtx->numPoints - i));
+        memmove(pCtx->pTimes, pCtx->pTimes + i,
+                sizeof(unsigned int) * (pCtx->numPoints - i));
+        pCtx->numPoints -= i;
+    }
 
     rv = GFMRV_OK;
 __ret:
@@ -282,74 +225,44 @@ __ret:
  */
 void gesture_draw(gesture *pGesture) {
 #if defined(DEBUG)
-    /* Debug dX */
-    gfm_drawTile(pGame->pCtx, pGfx->pSset8x8, 0/*x*/, 120-24/*y*/, 'Y' - '!',
-            0/*flip*/);
-    gfm_drawNumber(pGame->pCtx, pGfx->pSset8x8, 8/*x*/, 120-24/*y*/,
-            (int)pGesture->dY, 3/*numDigits*/, 0/*first ascii tile*/);
-
-    /* Debug dY */
-    gfm_drawTile(pGame->pCtx, pGfx->pSset8x8, 0/*x*/, 120-16/*y*/, 'X' - '!',
-            0/*flip*/);
-    gfm_drawNumber(pGame->pCtx, pGfx->pSset8x8, 8/*x*/, 120-16/*y*/,
-            (int)pGesture->dX, 3/*numDigits*/, 0/*first ascii tile*/);
-
-    /* Debug dAng */
-    gfm_drawTile(pGame->pCtx, pGfx->pSset8x8, 0/*x*/, 120-8/*y*/, 'A' - '!',
-            0/*flip*/);
-    gfm_drawNumber(pGame->pCtx, pGfx->pSset8x8, 8/*x*/, 120-8/*y*/,
-            (int)pGesture->dAng, 3/*numDigits*/, 0/*first ascii tile*/);
-    gfm_drawNumber(pGame->pCtx, pGfx->pSset8x8, 40/*x*/, 120-8/*y*/,
-            (int)(pGesture->dAng * 100) - ((int)pGesture->dAng) * 100,
-            3/*numDigits*/, 0/*first ascii tile*/);
+    /** The current gestures */
+    itemType pItems[4];
+
+    /* Debug the stroke's length */
+    drawlist_pushTile(pGlobal->pDrawList, SSET_8x8, 0/*x*/, 120-16/*y*/,
+            'P' - '!', 0/*isFlipped*/);
+    drawlist_pushNumber(pGlobal->pDrawList, SSET_8x8, 8/*x*/, 120-16/*y*/,
+            pGesture->numPoints, 3/*numDigits*/);
+
+    /* Debug the best match */
+    gesture_getCurrentGesture(pItems, pGesture);
+    drawlist_pushTile(pGlobal->pDrawList, SSET_8x8, 0/*x*/, 120-8/*y*/,
+            'G' - '!', 0/*isFlipped*/);
+    drawlist_pushNumber(pGlobal->pDrawList, SSET_8x8, 8/*x*/, 120-8/*y*/,
+            (int)pItems[0], 3/*numDigits*/);
 #endif
 }
 
 /**
  * Retrieve the current gesture (if any)
  *
- * @param  [out]pItem The current gestures (must have 4 positions)
+ * @param  [out]pItem The current gestures, from the best match (must have 4
+ *                    positions; T_NONE on the unused ones)
  * @param  [ in]pCtx  The recognizer
  * @return            GFraMe return value
  */
 gfmRV gesture_getCurrentGesture(itemType *pItem, gesture *pCtx) {
     /** GFraMe return value */
     gfmRV rv;
-    /** Iterate through items */
-    int i;
 
     /* Sanitize arguments */
     ASSERT(pItem, GFMRV_ARGUMENTS_BAD);
     ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
 
-    /* Set all available actions */
-    i = 0;
-    while (i < 4) {
-        pItem[i] = T_NONE;
-        switch (i) {
-            case 0: {
-                if (pCtx->dAng > 2 * PI) {
-                    pItem[i] = T_ROTATE_CCW;
-                }
-            } break;
-            case 1: {
-                if (pCtx->dAng < -2 * PI) {
-                    pItem[i] = T_ROTATE_CW;
-                }
-            } break;
-            case 2: {
-                if ((pCtx->move & MOVE_UP) && (pCtx->move & MOVE_DOWN)) {
-                    pItem[i] = T_MOVE_HORIZONTAL;
-                }
-            } break;
-            case 3: {
-                if ((pCtx->move & MOVE_LEFT) && (pCtx->move & MOVE_RIGHT)) {
-                    pItem[i] = T_MOVE_VERTICAL;
-                }
-            } break;
-        }
-        i++;
-    }
+    /* Retrieve every gesture that matches the stroke */
+    rv = templates_match(pItem, 4, pCtx->pTemplates, pCtx->pStroke,
+            pCtx->numPoints);
+    ASSERT(rv == GFMRV_OK, rv);
 
     rv = GFMRV_OK;
 __ret:
@@ -0,0 +1,725 @@
+/**
+ * @file src/gestureBench.c
+ *
+ * Offline benchmark for the gesture recognizer. A corpus of labeled pointer
+ * traces is fed through gesture_update/gesture_getCurrentGesture exactly as
+ * the game would (every sample since the previous step, on fixed steps of
+ * CONF_UPS per second), and the following is reported:
+ *   - the confusion matrix of what was recognized by the end of each trace;
+ *   - the detection latency, in steps after the gesture was completed, until
+ *     its label was first the best match;
+ *   - the throughput, in samples processed (and classified, every step) per
+ *     second
+ *
+ * Traces are loaded from corpus files, one trace per 'trace' line, followed by
+ * its samples:
+ *
+ *   # comment
+ *   trace <cw|ccw|horizontal|vertical|none> <completed at, in ms>
+ *   <time, in ms> <x> <y>
+ *   ...
+ *
+ * If no file is given, a corpus is synthesized from the RNG_BOTS stream:
+ * circles and shakes (with random size, speed, sampling rate and noise), as
+ * well as lines, L-shapes, half circles, jitter and random walks as negatives.
+ * It may be written into a corpus file with --dump=F, to be edited or shared.
+ *
+ * Isn't linked against the framework (nor the rest of the game), so it runs
+ * wherever the GFraMe headers are installed (they're included for the return
+ * values and the game's context types): 'make bench' and then
+ *
+ *   ./bin/<OS>/gestureBench [--seed=N] [--traces=N] [--dump=F] [files...]
+ */
+#include <base/arena.h>
+#include <base/drawlist.h>
+#include <base/game_const.h>
+#include <base/game_ctx.h>
+#include <base/profiler.h>
+#include <base/rng.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+#include <ggj16/gesture.h>
+#include <ggj16/type.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Check if an argument starts with a given (static) option */
+#define IS_OPTION(arg, opt) (strncmp(arg, opt, sizeof(opt) - 1) == 0)
+/** Retrieve the value of an option on the format '--opt=value' */
+#define GET_VALUE(arg, opt) (arg + sizeof(opt) - 1)
+
+/** Most traces on the corpus */
+#define BENCH_MAX_TRACES  8192
+/** Most samples on the corpus (summed over every trace) */
+#define BENCH_MAX_SAMPLES (1024 * 1024)
+/** Default number of synthesized traces for each label */
+#define BENCH_TRACES      200
+/** Longest line on a corpus file */
+#define BENCH_LINE        256
+/** Amplitude of the noise added to synthesized samples, in pixels */
+#define BENCH_NOISE       1.5f
+/** Duration of a step, in milliseconds */
+#define BENCH_STEP_MS     (1000.0 / CONF_UPS)
+
+/** Every label, in the order they are reported */
+enum enBenchLabel {
+    BL_CW = 0,
+    BL_CCW,
+    BL_HORIZONTAL,
+    BL_VERTICAL,
+    BL_NONE,
+    BL_MAX
+};
+typedef enum enBenchLabel benchLabel;
+
+/** Name of each label (on the corpus files and on the report) */
+static const char *pLabelNames[BL_MAX] = {
+    "cw", "ccw", "horizontal", "vertical", "none"
+};
+
+/** Item recognized for each label */
+static const itemType pLabelTypes[BL_MAX] = {
+    T_ROTATE_CW, T_ROTATE_CCW, T_MOVE_HORIZONTAL, T_MOVE_VERTICAL, T_NONE
+};
+
+/** A labeled pointer trace */
+struct stBenchTrace {
+    /** Index of the trace's first sample */
+    int first;
+    /** Number of samples on the trace */
+    int num;
+    /** Time (since the trace's first sample, in milliseconds) when the
+     * gesture was completed (e.g., after the first full turn) */
+    unsigned int completed;
+    /** The expected gesture */
+    benchLabel label;
+};
+typedef struct stBenchTrace benchTrace;
+
+/** Store data related to game (only the pointer samples are used) */
+gameCtx *pGame = 0;
+
+/** Store game-related variables that should be globally accessible (only
+ * the level arena is used) */
+globalCtx *pGlobal = 0;
+
+/** Every trace on the corpus */
+static benchTrace pTraces[BENCH_MAX_TRACES];
+/** Number of traces */
+static int numTraces = 0;
+/** Every trace's samples, one trace after the other */
+static pointerSample pSamples[BENCH_MAX_SAMPLES];
+/** Number of samples */
+static int numSamples = 0;
+
+/**
+ * Nothing is ever rendered by the benchmark (this is only called by the
+ * recognizer's debug draw)
+ */
+gfmRV drawlist_pushTile(drawList *pCtx, spritesetId sset, int x, int y,
+        int tile, int isFlipped) {
+    return GFMRV_OK;
+}
+
+/**
+ * Nothing is ever rendered by the benchmark (this is only called by the
+ * recognizer's debug draw)
+ */
+gfmRV drawlist_pushNumber(drawList *pCtx, spritesetId sset, int x, int y,
+        int num, int numDigits) {
+    return GFMRV_OK;
+}
+
+/**
+ * Start a new trace on the corpus
+ *
+ * @param  [ in]label     The expected gesture
+ * @param  [ in]completed When the gesture was completed (in milliseconds)
+ * @return                GFraMe return value
+ */
+static gfmRV bench_beginTrace(benchLabel label, unsigned int completed) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(numTraces < BENCH_MAX_TRACES, GFMRV_INTERNAL_ERROR);
+
+    pTraces[numTraces].first = numSamples;
+    pTraces[numTraces].num = 0;
+    pTraces[numTraces].completed = completed;
+    pTraces[numTraces].label = label;
+    numTraces++;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Append a sample to the last trace
+ *
+ * @param  [ in]time The sample's time (in milliseconds)
+ * @param  [ in]x    The pointer's horizontal position
+ * @param  [ in]y    The pointer's vertical position
+ * @return           GFraMe return value
+ */
+static gfmRV bench_addSample(unsigned int time, int x, int y) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(numTraces > 0, GFMRV_FUNCTION_FAILED);
+    ASSERT(numSamples < BENCH_MAX_SAMPLES, GFMRV_INTERNAL_ERROR);
+
+    pSamples[numSamples].time = time;
+    pSamples[numSamples].x = x;
+    pSamples[numSamples].y = y;
+    numSamples++;
+    pTraces[numTraces - 1].num++;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Load every trace on a corpus file
+ *
+ * @param  [ in]pFilename The corpus file
+ * @return                GFraMe return value
+ */
+static gfmRV bench_load(char *pFilename) {
+    /** The current line */
+    char pLine[BENCH_LINE];
+    /** The label's name */
+    char pName[BENCH_LINE];
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The corpus file */
+    FILE *pFile;
+    /** Number of the current line (for reporting errors) */
+    int line;
+
+    pFile = fopen(pFilename, "rt");
+    ASSERT(pFile, GFMRV_COULDNT_OPEN_FILE);
+
+    line = 0;
+    while (fgets(pLine, sizeof(pLine), pFile)) {
+        /** The sample's time (or when the gesture was completed) */
+        unsigned int time;
+        /** The sample's position */
+        int x, y;
+
+        line++;
+        if (pLine[0] == '#' || pLine[0] == '\n' || pLine[0] == '\r') {
+            continue;
+        }
+        else if (sscanf(pLine, "trace %255s %u", pName, &time) == 2) {
+            /** The trace's label */
+            int label;
+
+            label = 0;
+            while (label < BL_MAX && strcmp(pName, pLabelNames[label]) != 0) {
+                label++;
+            }
+            if (label == BL_MAX) {
+                fprintf(stderr, "%s:%i: unknown label '%s'\n", pFilename, line,
+                        pName);
+                rv = GFMRV_READ_ERROR;
+                goto __ret;
+            }
+
+            rv = bench_beginTrace((benchLabel)label, time);
+            ASSERT(rv == GFMRV_OK, rv);
+        }
+        else if (sscanf(pLine, "%u %i %i", &time, &x, &y) == 3) {
+            rv = bench_addSample(time, x, y);
+            ASSERT(rv == GFMRV_OK, rv);
+        }
+        else {
+            fprintf(stderr, "%s:%i: malformed line\n", pFilename, line);
+            rv = GFMRV_READ_ERROR;
+            goto __ret;
+        }
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    if (pFile) {
+        fclose(pFile);
+    }
+
+    return rv;
+}
+
+/**
+ * Write every trace into a corpus file
+ *
+ * @param  [ in]pFilename The corpus file
+ * @return                GFraMe return value
+ */
+static gfmRV bench_dump(char *pFilename) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The corpus file */
+    FILE *pFile;
+    /** Iterate through the traces and their samples */
+    int i, j;
+
+    pFile = fopen(pFilename, "wt");
+    ASSERT(pFile, GFMRV_COULDNT_OPEN_FILE);
+
+    fprintf(pFile, "# Synthesized gesture corpus\n");
+    i = 0;
+    while (i < numTraces) {
+        fprintf(pFile, "trace %s %u\n", pLabelNames[pTraces[i].label],
+                pTraces[i].completed);
+        j = pTraces[i].first;
+        while (j < pTraces[i].first + pTraces[i].num) {
+            fprintf(pFile, "%u %i %i\n", pSamples[j].time, pSamples[j].x,
+                    pSamples[j].y);
+            j++;
+        }
+        i++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    if (pFile) {
+        fclose(pFile);
+    }
+
+    return rv;
+}
+
+/**
+ * Retrieve a random number within [min, max)
+ *
+ * @param  [ in]pRng The generator
+ * @param  [ in]min  The range's start
+ * @param  [ in]max  The range's end
+ * @return           The number
+ */
+static float bench_random(rng *pRng, float min, float max) {
+    return min + (max - min) * rng_nextFloat(pRng);
+}
+
+/**
+ * Synthesize a single trace. Every shape is parametrized by its phase (where
+ * 1.0 is when the gesture was completed), and sampled at a random (but
+ * roughly constant) rate, as a mouse would be
+ *
+ * @param  [ in]pRng  The generator
+ * @param  [ in]label The expected gesture
+ * @return            GFraMe return value
+ */
+static gfmRV bench_synthesize(rng *pRng, benchLabel label) {
+    /** Center of the shape */
+    float cx, cy;
+    /** Size of the shape (radius or amplitude) and its aspect ratio */
+    float size, aspect;
+    /** Initial angle (or direction) of the shape */
+    float start;
+    /** How many times the gesture is repeated */
+    float count;
+    /** Duration of a single repetition and interval between samples (in ms) */
+    float period, interval;
+    /** Position of the random walk */
+    float wx, wy;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Time of the current sample (in ms) */
+    float time;
+    /** Kind of negative trace */
+    int kind;
+    /** Direction of the shape (clockwise or not, from which side...) */
+    int dir;
+
+    cx = bench_random(pRng, V_CENTER_X - 16, V_CENTER_X + 16);
+    cy = bench_random(pRng, V_CENTER_Y - 8, V_CENTER_Y + 8);
+    size = bench_random(pRng, 15.0f, 48.0f);
+    aspect = bench_random(pRng, 0.8f, 1.25f);
+    start = bench_random(pRng, 0.0f, 2.0f * M_PI);
+    count = bench_random(pRng, 1.1f, 3.0f);
+    period = bench_random(pRng, 300.0f, 1200.0f);
+    interval = bench_random(pRng, 4.0f, 16.0f);
+    kind = rng_range(pRng, 0, 4);
+    dir = (rng_range(pRng, 0, 1) == 0) ? 1 : -1;
+    wx = cx;
+    wy = cy;
+
+    rv = bench_beginTrace(label, (unsigned int)period);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    time = 0.0f;
+    while (time <= period * count) {
+        /** Phase of the gesture (1.0 for each repetition) */
+        float t;
+        /** Position of the sample */
+        float x, y;
+
+        t = time / period;
+        switch (label) {
+            case BL_CW:
+            case BL_CCW: {
+                /** Current angle (counter-clockwise, as in math) */
+                float angle;
+
+                /* The vertical axis points down, so clockwise on the screen
+                 * means a growing angle */
+                angle = start + 2.0f * M_PI * t;
+                if (label == BL_CCW) {
+                    angle = start - 2.0f * M_PI * t;
+                }
+                x = cx + size * aspect * cosf(angle);
+                y = cy + size * sinf(angle);
+            } break;
+            case BL_HORIZONTAL:
+            case BL_VERTICAL: {
+                /** Displacement along the shake (a triangle wave) */
+                float v;
+                /** Sideways drift */
+                float w;
+
+                t -= floorf(t);
+                v = dir * size * ((t < 0.5f) ? 2.0f * t : 2.0f - 2.0f * t);
+                w = (aspect - 1.0f) * 0.6f * v;
+                /* Shaking up and down moves the item horizontally (and vice
+                 * versa), as in the game */
+                if (label == BL_HORIZONTAL) {
+                    x = cx + w;
+                    y = cy + v;
+                }
+                else {
+                    x = cx + v;
+                    y = cy + w;
+                }
+            } break;
+            default: {
+                /* Negatives have a single repetition */
+                t /= count;
+                switch (kind) {
+                    case 0: {
+                        /* A straight line */
+                        x = cx + dir * size * (2.0f * t - 1.0f) * cosf(start);
+                        y = cy + size * (2.0f * t - 1.0f) * sinf(start);
+                    } break;
+                    case 1: {
+                        /* An L-shape */
+                        if (t < 0.5f) {
+                            x = cx - size + dir * 4.0f * size * t;
+                            y = cy - size;
+                        }
+                        else {
+                            x = cx - size + dir * 2.0f * size;
+                            y = cy - size + 4.0f * size * (t - 0.5f);
+                        }
+                    } break;
+                    case 2: {
+                        /* Half a circle */
+                        x = cx + size * cosf(start + dir * M_PI * t);
+                        y = cy + size * sinf(start + dir * M_PI * t);
+                    } break;
+                    case 3: {
+                        /* The pointer held (almost) still */
+                        x = cx + bench_random(pRng, -3.0f, 3.0f);
+                        y = cy + bench_random(pRng, -3.0f, 3.0f);
+                    } break;
+                    default: {
+                        /* A random walk */
+                        wx += bench_random(pRng, -4.0f, 4.0f);
+                        wy += bench_random(pRng, -4.0f, 4.0f);
+                        x = wx;
+                        y = wy;
+                    }
+                }
+            }
+        }
+
+        x += bench_random(pRng, -BENCH_NOISE, BENCH_NOISE);
+        y += bench_random(pRng, -BENCH_NOISE, BENCH_NOISE);
+        rv = bench_addSample((unsigned int)time, (int)floorf(x + 0.5f),
+                (int)floorf(y + 0.5f));
+        ASSERT(rv == GFMRV_OK, rv);
+
+        time += interval * bench_random(pRng, 0.8f, 1.2f);
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Run every trace through the recognizer and write the report
+ *
+ * @param  [ in]pGesture The recognizer
+ * @return               GFraMe return value
+ */
+static gfmRV bench_run(gesture *pGesture) {
+    /** Confusion matrix (expected label, recognized label) */
+    int pConfusion[BL_MAX][BL_MAX];
+    /** Total time spent updating and classifying (in ns) */
+    unsigned long long elapsed;
+    /** Slowest step (in ns) */
+    unsigned long long slowest;
+    /** Sum of the detection latencies (in steps) */
+    long long latencySum;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Number of steps simulated */
+    long long numSteps;
+    /** Number of detected gestures and of missed ones */
+    int detected, missed;
+    /** Earliest and latest detection (in steps) */
+    int earliest, latest;
+    /** Number of correctly recognized traces */
+    int correct;
+    /** Iterate through the traces and the labels */
+    int i, j;
+
+    memset(pConfusion, 0x0, sizeof(pConfusion));
+    elapsed = 0;
+    slowest = 0;
+    latencySum = 0;
+    numSteps = 0;
+    detected = 0;
+    missed = 0;
+    earliest = 0;
+    latest = 0;
+
+    i = 0;
+    while (i < numTraces) {
+        /** The current gestures */
+        itemType pItems[4];
+        /** The trace */
+        benchTrace *pTrace;
+        /** Time spent on the current step */
+        unsigned long long time;
+        /** Next sample to be fed */
+        int next;
+        /** Current step and the one when the gesture was first detected */
+        int step, detection;
+        /** The recognized label */
+        int label;
+
+        pTrace = &(pTraces[i]);
+        gesture_reset(pGesture);
+        pItems[0] = T_NONE;
+        next = 0;
+        step = 0;
+        detection = -1;
+        while (next < pTrace->num) {
+            /** End of the current step, since the trace's first sample */
+            double end;
+            /** The sample's time, since the trace's first sample */
+            unsigned int sampleTime;
+
+            /* Gather every sample until the end of the step (as the input
+             * would) */
+            end = (step + 1) * BENCH_STEP_MS;
+            pGame->numSamples = 0;
+            while (next < pTrace->num) {
+                /** The sample */
+                pointerSample *pSample;
+
+                pSample = &(pSamples[pTrace->first + next]);
+                sampleTime = pSample->time - pSamples[pTrace->first].time;
+                if (sampleTime >= end) {
+                    break;
+                }
+                if (pGame->numSamples < MAX_POINTER_SAMPLES) {
+                    pGame->numSamples++;
+                }
+                pGame->pSamples[pGame->numSamples - 1] = *pSample;
+                next++;
+            }
+
+            time = profiler_getTime();
+            rv = gesture_update(pGesture);
+            ASSERT(rv == GFMRV_OK, rv);
+            rv = gesture_getCurrentGesture(pItems, pGesture);
+            ASSERT(rv == GFMRV_OK, rv);
+            time = profiler_getTime() - time;
+
+            elapsed += time;
+            if (time > slowest) {
+                slowest = time;
+            }
+            if (detection < 0 && pTrace->label != BL_NONE &&
+                    pItems[0] == pLabelTypes[pTrace->label]) {
+                detection = step;
+            }
+            step++;
+        }
+        numSteps += step;
+
+        label = 0;
+        while (label < BL_NONE && pItems[0] != pLabelTypes[label]) {
+            label++;
+        }
+        pConfusion[pTrace->label][label]++;
+
+        if (pTrace->label != BL_NONE && detection >= 0) {
+            /** Steps since the gesture was completed */
+            int latency;
+
+            latency = detection -
+                    (int)(pTrace->completed / BENCH_STEP_MS);
+            if (detected == 0 || latency < earliest) {
+                earliest = latency;
+            }
+            if (detected == 0 || latency > latest) {
+                latest = latency;
+            }
+            latencySum += latency;
+            detected++;
+        }
+        else if (pTrace->label != BL_NONE) {
+            missed++;
+        }
+
+        i++;
+    }
+
+    /* Write the report */
+    printf("Gesture recognition benchmark: %i traces, %i samples, "
+            "%lli steps (%i per second)\n\n", numTraces, numSamples, numSteps,
+            CONF_UPS);
+
+    printf("Confusion matrix (rows: expected, columns: recognized)\n");
+    printf("%12s", "");
+    j = 0;
+    while (j < BL_MAX) {
+        printf(" %10s", pLabelNames[j]);
+        j++;
+    }
+    printf("\n");
+    correct = 0;
+    i = 0;
+    while (i < BL_MAX) {
+        printf("%12s", pLabelNames[i]);
+        j = 0;
+        while (j < BL_MAX) {
+            printf(" %10i", pConfusion[i][j]);
+            j++;
+        }
+        printf("\n");
+        correct += pConfusion[i][i];
+        i++;
+    }
+    if (numTraces > 0) {
+        printf("Accuracy: %.2f%%\n", 100.0 * correct / numTraces);
+    }
+    printf("\n");
+
+    printf("Detection latency (steps after the gesture was completed; "
+            "negative if earlier):\n");
+    if (detected > 0) {
+        printf("  mean %.2f, earliest %i, latest %i", (double)latencySum /
+                detected, earliest, latest);
+    }
+    printf("  (%i detected, %i never detected)\n\n", detected, missed);
+
+    printf("Throughput (updating and classifying on every step):\n");
+    if (elapsed > 0 && numSteps > 0) {
+        printf("  %.0f samples per second, %.2f us per step (slowest: "
+                "%.2f us)\n", numSamples * 1e9 / elapsed, elapsed / 1e3 /
+                numSteps, slowest / 1e3);
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+int main(int argc, char *argv[]) {
+    /** Memory of the level arena (from which the recognizer is alloc'ed) */
+    void *pMem;
+    /** File into which the synthesized corpus is written (if any) */
+    char *pDump;
+    /** The recognizer */
+    gesture *pGesture;
+    /** Session seed (for synthesizing the corpus) */
+    uint64_t seed;
+    /** Generator used for synthesizing the corpus */
+    rng botRng;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Number of synthesized traces for each label */
+    int num;
+    /** Iterate through the arguments and the traces */
+    int i;
+
+    pMem = 0;
+    pDump = 0;
+    pGesture = 0;
+    seed = 0;
+    num = BENCH_TRACES;
+
+    /* Alloc the contexts used by the recognizer */
+    pGame = (gameCtx*)malloc(sizeof(gameCtx));
+    ASSERT(pGame, GFMRV_ALLOC_FAILED);
+    memset(pGame, 0x0, sizeof(gameCtx));
+    pGlobal = (globalCtx*)malloc(sizeof(globalCtx));
+    ASSERT(pGlobal, GFMRV_ALLOC_FAILED);
+    memset(pGlobal, 0x0, sizeof(globalCtx));
+    pMem = malloc(LEVEL_ARENA_SIZE);
+    ASSERT(pMem, GFMRV_ALLOC_FAILED);
+    arena_init(&(pGlobal->levelArena), pMem, LEVEL_ARENA_SIZE);
+
+    /* Parse the options and load every corpus file */
+    i = 1;
+    while (i < argc) {
+        if (IS_OPTION(argv[i], "--seed=")) {
+            seed = (uint64_t)strtoull(GET_VALUE(argv[i], "--seed="), 0, 0);
+        }
+        else if (IS_OPTION(argv[i], "--traces=")) {
+            num = atoi(GET_VALUE(argv[i], "--traces="));
+            ASSERT(num > 0, GFMRV_ARGUMENTS_BAD);
+        }
+        else if (IS_OPTION(argv[i], "--dump=")) {
+            pDump = GET_VALUE(argv[i], "--dump=");
+        }
+        else {
+            rv = bench_load(argv[i]);
+            ASSERT(rv == GFMRV_OK, rv);
+        }
+        i++;
+    }
+
+    /* Synthesize the corpus, if none was loaded */
+    if (numTraces == 0) {
+        rng_init(&botRng, seed, RNG_BOTS);
+        i = 0;
+        while (i < num * BL_MAX) {
+            rv = bench_synthesize(&botRng, (benchLabel)(i % BL_MAX));
+            ASSERT(rv == GFMRV_OK, rv);
+            i++;
+        }
+
+        if (pDump) {
+            rv = bench_dump(pDump);
+            ASSERT(rv == GFMRV_OK, rv);
+        }
+    }
+
+    rv = gesture_getNew(&pGesture);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    rv = bench_run(pGesture);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    rv = GFMRV_OK;
+__ret:
+    gesture_free(&pGesture);
+    free(pMem);
+    free(pGlobal);
+    free(pGame);
+
+    return (rv == GFMRV_OK) ? 0 : 1;
+}
+
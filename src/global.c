@@ -3,12 +3,22 @@
  *
  * Declare all global variables
  */
+#include <base/arena.h>
+#include <base/assets.h>
+#include <base/collision.h>
+#include <base/dirty.h>
+#include <base/drawlist.h>
+#include <base/game_const.h>
 #include <base/game_ctx.h>
 #include <base/global.h>
+#include <base/replay.h>
+#include <base/rng.h>
+#include <base/softrender.h>
 
 #include <GFraMe/gfmAssert.h>
 #include <GFraMe/gfmError.h>
-#include <GFraMe/gfmQuadtree.h>
+
+#include <gen/recipeGen.h>
 
 /** Store data related to game */
 gameCtx *pGame = 0;
@@ -45,6 +55,10 @@ void global_init(void *pMem) {
 
     /* Set any pointers within those structs that were already alloc'ed */
     pConfig->pLast = (configCtx*)OFFSET_MEM(pMem, LASTCONFIG_OFFSET);
+    arena_init(&(pGlobal->levelArena), OFFSET_MEM(pMem, LEVELARENA_OFFSET),
+            LEVEL_ARENA_SIZE);
+    arena_init(&(pGlobal->frameArena), OFFSET_MEM(pMem, FRAMEARENA_OFFSET),
+            FRAME_ARENA_SIZE);
 }
 
 /**
@@ -53,15 +67,40 @@ void global_init(void *pMem) {
  * @return GFraMe return value
  */
 gfmRV global_initUserVar() {
+    /** Directory that holds the recipes' data */
+    char pRoot[MAX_ASSET_PATH];
     /** GFraMe return value */
     gfmRV rv;
+    /** Iterate through the random streams */
+    int i;
+
+    rv = drawlist_getNew(&(pGlobal->pDrawList));
+    ASSERT(rv == GFMRV_OK, rv);
 
-    /* Initialize the quadtree, so it can be later used for collision */
-    rv = gfmQuadtree_getNew(&(pGlobal->pQt));
+    /* Register how every pair of types interact */
+    rv = collision_init();
     ASSERT(rv == GFMRV_OK, rv);
 
-    /* Initialize everything */
-    rv = gesture_getNew(&(pGlobal->pGesture));
+    /* Open the input log, if recording or playing back */
+    if (pGame->flags & (GAME_RECORD | GAME_PLAYBACK)) {
+        rv = replay_getNew(&(pGlobal->pReplay), pGame->pReplayFile,
+                (pGame->flags & GAME_RECORD) != 0);
+        ASSERT(rv == GFMRV_OK, rv);
+    }
+
+    /* Derive every random stream from the session seed (which was replaced
+     * by the recorded one, if playing back) */
+    i = 0;
+    while (i < RNG_MAX) {
+        rng_init(&(pGlobal->pRng[i]), pGame->seed, (rngStream)i);
+        i++;
+    }
+
+    /* Parse every recipe once, so levels are generated from memory (the data
+     * is shipped with the other assets) */
+    rv = assets_getPath(pRoot, sizeof(pRoot), "");
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = recipeGen_getNew(&(pGlobal->pRecipeGen), pRoot);
     ASSERT(rv == GFMRV_OK, rv);
 
     rv = GFMRV_OK;
@@ -77,7 +116,10 @@ void global_freeUserVar() {
         return;
     }
 
-    gfmQuadtree_free(&(pGlobal->pQt));
-    gesture_free(&(pGlobal->pGesture));
+    recipeGen_free(&(pGlobal->pRecipeGen));
+    replay_free(&(pGlobal->pReplay));
+    softrender_free(&(pGlobal->pSoftRender));
+    dirty_free(&(pGlobal->pDirty));
+    drawlist_free(&(pGlobal->pDrawList));
 }
 
@@ -0,0 +1,473 @@
+/**
+ * @file src/grid.c
+ *
+ * Uniform spatial grid over the play area. Each entry is a rectangle (with an
+ * ID and a layer) bucketed into every cell it touches, so looking up what's
+ * over a point (or overlapping a rectangle) only checks a few entries
+ */
+#include <base/arena.h>
+#include <base/game_const.h>
+#include <base/game_ctx.h>
+#include <base/grid.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+/** Number of cells on the grid */
+#define GRID_CELLS (GRID_WIDTH * GRID_HEIGHT)
+/** Nodes reserved for each entry (an entry no bigger than a cell touches at
+ * most 4 cells) */
+#define GRID_NODES_PER_ENTRY 4
+/** Extra nodes, for the few entries bigger than a cell (e.g., the cauldron) */
+#define GRID_EXTRA_NODES 64
+
+struct stSpatialGrid {
+    /** First node on each cell (or GRID_NONE, if empty) */
+    int pHead[GRID_CELLS];
+    /** Entry referenced by each node */
+    int *pNodeId;
+    /** Next node on the same cell (or on the free list) */
+    int *pNodeNext;
+    /** Entries' horizontal position */
+    int *pX;
+    /** Entries' vertical position */
+    int *pY;
+    /** Entries' width */
+    int *pWidth;
+    /** Entries' height */
+    int *pHeight;
+    /** Entries' layer (0 if the ID isn't in use) */
+    int *pLayer;
+    /** Last query that found each entry (so entries touching many cells are
+     * only reported once) */
+    int *pStamp;
+    /** Current query */
+    int stamp;
+    /** First unused node */
+    int freeNode;
+    /** How many entries the grid may hold */
+    int maxEntries;
+};
+
+/**
+ * Retrieve the range of cells touched by a rectangle (clamped to the grid)
+ *
+ * @param  [out]pLeft   First column
+ * @param  [out]pTop    First row
+ * @param  [out]pRight  Last column
+ * @param  [out]pBottom Last row
+ * @param  [ in]x       The rectangle's horizontal position
+ * @param  [ in]y       The rectangle's vertical position
+ * @param  [ in]width   The rectangle's width
+ * @param  [ in]height  The rectangle's height
+ */
+static void grid_getCells(int *pLeft, int *pTop, int *pRight, int *pBottom,
+        int x, int y, int width, int height) {
+/** Convert a position into a cell, clamping it to the grid */
+#define TO_CELL(pos, max) \
+    ((pos) < 0 ? 0 : ((pos) / GRID_CELL >= (max) ? (max) - 1 : \
+            (pos) / GRID_CELL))
+
+    *pLeft = TO_CELL(x, GRID_WIDTH);
+    *pTop = TO_CELL(y, GRID_HEIGHT);
+    *pRight = TO_CELL(x + width - 1, GRID_WIDTH);
+    *pBottom = TO_CELL(y + height - 1, GRID_HEIGHT);
+
+#undef TO_CELL
+}
+
+/**
+ * Bucket an entry into every cell it touches
+ *
+ * @param  [ in]pCtx The grid
+ * @param  [ in]id   The entry's ID
+ * @return           GFraMe return value
+ */
+static gfmRV grid_link(spatialGrid *pCtx, int id) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Cells touched by the entry */
+    int left, top, right, bottom;
+    /** Iterate through the cells */
+    int cx, cy;
+
+    grid_getCells(&left, &top, &right, &bottom, pCtx->pX[id], pCtx->pY[id],
+            pCtx->pWidth[id], pCtx->pHeight[id]);
+
+    cy = top;
+    while (cy <= bottom) {
+        cx = left;
+        while (cx <= right) {
+            /** The new node */
+            int node;
+
+            node = pCtx->freeNode;
+            ASSERT(node != GRID_NONE, GFMRV_ALLOC_FAILED);
+            pCtx->freeNode = pCtx->pNodeNext[node];
+
+            pCtx->pNodeId[node] = id;
+            pCtx->pNodeNext[node] = pCtx->pHead[cy * GRID_WIDTH + cx];
+            pCtx->pHead[cy * GRID_WIDTH + cx] = node;
+            cx++;
+        }
+        cy++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Remove an entry from every cell it touches
+ *
+ * @param  [ in]pCtx The grid
+ * @param  [ in]id   The entry's ID
+ */
+static void grid_unlink(spatialGrid *pCtx, int id) {
+    /** Cells touched by the entry */
+    int left, top, right, bottom;
+    /** Iterate through the cells */
+    int cx, cy;
+
+    grid_getCells(&left, &top, &right, &bottom, pCtx->pX[id], pCtx->pY[id],
+            pCtx->pWidth[id], pCtx->pHeight[id]);
+
+    cy = top;
+    while (cy <= bottom) {
+        cx = left;
+        while (cx <= right) {
+            /** Link pointing to the current node */
+            int *pLink;
+
+            pLink = &(pCtx->pHead[cy * GRID_WIDTH + cx]);
+            while (*pLink != GRID_NONE) {
+                /** The current node */
+                int node;
+
+                node = *pLink;
+                if (pCtx->pNodeId[node] == id) {
+                    /* Move the node back to the free list */
+                    *pLink = pCtx->pNodeNext[node];
+                    pCtx->pNodeNext[node] = pCtx->freeNode;
+                    pCtx->freeNode = node;
+                    break;
+                }
+                pLink = &(pCtx->pNodeNext[node]);
+            }
+            cx++;
+        }
+        cy++;
+    }
+}
+
+/**
+ * Release the grid (it belongs to the level arena, so this only clears the
+ * reference)
+ *
+ * @param  [ in]ppCtx The grid
+ */
+void grid_free(spatialGrid **ppCtx) {
+    if (!ppCtx) {
+        return;
+    }
+
+    *ppCtx = 0;
+}
+
+/**
+ * Alloc a new grid from the level arena
+ *
+ * @param  [out]ppCtx      The alloc'ed grid
+ * @param  [ in]maxEntries How many entries the grid may hold (every ID must be
+ *                         less than this)
+ * @return                 GFraMe return value
+ */
+gfmRV grid_getNew(spatialGrid **ppCtx, int maxEntries) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The new grid */
+    spatialGrid *pCtx;
+    /** Number of nodes */
+    int maxNodes;
+    /** Iterate through the cells and nodes */
+    int i;
+
+/** Alloc one of the grid's arrays */
+#define ALLOC_ARRAY(arr, num) \
+    rv = arena_alloc((void**)&(pCtx->arr), &(pGlobal->levelArena), \
+            sizeof(*(pCtx->arr)) * (num)); \
+    ASSERT(rv == GFMRV_OK, rv)
+
+    ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(maxEntries > 0, GFMRV_ARGUMENTS_BAD);
+
+    rv = arena_alloc((void**)&pCtx, &(pGlobal->levelArena),
+            sizeof(spatialGrid));
+    ASSERT(rv == GFMRV_OK, rv);
+
+    maxNodes = maxEntries * GRID_NODES_PER_ENTRY + GRID_EXTRA_NODES;
+    ALLOC_ARRAY(pNodeId, maxNodes);
+    ALLOC_ARRAY(pNodeNext, maxNodes);
+    ALLOC_ARRAY(pX, maxEntries);
+    ALLOC_ARRAY(pY, maxEntries);
+    ALLOC_ARRAY(pWidth, maxEntries);
+    ALLOC_ARRAY(pHeight, maxEntries);
+    ALLOC_ARRAY(pLayer, maxEntries);
+    ALLOC_ARRAY(pStamp, maxEntries);
+    pCtx->maxEntries = maxEntries;
+
+#undef ALLOC_ARRAY
+
+    /* Every cell starts empty and every node, free */
+    i = 0;
+    while (i < GRID_CELLS) {
+        pCtx->pHead[i] = GRID_NONE;
+        i++;
+    }
+    i = 0;
+    while (i < maxNodes - 1) {
+        pCtx->pNodeNext[i] = i + 1;
+        i++;
+    }
+    pCtx->pNodeNext[maxNodes - 1] = GRID_NONE;
+    pCtx->freeNode = 0;
+
+    *ppCtx = pCtx;
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Add an entry to the grid
+ *
+ * @param  [ in]pCtx   The grid
+ * @param  [ in]id     The entry's ID
+ * @param  [ in]layer  The entry's layer (a bit mask, checked on queries)
+ * @param  [ in]x      The entry's horizontal position
+ * @param  [ in]y      The entry's vertical position
+ * @param  [ in]width  The entry's width
+ * @param  [ in]height The entry's height
+ * @return             GFraMe return value
+ */
+gfmRV grid_insert(spatialGrid *pCtx, int id, int layer, int x, int y,
+        int width, int height) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(id >= 0 && id < pCtx->maxEntries, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pCtx->pLayer[id] == 0, GFMRV_ARGUMENTS_BAD);
+    ASSERT(layer != 0, GFMRV_ARGUMENTS_BAD);
+    ASSERT(width > 0 && height > 0, GFMRV_ARGUMENTS_BAD);
+
+    pCtx->pX[id] = x;
+    pCtx->pY[id] = y;
+    pCtx->pWidth[id] = width;
+    pCtx->pHeight[id] = height;
+    pCtx->pLayer[id] = layer;
+
+    rv = grid_link(pCtx, id);
+__ret:
+    return rv;
+}
+
+/**
+ * Move an entry; It's only re-bucketed if it touches different cells
+ *
+ * @param  [ in]pCtx The grid
+ * @param  [ in]id   The entry's ID
+ * @param  [ in]x    The entry's new horizontal position
+ * @param  [ in]y    The entry's new vertical position
+ * @return           GFraMe return value
+ */
+gfmRV grid_move(spatialGrid *pCtx, int id, int x, int y) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Cells touched before and after moving */
+    int oldL, oldT, oldR, oldB, newL, newT, newR, newB;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(id >= 0 && id < pCtx->maxEntries, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pCtx->pLayer[id] != 0, GFMRV_ARGUMENTS_BAD);
+
+    grid_getCells(&oldL, &oldT, &oldR, &oldB, pCtx->pX[id], pCtx->pY[id],
+            pCtx->pWidth[id], pCtx->pHeight[id]);
+    grid_getCells(&newL, &newT, &newR, &newB, x, y, pCtx->pWidth[id],
+            pCtx->pHeight[id]);
+
+    if (oldL == newL && oldT == newT && oldR == newR && oldB == newB) {
+        /* Still on the same cells */
+        pCtx->pX[id] = x;
+        pCtx->pY[id] = y;
+        rv = GFMRV_OK;
+    }
+    else {
+        grid_unlink(pCtx, id);
+        pCtx->pX[id] = x;
+        pCtx->pY[id] = y;
+        rv = grid_link(pCtx, id);
+    }
+__ret:
+    return rv;
+}
+
+/**
+ * Retrieve the entry (on the given layers) that contains a point; If many do,
+ * the one with the lowest ID is returned
+ *
+ * @param  [ in]pCtx  The grid
+ * @param  [ in]layer Layers that should be checked
+ * @param  [ in]x     The point's horizontal position
+ * @param  [ in]y     The point's vertical position
+ * @return            The entry's ID or GRID_NONE
+ */
+int grid_queryPoint(spatialGrid *pCtx, int layer, int x, int y) {
+    /** Iterate through the cell's nodes */
+    int node;
+    /** The entry found */
+    int found;
+    /** Cell that contains the point (points outside the grid are clamped to
+     * its border, which is where entries leaving it are bucketed) */
+    int cx, cy;
+
+    grid_getCells(&cx, &cy, &cx, &cy, x, y, 1/*width*/, 1/*height*/);
+
+    found = GRID_NONE;
+    node = pCtx->pHead[cy * GRID_WIDTH + cx];
+    while (node != GRID_NONE) {
+        /** The node's entry */
+        int id;
+
+        id = pCtx->pNodeId[node];
+        if ((pCtx->pLayer[id] & layer) && (found == GRID_NONE || id < found) &&
+                x >= pCtx->pX[id] && x < pCtx->pX[id] + pCtx->pWidth[id] &&
+                y >= pCtx->pY[id] && y < pCtx->pY[id] + pCtx->pHeight[id]) {
+            found = id;
+        }
+        node = pCtx->pNodeNext[node];
+    }
+
+    return found;
+}
+
+/**
+ * Retrieve the entry (on the given layers) that overlaps a rectangle; If many
+ * do, the one with the lowest ID is returned
+ *
+ * @param  [ in]pCtx   The grid
+ * @param  [ in]layer  Layers that should be checked
+ * @param  [ in]x      The rectangle's horizontal position
+ * @param  [ in]y      The rectangle's vertical position
+ * @param  [ in]width  The rectangle's width
+ * @param  [ in]height The rectangle's height
+ * @return             The entry's ID or GRID_NONE
+ */
+int grid_queryRect(spatialGrid *pCtx, int layer, int x, int y, int width,
+        int height) {
+    /** Cells touched by the rectangle */
+    int left, top, right, bottom;
+    /** Iterate through the cells */
+    int cx, cy;
+    /** The entry found */
+    int found;
+
+    grid_getCells(&left, &top, &right, &bottom, x, y, width, height);
+
+    found = GRID_NONE;
+    cy = top;
+    while (cy <= bottom) {
+        cx = left;
+        while (cx <= right) {
+            /** Iterate through the cell's nodes */
+            int node;
+
+            node = pCtx->pHead[cy * GRID_WIDTH + cx];
+            while (node != GRID_NONE) {
+                /** The node's entry */
+                int id;
+
+                id = pCtx->pNodeId[node];
+                if ((pCtx->pLayer[id] & layer) &&
+                        (found == GRID_NONE || id < found) &&
+                        x < pCtx->pX[id] + pCtx->pWidth[id] &&
+                        x + width > pCtx->pX[id] &&
+                        y < pCtx->pY[id] + pCtx->pHeight[id] &&
+                        y + height > pCtx->pY[id]) {
+                    found = id;
+                }
+                node = pCtx->pNodeNext[node];
+            }
+            cx++;
+        }
+        cy++;
+    }
+
+    return found;
+}
+
+/**
+ * Retrieve every entry (on the given layers) that overlaps another entry
+ *
+ * @param  [out]pOut   The overlapping entries' IDs
+ * @param  [ in]pCtx   The grid
+ * @param  [ in]id     The entry being checked
+ * @param  [ in]layer  Layers that should be checked
+ * @param  [ in]maxOut How many IDs fit into pOut
+ * @return             How many entries were found (at most maxOut)
+ */
+int grid_queryOverlaps(int *pOut, spatialGrid *pCtx, int id, int layer,
+        int maxOut) {
+    /** Cells touched by the entry */
+    int left, top, right, bottom;
+    /** Iterate through the cells */
+    int cx, cy;
+    /** The entry's bounds */
+    int x, y, width, height;
+    /** How many entries were found */
+    int num;
+
+    x = pCtx->pX[id];
+    y = pCtx->pY[id];
+    width = pCtx->pWidth[id];
+    height = pCtx->pHeight[id];
+    grid_getCells(&left, &top, &right, &bottom, x, y, width, height);
+
+    /* Start a new query (the entry itself is never reported) */
+    pCtx->stamp++;
+    pCtx->pStamp[id] = pCtx->stamp;
+
+    num = 0;
+    cy = top;
+    while (cy <= bottom) {
+        cx = left;
+        while (cx <= right) {
+            /** Iterate through the cell's nodes */
+            int node;
+
+            node = pCtx->pHead[cy * GRID_WIDTH + cx];
+            while (node != GRID_NONE && num < maxOut) {
+                /** The node's entry */
+                int other;
+
+                other = pCtx->pNodeId[node];
+                if (pCtx->pStamp[other] != pCtx->stamp &&
+                        (pCtx->pLayer[other] & layer) &&
+                        x < pCtx->pX[other] + pCtx->pWidth[other] &&
+                        x + width > pCtx->pX[other] &&
+                        y < pCtx->pY[other] + pCtx->pHeight[other] &&
+                        y + height > pCtx->pY[other]) {
+                    pCtx->pStamp[other] = pCtx->stamp;
+                    pOut[num] = other;
+                    num++;
+                }
+                node = pCtx->pNodeNext[node];
+            }
+            cx++;
+        }
+        cy++;
+    }
+
+    return num;
+}
@@ -10,13 +10,65 @@
 
 #include <base/game_ctx.h>
 #include <base/input.h>
+#include <base/profiler.h>
+#include <base/replay.h>
+
+#include <string.h>
+
+/** Pointer positions sampled since the previous simulation step */
+static pointerSample pPending[MAX_POINTER_SAMPLES];
+/** Number of samples in pPending */
+static int numPending = 0;
 
 /**
- * Update all buttons' states
+ * Sample the pointer, queueing its position if it moved since the last sample
  *
  * @return GFraMe return value
  */
-gfmRV input_updateButtons() {
+static gfmRV input_queuePointer() {
+    /** Framework's input context */
+    gfmInput *pInput;
+    /** The sample */
+    pointerSample *pSample;
+    /** Return value */
+    gfmRV rv;
+    /** Current pointer position */
+    int x, y;
+
+    rv = gfm_getInput(&pInput, pGame->pCtx);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = gfmInput_getPointerPosition(&x, &y, pInput);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    /* Compare against the last queued sample (or the last one consumed, if
+     * none is queued) */
+    if ((numPending > 0 && x == pPending[numPending - 1].x &&
+            y == pPending[numPending - 1].y) ||
+            (numPending == 0 && x == pGame->mouseX && y == pGame->mouseY)) {
+        rv = GFMRV_OK;
+        goto __ret;
+    }
+
+    /* If the queue is full, keep at least the latest position */
+    if (numPending < MAX_POINTER_SAMPLES) {
+        numPending++;
+    }
+    pSample = &(pPending[numPending - 1]);
+    pSample->time = (unsigned int)(profiler_getTime() / 1000000ull);
+    pSample->x = x;
+    pSample->y = y;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Retrieve the buttons' states and the pointer position from the framework
+ *
+ * @return GFraMe return value
+ */
+static gfmRV input_readLive() {
     /** List of buttons, used to easily iterate through all of pButton's
      * members */
     button *pButtonList;
@@ -37,6 +89,141 @@ gfmRV input_updateButtons() {
         i++;
     }
 
+    /* Retrieve every pointer position since the previous step (including the
+     * current one) */
+    rv = input_queuePointer();
+    ASSERT(rv == GFMRV_OK, rv);
+    memcpy(pGame->pSamples, pPending, sizeof(pointerSample) * numPending);
+    pGame->numSamples = numPending;
+    numPending = 0;
+    if (pGame->numSamples > 0) {
+        pGame->mouseX = pGame->pSamples[pGame->numSamples - 1].x;
+        pGame->mouseY = pGame->pSamples[pGame->numSamples - 1].y;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Feed the recorded input instead of the live one
+ *
+ * @return GFraMe return value
+ */
+static gfmRV input_playback() {
+    /** Return value */
+    gfmRV rv;
+
+    rv = replay_playFrame(pGlobal->pReplay);
+    ASSERT(rv == GFMRV_TRUE || rv == GFMRV_FALSE, rv);
+    if (rv == GFMRV_FALSE) {
+        /* Finished replaying, so exit the game */
+        rv = gfm_setQuitFlag(pGame->pCtx);
+        ASSERT(rv == GFMRV_OK, rv);
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Update all buttons' states for a simulation step run on the same frame as
+ * the previous one. Since no events were handled in between, buttons keep
+ * their states, but nothing is 'just' pressed nor released anymore
+ *
+ * @return GFraMe return value
+ */
+gfmRV input_repeatButtons() {
+    /** List of buttons, used to easily iterate through all of pButton's
+     * members */
+    button *pButtonList;
+    /** Return value */
+    gfmRV rv;
+    /** Index of the current button being iterated */
+    int i;
+
+    if (pGame->flags & GAME_PLAYBACK) {
+        rv = input_playback();
+        ASSERT(rv == GFMRV_OK, rv);
+    }
+    else {
+        i = 0;
+        pButtonList = (button*)pButton;
+        while (i < (sizeof(buttonCtx) / sizeof(button))) {
+            pButtonList[i].state &= ~gfmInput_justAction;
+            i++;
+        }
+        /* Every sample was consumed by the previous step */
+        pGame->numSamples = 0;
+
+        if (pGame->flags & GAME_RECORD) {
+            rv = replay_recordFrame(pGlobal->pReplay);
+            ASSERT(rv == GFMRV_OK, rv);
+        }
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Sample the pointer as soon as its motion is handled, so the following
+ * simulation step sees every position it moved through (and not only where it
+ * was at the end of the frame). Should be called after handling events
+ *
+ * @return GFraMe return value
+ */
+gfmRV input_samplePointer() {
+    /** Return value */
+    gfmRV rv;
+
+    /* The recorded samples are used when playing back (and there's no live
+     * pointer when headless) */
+    if (pGame->flags & (GAME_PLAYBACK | GAME_HEADLESS)) {
+        rv = GFMRV_OK;
+        goto __ret;
+    }
+
+    rv = input_queuePointer();
+    ASSERT(rv == GFMRV_OK, rv);
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Update all buttons' states
+ *
+ * @return GFraMe return value
+ */
+gfmRV input_updateButtons() {
+    /** Return value */
+    gfmRV rv;
+
+    if (pGame->flags & GAME_PLAYBACK) {
+        rv = input_playback();
+        ASSERT(rv == GFMRV_OK, rv);
+    }
+    else {
+        rv = input_readLive();
+        ASSERT(rv == GFMRV_OK, rv);
+
+        if (pGame->flags & GAME_RECORD) {
+            rv = replay_recordFrame(pGlobal->pReplay);
+            ASSERT(rv == GFMRV_OK, rv);
+        }
+    }
+
+    /* There's no window to be switched in headless mode */
+    if (pGame->flags & GAME_HEADLESS) {
+        rv = GFMRV_OK;
+        goto __ret;
+    }
+
     /* Switch to/from fullscreen if the key was just pressed */
     if ((pButton->fullscreen.state & gfmInput_justReleased) ==
             gfmInput_justReleased) {
@@ -52,9 +239,9 @@ gfmRV input_updateButtons() {
         }
     }
 #if defined(DEBUG)
-    /* Switch whether rendering the quadtree is enabled */
-    if ((pButton->qt.state & gfmInput_justReleased) == gfmInput_justReleased) {
-        pGame->flags ^= DBG_RENDERQT;
+    /* Switch whether rendering the broad phase is enabled */
+    if ((pButton->bp.state & gfmInput_justReleased) == gfmInput_justReleased) {
+        pGame->flags ^= DBG_RENDERBP;
     }
 #endif
 
@@ -80,7 +267,10 @@ gfmRV input_init() {
     ADD_KEY(fullscreen);
     ADD_KEY(click);
 #if defined(DEBUG)
-    ADD_KEY(qt);
+    ADD_KEY(bp);
+    ADD_KEY(pause);
+    ADD_KEY(step);
+    ADD_KEY(ffwd);
 #endif
 
 #undef ADD_KEY
@@ -96,7 +286,10 @@ gfmRV input_init() {
     BIND_KEY(fullscreen, gfmKey_f12);
     BIND_KEY(click, gfmPointer_button);
 #if defined(DEBUG)
-    BIND_KEY(qt, gfmKey_f11);
+    BIND_KEY(bp, gfmKey_f11);
+    BIND_KEY(pause, gfmKey_f9);
+    BIND_KEY(step, gfmKey_f8);
+    BIND_KEY(ffwd, gfmKey_f10);
 #endif
 
 #undef BIND_KEY
@@ -0,0 +1,362 @@
+/**
+ * @file src/itemStore.c
+ *
+ * Store every item on the board as parallel arrays, bucketed into the spatial
+ * grid (so hovering only checks the items under the pointer). Also implements
+ * Drag 'n' Drop.
+ */
+#include <base/arena.h>
+#include <base/broadphase.h>
+#include <base/drawlist.h>
+#include <base/game_ctx.h>
+#include <base/grid.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+#include <GFraMe/gfmInput.h>
+#include <GFraMe/gfmParser.h>
+
+#include <ggj16/itemStore.h>
+#include <ggj16/recipeScroll.h>
+#include <ggj16/type.h>
+
+/** First tile of the items. All types were set sequentially on the tile set
+ * and each one spawns two tiles (the normal and a highlighted version), so
+ * retrieving the tile is a simple matter of calculating the correct index */
+#define ITEM_FIRST_TILE 352
+
+struct stItemStore {
+    /** Items' current horizontal position */
+    int *pX;
+    /** Items' current vertical position */
+    int *pY;
+    /** Items' original horizontal position */
+    int *pOriginX;
+    /** Items' original vertical position */
+    int *pOriginY;
+    /** Items' horizontal offset from the mouse, while being dragged */
+    int *pOffX;
+    /** Items' vertical offset from the mouse, while being dragged */
+    int *pOffY;
+    /** Items' width */
+    int *pWidth;
+    /** Items' height */
+    int *pHeight;
+    /** Items' type */
+    itemType *pType;
+    /** Whether each item is highlighted (i.e., the mouse is over it) */
+    unsigned char *pHighlight;
+    /** Item currently highlighted (ITEM_NONE, if none) */
+    int hovered;
+    /** Item released on the current step (ITEM_NONE, if none) */
+    int dropped;
+    /** How many items are currently stored */
+    int numItems;
+    /** How many items may be stored */
+    int maxItems;
+};
+
+/**
+ * Release the store (it belongs to the level arena, so this only clears the
+ * reference)
+ *
+ * @param  [ in]ppCtx The store
+ */
+void itemStore_free(itemStore **ppCtx) {
+    if (!ppCtx) {
+        return;
+    }
+
+    *ppCtx = 0;
+}
+
+/**
+ * Alloc a new store (and all of its arrays) from the level arena
+ *
+ * @param  [out]ppCtx    The alloc'ed store
+ * @param  [ in]maxItems How many items the store may hold
+ * @return               GFraMe return value
+ */
+gfmRV itemStore_getNew(itemStore **ppCtx, int maxItems) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The new store */
+    itemStore *pCtx;
+
+/** Alloc one of the store's arrays */
+#define ALLOC_ARRAY(arr) \
+    rv = arena_alloc((void**)&(pCtx->arr), &(pGlobal->levelArena), \
+            sizeof(*(pCtx->arr)) * maxItems); \
+    ASSERT(rv == GFMRV_OK, rv)
+
+    ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(maxItems > 0, GFMRV_ARGUMENTS_BAD);
+
+    rv = arena_alloc((void**)&pCtx, &(pGlobal->levelArena),
+            sizeof(itemStore));
+    ASSERT(rv == GFMRV_OK, rv);
+
+    ALLOC_ARRAY(pX);
+    ALLOC_ARRAY(pY);
+    ALLOC_ARRAY(pOriginX);
+    ALLOC_ARRAY(pOriginY);
+    ALLOC_ARRAY(pOffX);
+    ALLOC_ARRAY(pOffY);
+    ALLOC_ARRAY(pWidth);
+    ALLOC_ARRAY(pHeight);
+    ALLOC_ARRAY(pType);
+    ALLOC_ARRAY(pHighlight);
+    pCtx->maxItems = maxItems;
+    pCtx->hovered = ITEM_NONE;
+    pCtx->dropped = ITEM_NONE;
+
+#undef ALLOC_ARRAY
+
+    /* Nothing is being dragged on a new board */
+    pGlobal->dragging = ITEM_NONE;
+
+    *ppCtx = pCtx;
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Parse an item and add it to the store
+ *
+ * @param  [ in]pCtx    The store
+ * @param  [ in]pParser The parser
+ * @return              GFraMe return value
+ */
+gfmRV itemStore_add(itemStore *pCtx, gfmParser *pParser) {
+    /** Item's type */
+    char *pName;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Item's position */
+    int x, y;
+    /** Item's dimensions */
+    int height, width;
+    /** Index of the new item */
+    int i;
+    /** Type of the current item */
+    itemType type;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pParser, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pCtx->numItems < pCtx->maxItems, GFMRV_ALLOC_FAILED);
+
+    /* Get the item's position, dimensions and type */
+    rv = gfmParser_getPos(&x, &y, pParser);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = gfmParser_getDimensions(&width, &height, pParser);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = gfmParser_getIngameType(&pName, pParser);
+    ASSERT(rv == GFMRV_OK, rv);
+    /* Convert the type to its internal type */
+    rv = type_getHandle(&type, pName);
+    ASSERT(rv == GFMRV_OK, rv);
+    /** Adjust the vertical position to the sprite's top */
+    y -= height;
+
+    i = pCtx->numItems;
+    pCtx->pX[i] = x;
+    pCtx->pY[i] = y;
+    /* Set the position the item will be returned */
+    pCtx->pOriginX[i] = x;
+    pCtx->pOriginY[i] = y;
+    pCtx->pWidth[i] = width;
+    pCtx->pHeight[i] = height;
+    pCtx->pType[i] = type;
+    pCtx->pHighlight[i] = 0;
+
+    rv = grid_insert(pGlobal->pGrid, i, GRID_LAYER_ITEM, x, y, width, height);
+    ASSERT(rv == GFMRV_OK, rv);
+    pCtx->numItems++;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Update every item (highlight the hovered one and handle dragging). Moved
+ * items are woken on the broad phase
+ *
+ * @param  [ in]pCtx The store
+ * @return           GFraMe return value
+ */
+gfmRV itemStore_update(itemStore *pCtx) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Current mouse position on the screen */
+    int mouseX, mouseY;
+    /** Iterate through the items */
+    int i;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+
+    /* Retrieve the current mouse position */
+    mouseX = pGame->mouseX;
+    mouseY = pGame->mouseY;
+
+    /* Clear the previous highlight */
+    if (pCtx->hovered != ITEM_NONE) {
+        pCtx->pHighlight[pCtx->hovered] = 0;
+        pCtx->hovered = ITEM_NONE;
+    }
+
+    /* Check which item is hovered (unless one is being dragged) */
+    if (pGlobal->dragging == ITEM_NONE) {
+        i = grid_queryPoint(pGlobal->pGrid, GRID_LAYER_ITEM, mouseX, mouseY);
+        if (i != GRID_NONE) {
+            /* Highlight it */
+            pCtx->pHighlight[i] = 1;
+            pCtx->hovered = i;
+            /* Check if it should be dragged */
+            if ((pButton->click.state & gfmInput_justPressed) ==
+                    gfmInput_justPressed) {
+                /* Drag it and set its offset to the mouse */
+                pGlobal->dragging = i;
+                pCtx->pOffX[i] = pCtx->pX[i] - mouseX;
+                pCtx->pOffY[i] = pCtx->pY[i] - mouseY;
+            }
+        }
+    }
+
+    /* Update the item being dragged, if any */
+    i = pGlobal->dragging;
+    if (i != ITEM_NONE) {
+        /* Check if it should be released */
+        if ((pButton->click.state & gfmInput_justReleased) ==
+                gfmInput_justReleased) {
+            /* Leave it where it was dropped until the collision is handled
+             * (it's returned to its origin by itemStore_settle) */
+            pGlobal->dragging = ITEM_NONE;
+            pCtx->dropped = i;
+        }
+        else {
+            /* Update its position */
+            pCtx->pX[i] = pCtx->pOffX[i] + mouseX;
+            pCtx->pY[i] = pCtx->pOffY[i] + mouseY;
+        }
+
+        /* Only the dragged item ever moves, so only it is re-bucketed */
+        rv = grid_move(pGlobal->pGrid, i, pCtx->pX[i], pCtx->pY[i]);
+        ASSERT(rv == GFMRV_OK, rv);
+        rv = broadphase_wake(pGlobal->pBroadPhase, i);
+        ASSERT(rv == GFMRV_OK, rv);
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Handle an item overlapping the cauldron; If it was just dropped, check
+ * whether it was the expected one
+ *
+ * @param  [ in]pCtx The store
+ * @param  [ in]id   The item
+ * @return           GFraMe return value
+ */
+gfmRV itemStore_onCauldron(itemStore *pCtx, int id) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(id >= 0 && id < pCtx->numItems, GFMRV_ARGUMENTS_BAD);
+
+    if (id == pCtx->dropped) {
+        /* Check if it was the expected type */
+        recipeScroll_isExpectedItem(pGlobal->pRecipe, pCtx->pType[id]);
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Return the item dropped on this step (if any) to its origin. Must be called
+ * after the collision was handled
+ *
+ * @param  [ in]pCtx The store
+ * @return           GFraMe return value
+ */
+gfmRV itemStore_settle(itemStore *pCtx) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The dropped item */
+    int i;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+
+    i = pCtx->dropped;
+    if (i != ITEM_NONE) {
+        pCtx->pX[i] = pCtx->pOriginX[i];
+        pCtx->pY[i] = pCtx->pOriginY[i];
+        pCtx->dropped = ITEM_NONE;
+
+        rv = grid_move(pGlobal->pGrid, i, pCtx->pX[i], pCtx->pY[i]);
+        ASSERT(rv == GFMRV_OK, rv);
+        rv = broadphase_wake(pGlobal->pBroadPhase, i);
+        ASSERT(rv == GFMRV_OK, rv);
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Retrieve an item's type
+ *
+ * @param  [out]pType The item's type
+ * @param  [ in]pCtx  The store
+ * @param  [ in]id    The item
+ * @return            GFraMe return value
+ */
+gfmRV itemStore_getType(itemType *pType, itemStore *pCtx, int id) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(pType, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(id >= 0 && id < pCtx->numItems, GFMRV_ARGUMENTS_BAD);
+
+    *pType = pCtx->pType[id];
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Record every item into the draw list
+ *
+ * @param  [ in]pCtx The store
+ * @return           GFraMe return value
+ */
+gfmRV itemStore_draw(itemStore *pCtx) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the items */
+    int i;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+
+    i = 0;
+    while (i < pCtx->numItems) {
+        rv = drawlist_pushTile(pGlobal->pDrawList, SSET_8x8, pCtx->pX[i],
+                pCtx->pY[i], ITEM_FIRST_TILE + (pCtx->pType[i] - T_RAT_TAIL) *
+                2 + pCtx->pHighlight[i], 0/*isFlipped*/);
+        ASSERT(rv == GFMRV_OK, rv);
+        i++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file src/lod.c
+ *
+ * Level-of-detail controller for cosmetic effects. Tracks the rolling cost of
+ * updating and rendering the last few frames and lowers (or raises) the level
+ * to keep it within the frame's budget
+ *
+ * After the level changes, the window is cleared, so it only changes again
+ * once the new level's cost was measured (which avoids oscillating between two
+ * levels)
+ */
+#include <base/drawlist.h>
+#include <base/game_ctx.h>
+#include <base/lod.h>
+#include <base/profiler.h>
+
+/** Percentage of each attribute kept on each level (indexed by
+ * [level][attr]) */
+static int pLodPercent[LOD_LEVELS][LOD_ATTR_MAX] = {
+/*    spawn | ttl | pool */
+    {  100  , 100 , 100 },
+    {   60  ,  85 ,  50 },
+    {   40  ,  70 ,  12 },
+    {   20  ,  50 ,   3 }
+};
+
+struct stLod {
+    /** Cost of the last LOD_WINDOW frames, in nanoseconds */
+    unsigned long long pWindow[LOD_WINDOW];
+    /** Sum of every cost on the window */
+    unsigned long long sum;
+    /** Cost of the current frame, so far */
+    unsigned long long frameCost;
+    /** Time when the current section started */
+    unsigned long long start;
+    /** How many frames were added to the window since it was last cleared */
+    int numFrames;
+    /** Current level */
+    int level;
+};
+typedef struct stLod lod;
+
+/** The controller's only instance */
+static lod ctx;
+
+/**
+ * Discard every sample
+ */
+static void lod_clearWindow() {
+    ctx.sum = 0;
+    ctx.numFrames = 0;
+}
+
+/**
+ * Go back to the highest quality and discard every sample
+ */
+void lod_reset() {
+    lod_clearWindow();
+    ctx.frameCost = 0;
+    ctx.level = 0;
+}
+
+/**
+ * Start measuring a section that counts towards the frame's cost
+ */
+void lod_begin() {
+    ctx.start = profiler_getTime();
+}
+
+/**
+ * Stop measuring a section and add its duration to the frame's cost
+ */
+void lod_end() {
+    ctx.frameCost += profiler_getTime() - ctx.start;
+}
+
+/**
+ * Add the frame's cost to the rolling window and adjust the level, if needed.
+ * Must be called once every frame
+ */
+void lod_endFrame() {
+    /** Position on the window */
+    int i;
+    /** Average cost and the frame's budget, in nanoseconds */
+    unsigned long long avg, budget;
+
+    /* Replace the oldest cost */
+    i = ctx.numFrames % LOD_WINDOW;
+    if (ctx.numFrames >= LOD_WINDOW) {
+        ctx.sum -= ctx.pWindow[i];
+    }
+    ctx.pWindow[i] = ctx.frameCost;
+    ctx.sum += ctx.frameCost;
+    ctx.numFrames++;
+    ctx.frameCost = 0;
+
+    if (ctx.numFrames < LOD_WINDOW) {
+        /* Not enough samples to decide */
+        return;
+    }
+
+    avg = ctx.sum / LOD_WINDOW;
+    budget = 1000000000ull / (unsigned long long)pConfig->fps;
+    if (avg * 100 > budget * LOD_HIGH_WATER && ctx.level < LOD_LEVELS - 1) {
+        ctx.level++;
+        lod_clearWindow();
+    }
+    else if (avg * 100 < budget * LOD_LOW_WATER && ctx.level > 0) {
+        ctx.level--;
+        lod_clearWindow();
+    }
+}
+
+/**
+ * Retrieve the current level
+ *
+ * @return The level (0 is the highest quality)
+ */
+int lod_getLevel() {
+    return ctx.level;
+}
+
+/**
+ * Scale a value according to the current level; Positive values never go
+ * below 1
+ *
+ * @param  [ in]value The value at the highest quality
+ * @param  [ in]attr  Which attribute is being scaled
+ * @return            The scaled value
+ */
+int lod_scale(int value, lodAttr attr) {
+    /** The scaled value */
+    int scaled;
+
+    scaled = value * pLodPercent[ctx.level][attr] / 100;
+    if (value > 0 && scaled < 1) {
+        scaled = 1;
+    }
+
+    return scaled;
+}
+
+/**
+ * Record the current level into the draw list (only on debug mode)
+ */
+void lod_draw() {
+#if defined(DEBUG)
+    drawlist_pushTile(pGlobal->pDrawList, SSET_8x8, 160-16/*x*/, 0/*y*/,
+            'L' - '!', 0/*isFlipped*/);
+    drawlist_pushNumber(pGlobal->pDrawList, SSET_8x8, 160-8/*x*/, 0/*y*/,
+            ctx.level, 1/*numDigits*/);
+#endif
+}
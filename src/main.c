@@ -3,12 +3,20 @@
  *
  * Game entry point. Also manages update, rendering and switching states
  */
+#include <base/arena.h>
+#include <base/args.h>
 #include <base/assets.h>
 #include <base/config.h>
+#include <base/dirty.h>
+#include <base/drawlist.h>
+#include <base/frameskip.h>
 #include <base/game_const.h>
 #include <base/game_ctx.h>
 #include <base/global.h>
 #include <base/input.h>
+#include <base/lod.h>
+#include <base/profiler.h>
+#include <base/softrender.h>
 
 #include <GFraMe/gfmAssert.h>
 #include <GFraMe/gfmError.h>
@@ -16,11 +24,272 @@
 
 #include <ggj16/gamestate.h>
 
-/** Required by malloc() and free() */
+/** Required by snprintf() */
+#include <stdio.h>
+/** Required by malloc(), free() and putenv() */
 #include <stdlib.h>
 /** Required by memset() */
 #include <string.h>
 
+/**
+ * Initialize the next state, if switching
+ *
+ * @return GFraMe return value
+ */
+static gfmRV main_initState() {
+    /** Return value */
+    gfmRV rv;
+
+    if (pGame->nextState != ST_NONE) {
+        /* Init the current state, if switching */
+        switch (pGame->nextState) {
+            case ST_GAME: rv = gs_init(); break;
+            default: ASSERT(0, GFMRV_INTERNAL_ERROR);
+        }
+        ASSERT(rv == GFMRV_OK, rv);
+
+        pGame->curState = pGame->nextState;
+        pGame->nextState = ST_NONE;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Update the current state
+ *
+ * @return GFraMe return value
+ */
+static gfmRV main_updateState() {
+    /** Return value */
+    gfmRV rv;
+
+    switch (pGame->curState) {
+        case ST_GAME: rv = gs_update(); break;
+        default: ASSERT(0, GFMRV_INTERNAL_ERROR);
+    }
+    ASSERT(rv == GFMRV_OK, rv);
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Clear the current state, if switching
+ *
+ * @return GFraMe return value
+ */
+static gfmRV main_freeState() {
+    /** Return value */
+    gfmRV rv;
+
+    if (pGame->nextState != ST_NONE) {
+        switch (pGame->curState) {
+            case ST_GAME: gs_free(); break;
+            default: ASSERT(0, GFMRV_INTERNAL_ERROR);
+        }
+
+        /* Make sure nothing from the released state is rendered */
+        drawlist_begin(pGlobal->pDrawList);
+        drawlist_swap(pGlobal->pDrawList);
+        if (pGlobal->pSoftRender) {
+            softrender_clearCache(pGlobal->pSoftRender);
+        }
+        if (pGlobal->pDirty) {
+            dirty_invalidate(pGlobal->pDirty);
+        }
+
+        pGame->curState = ST_NONE;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Update everything that's purely cosmetic on the current state
+ *
+ * @return GFraMe return value
+ */
+static gfmRV main_animateState() {
+    /** Return value */
+    gfmRV rv;
+
+    switch (pGame->curState) {
+        case ST_GAME: rv = gs_animate(); break;
+        default: ASSERT(0, GFMRV_INTERNAL_ERROR);
+    }
+    ASSERT(rv == GFMRV_OK, rv);
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Record everything that the current state should render into the back buffer
+ * of the draw list, and make it the next rendered frame
+ *
+ * @return GFraMe return value
+ */
+static gfmRV main_recordState() {
+    /** Return value */
+    gfmRV rv;
+
+    drawlist_begin(pGlobal->pDrawList);
+    switch (pGame->curState) {
+        case ST_GAME: rv = gs_draw(); break;
+        default: ASSERT(0, GFMRV_INTERNAL_ERROR);
+    }
+    ASSERT(rv == GFMRV_OK, rv);
+    drawlist_swap(pGlobal->pDrawList);
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Retrieve the duration of the next simulation step. The second is spread
+ * evenly between the steps, so no time is lost to rounding (e.g., 8, 8, 9, 8,
+ * 8, 9... at 120 Hz)
+ *
+ * @return The step's duration, in miliseconds
+ */
+static int main_getStepTime() {
+    /** Step within the current (simulated) second */
+    int subStep;
+
+    subStep = pGame->step % pConfig->ups;
+    return ((subStep + 1) * 1000) / pConfig->ups -
+            (subStep * 1000) / pConfig->ups;
+}
+
+/**
+ * Advance the simulation by a single fixed step
+ *
+ * @param  [ in]isRepeat Whether another step was already simulated since the
+ *                       last time events were handled
+ * @return               GFraMe return value
+ */
+static gfmRV main_simulateStep(int isRepeat) {
+    /** Return value */
+    gfmRV rv;
+
+    pGame->elapsed = main_getStepTime();
+
+    /* NOTE: When playing back, this overwrites the elapsed time */
+    profiler_begin(PROF_INPUT);
+    if (isRepeat) {
+        rv = input_repeatButtons();
+    }
+    else {
+        rv = input_updateButtons();
+    }
+    ASSERT(rv == GFMRV_OK, rv);
+    profiler_end(PROF_INPUT);
+
+    /* Update the current state */
+    profiler_begin(PROF_UPDATE);
+    rv = main_updateState();
+    ASSERT(rv == GFMRV_OK, rv);
+    profiler_end(PROF_UPDATE);
+
+    pGame->step++;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Headless main loop. Simulates pGame->maxFrames steps (or until a replay
+ * finishes) as fast as possible, without waiting for events nor rendering
+ * anything (nor updating anything that's purely cosmetic)
+ *
+ * @return GFraMe return value
+ */
+gfmRV main_headlessLoop() {
+    /** Return value */
+    gfmRV rv;
+
+    while (pGame->step < pGame->maxFrames &&
+            gfm_didGetQuitFlag(pGame->pCtx) != GFMRV_TRUE) {
+        rv = main_initState();
+        ASSERT(rv == GFMRV_OK, rv);
+
+        arena_reset(&(pGlobal->frameArena));
+        rv = main_simulateStep(0/*isRepeat*/);
+        ASSERT(rv == GFMRV_OK, rv);
+
+        rv = main_freeState();
+        ASSERT(rv == GFMRV_OK, rv);
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Software rendered main loop. Just like main_headlessLoop, but every step is
+ * also animated, recorded and rendered into memory (and, optionally, dumped
+ * into an image)
+ *
+ * @return GFraMe return value
+ */
+gfmRV main_softwareLoop() {
+    /** Name of the image into which the frame is dumped */
+    char pName[256];
+    /** Return value */
+    gfmRV rv;
+
+    while (pGame->step < pGame->maxFrames &&
+            gfm_didGetQuitFlag(pGame->pCtx) != GFMRV_TRUE) {
+        rv = main_initState();
+        ASSERT(rv == GFMRV_OK, rv);
+
+        arena_reset(&(pGlobal->frameArena));
+        rv = main_simulateStep(0/*isRepeat*/);
+        ASSERT(rv == GFMRV_OK, rv);
+
+        profiler_begin(PROF_ANIMATE);
+        rv = main_animateState();
+        ASSERT(rv == GFMRV_OK, rv);
+        profiler_end(PROF_ANIMATE);
+
+        profiler_begin(PROF_DRAW);
+        rv = main_recordState();
+        ASSERT(rv == GFMRV_OK, rv);
+        profiler_end(PROF_DRAW);
+
+        /* Only what changed since the previous frame is redrawn */
+        profiler_begin(PROF_RENDER);
+        rv = drawlist_render(pGlobal->pDrawList);
+        ASSERT(rv == GFMRV_OK, rv);
+        profiler_end(PROF_RENDER);
+
+        if (pGame->pDumpPrefix) {
+            /* The step was already advanced, so the first frame is 0 */
+            snprintf(pName, sizeof(pName), "%s%06d.ppm", pGame->pDumpPrefix,
+                    pGame->step - 1);
+            rv = softrender_dumpFrame(pGlobal->pSoftRender, pName);
+            ASSERT(rv == GFMRV_OK, rv);
+        }
+
+        rv = main_freeState();
+        ASSERT(rv == GFMRV_OK, rv);
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
 /**
  * Main loop. Handles waiting for input, issuing update and draw, and switch the
  * current state
@@ -32,75 +301,107 @@ gfmRV main_loop() {
     gfmRV rv;
 
     while (gfm_didGetQuitFlag(pGame->pCtx) != GFMRV_TRUE) {
-        if (pGame->nextState != ST_NONE) {
-            /* Init the current state, if switching */
-            switch (pGame->nextState) {
-                case ST_GAME: rv = gs_init(); break;
-                default: ASSERT(0, GFMRV_INTERNAL_ERROR);
-            }
-            ASSERT(rv == GFMRV_OK, rv);
-
-            pGame->curState = pGame->nextState;
-            pGame->nextState = ST_NONE;
-        }
+        rv = main_initState();
+        ASSERT(rv == GFMRV_OK, rv);
 
         /* Wait for an event */
+        profiler_begin(PROF_EVENTS);
         rv = gfm_handleEvents(pGame->pCtx);
         ASSERT(rv == GFMRV_OK, rv);
+        /* Every pointer motion wakes the loop, so it's sampled many times
+         * between frames */
+        rv = input_samplePointer();
+        ASSERT(rv == GFMRV_OK, rv);
+        profiler_end(PROF_EVENTS);
+
+        /* Must be handled even while paused, as it may resume the game */
+        rv = frameskip_handleInput();
+        ASSERT(rv == GFMRV_OK, rv);
 
         while (gfm_isUpdating(pGame->pCtx) == GFMRV_TRUE) {
+            /** Time elapsed since the previous frame, in miliseconds */
+            int frameTime;
+            /** Whether a step was already simulated on this frame */
+            int isRepeat;
+
             rv = gfm_fpsCounterUpdateBegin(pGame->pCtx);
             ASSERT(rv == GFMRV_OK, rv);
+            frameskip_beginUpdate();
+            lod_begin();
+            arena_reset(&(pGlobal->frameArena));
 
-            rv = input_updateButtons();
+            rv = gfm_getElapsedTime(&frameTime, pGame->pCtx);
             ASSERT(rv == GFMRV_OK, rv);
+            /* Avoid spiraling into ever longer frames after a hiccup */
+            if (frameTime > MAX_FRAME_TIME) {
+                frameTime = MAX_FRAME_TIME;
+            }
 
-            rv = gfm_getElapsedTime(&(pGame->elapsed), pGame->pCtx);
-            ASSERT(rv == GFMRV_OK, rv);
+            /* Simulate as many fixed steps as fit into the elapsed time
+             * (scaled when fast-forwarding, or none at all if paused) */
+            pGame->accumulator += frameskip_getSimulatedTime(frameTime,
+                    main_getStepTime());
+            isRepeat = 0;
+            while (pGame->accumulator >= main_getStepTime()) {
+                pGame->accumulator -= main_getStepTime();
 
-            /* Update the current state */
-            switch (pGame->curState) {
-                case ST_GAME: rv = gs_update(); break;
-                default: ASSERT(0, GFMRV_INTERNAL_ERROR);
+                rv = main_simulateStep(isRepeat);
+                ASSERT(rv == GFMRV_OK, rv);
+                isRepeat = 1;
             }
+            /* Whatever is left is how far into the next step this frame is */
+            pGame->alpha = (double)pGame->accumulator / main_getStepTime();
+
+            profiler_begin(PROF_ANIMATE);
+            rv = main_animateState();
+            ASSERT(rv == GFMRV_OK, rv);
+            profiler_end(PROF_ANIMATE);
+
+            /* Record this frame's draw commands, while everything is still
+             * hot on the cache */
+            profiler_begin(PROF_DRAW);
+            rv = main_recordState();
             ASSERT(rv == GFMRV_OK, rv);
+            profiler_end(PROF_DRAW);
+
+            /* If this took too long, skip rendering to catch up (and lower
+             * the level of detail if it keeps happening) */
+            lod_end();
+            frameskip_endUpdate();
+            lod_endFrame();
 
             rv = gfm_fpsCounterUpdateEnd(pGame->pCtx);
             ASSERT(rv == GFMRV_OK, rv);
         }
 
         while (gfm_isDrawing(pGame->pCtx) == GFMRV_TRUE) {
+            if (frameskip_shouldDraw() != GFMRV_TRUE) {
+                /* Drop this frame (the next recorded one will be rendered
+                 * later). Leave right away, so the decision is made only once
+                 * per frame, whether or not the pending draw is retired */
+                break;
+            }
+
             rv = gfm_drawBegin(pGame->pCtx);
             ASSERT(rv == GFMRV_OK, rv);
 
-            /* Render the current state */
-            switch (pGame->curState) {
-                case ST_GAME: rv = gs_draw(); break;
-                default: ASSERT(0, GFMRV_INTERNAL_ERROR);
-            }
+            /* Render the last recorded frame (presenting it isn't counted
+             * towards the level of detail, as it may wait for the vsync) */
+            profiler_begin(PROF_RENDER);
+            lod_begin();
+            rv = drawlist_render(pGlobal->pDrawList);
             ASSERT(rv == GFMRV_OK, rv);
+            lod_end();
+            profiler_end(PROF_RENDER);
 
-#if defined(DEBUG)
-            if (pGame->flags & DBG_RENDERQT) {
-                rv = gfmQuadtree_drawBounds(pGlobal->pQt, pGame->pCtx, 0);
-                ASSERT(rv == GFMRV_OK, rv);
-            }
-#endif
-
+            profiler_begin(PROF_PRESENT);
             rv = gfm_drawEnd(pGame->pCtx);
             ASSERT(rv == GFMRV_OK, rv);
+            profiler_end(PROF_PRESENT);
         }
 
-        if (pGame->nextState != ST_NONE) {
-            /* Clear the current state, if switching */
-            switch (pGame->curState) {
-                case ST_GAME: gs_free(); break;
-                default: ASSERT(0, GFMRV_INTERNAL_ERROR);
-            }
-            ASSERT(rv == GFMRV_OK, rv);
-
-            pGame->curState = ST_NONE;
-        }
+        rv = main_freeState();
+        ASSERT(rv == GFMRV_OK, rv);
     }
 
     rv = GFMRV_OK;
@@ -115,13 +416,17 @@ __ret:
  * @param  [ in]argv 
  */
 int main(int argc, char *argv[]) {
-    /** Memory block used by the game; One day, this will hopefully point to all
-     * data used by the game, so cleaning the game will be as easy as free'ing
-     * this pointer */
+    /** Memory block used by the game; Besides the global contexts, it holds
+     * the arenas from which every level is alloc'ed, so cleaning the game is
+     * as easy as free'ing this pointer */
     void *pMem;
     /** Return value. Set either by an ASSERT that failed on as the return from
      * a call */
     gfmRV rv;
+    /** Atlas loaded by the software renderer */
+    char pAtlas[MAX_ASSET_PATH];
+    /** Factor by which software rendered frames are upscaled */
+    int scale;
 
     /* Alloc all of the game's memory */
     pMem = malloc(SIZEOF_GAME_MEM);
@@ -130,6 +435,20 @@ int main(int argc, char *argv[]) {
     /* Set and initialize it */
     global_init(pMem);
 
+    /* Parse the command line */
+    rv = args_parse(argc, argv);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    if (pGame->flags & GAME_HEADLESS) {
+        /* Nothing is ever presented, but the framework still needs a window
+         * to load the texture and create the spritesets (which the tilemaps
+         * and sprites need). SDL's dummy video driver provides one that is
+         * never shown, rendering in software. Must be set before the
+         * framework initializes SDL */
+        putenv("SDL_VIDEODRIVER=dummy");
+        putenv("SDL_RENDER_DRIVER=software");
+    }
+
     /* Initialize the framework (so the configurations may be loaded) */
     rv = gfm_getNew(&(pGame->pCtx));
     ASSERT(rv == GFMRV_OK, rv);
@@ -140,6 +459,57 @@ int main(int argc, char *argv[]) {
     rv = config_load();
     ASSERT(rv == GFMRV_OK, rv);
 
+    if (pGame->flags & GAME_HEADLESS) {
+        /* Create the hidden window (at the virtual resolution, without vsync)
+         * and load only the graphics, since nothing will be presented nor
+         * played */
+        rv = gfm_setVideoBackend(pGame->pCtx, GFM_VIDEO_SDL2);
+        ASSERT(rv == GFMRV_OK, rv);
+        rv = gfm_initGameWindow(pGame->pCtx, V_WIDTH, V_HEIGHT, V_WIDTH,
+                V_HEIGHT, 0/*canResize*/, 0/*vsync*/);
+        ASSERT(rv == GFMRV_OK, rv);
+        rv = input_init();
+        ASSERT(rv == GFMRV_OK, rv);
+        rv = assets_loadGraphics();
+        ASSERT(rv == GFMRV_OK, rv);
+        rv = global_initUserVar();
+        ASSERT(rv == GFMRV_OK, rv);
+
+        pGame->nextState = ST_GAME;
+        if (pGame->flags & GAME_SOFTWARE) {
+            /* Render into memory instead of a window, upscaling it as much as
+             * the window would be (unless overridden) */
+            scale = pGame->scale;
+            if (scale == 0) {
+                scale = pConfig->width / V_WIDTH;
+                if (pConfig->height / V_HEIGHT < scale) {
+                    scale = pConfig->height / V_HEIGHT;
+                }
+                if (scale < 1) {
+                    scale = 1;
+                }
+                else if (scale > SOFTRENDER_MAX_SCALE) {
+                    scale = SOFTRENDER_MAX_SCALE;
+                }
+            }
+            rv = assets_getPath(pAtlas, sizeof(pAtlas), SOFT_ATLAS);
+            ASSERT(rv == GFMRV_OK, rv);
+            rv = softrender_getNew(&(pGlobal->pSoftRender), pAtlas, scale);
+            ASSERT(rv == GFMRV_OK, rv);
+            rv = dirty_getNew(&(pGlobal->pDirty));
+            ASSERT(rv == GFMRV_OK, rv);
+
+            rv = main_softwareLoop();
+        }
+        else {
+            rv = main_headlessLoop();
+        }
+        ASSERT(rv == GFMRV_OK, rv);
+
+        rv = GFMRV_OK;
+        goto __ret;
+    }
+
     if (pConfig->flags & CFG_OPENGL3) {
         /* Set OpenGL 3.1 as the video backend */
         rv = gfm_setVideoBackend(pGame->pCtx, GFM_VIDEO_GL3);
@@ -179,7 +549,7 @@ int main(int argc, char *argv[]) {
     rv = assets_load();
     ASSERT(rv == GFMRV_OK, rv);
 
-    /* Initialize global variables (e.g., the quadtree) */
+    /* Initialize global variables (e.g., the draw list) */
     rv = global_initUserVar();
     ASSERT(rv == GFMRV_OK, rv);
 
@@ -195,7 +565,9 @@ int main(int argc, char *argv[]) {
         ASSERT(rv == GFMRV_OK, rv);
     }
 
-    /* Initialize the base FPS, the update rate and the draw rate */
+    /* Initialize the base FPS, the update rate and the draw rate (the
+     * simulation runs at its own fixed rate, pConfig->ups, within those
+     * updates) */
     rv = gfm_setFPS(pGame->pCtx, pConfig->fps);
     ASSERT(rv == GFMRV_OK, rv);
     rv = gfm_setStateFrameRate(pGame->pCtx, pConfig->fps, pConfig->fps);
@@ -220,6 +592,9 @@ int main(int argc, char *argv[]) {
 
     rv = GFMRV_OK;
 __ret:
+    if (pGame && (pGame->flags & GAME_PROFILE)) {
+        profiler_writeReport(pGame->pProfileFile);
+    }
     global_freeUserVar();
     if (pGame && pGame->pCtx) {
         /* Dealloc the game */
@@ -0,0 +1,419 @@
+/**
+ * @file src/particles.c
+ *
+ * Particle system. Every attribute is stored on its own (16 bytes aligned)
+ * array, so particles are integrated and culled 4 at a time (with SSE, if
+ * available), emitted in bulk and recorded as a single batch
+ */
+#include <base/arena.h>
+#include <base/drawlist.h>
+#include <base/game_const.h>
+#include <base/game_ctx.h>
+#include <base/particles.h>
+#include <base/rng.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+/** Particles are processed in groups of this many */
+#define PARTICLES_LANES 4
+
+struct stParticles {
+    /** Horizontal position */
+    float *pX;
+    /** Vertical position */
+    float *pY;
+    /** Horizontal velocity */
+    float *pVx;
+    /** Vertical velocity */
+    float *pVy;
+    /** Horizontal acceleration */
+    float *pAx;
+    /** Vertical acceleration */
+    float *pAy;
+    /** Time to live, in miliseconds */
+    float *pTtl;
+    /** Tile */
+    short *pTile;
+    /** How many particles are alive (they are always packed at the start of
+     * the arrays) */
+    int count;
+    /** How many particles may be alive (a multiple of PARTICLES_LANES) */
+    int maxParticles;
+    /** How many particles may currently be spawned (at most maxParticles) */
+    int limit;
+};
+
+/**
+ * Alloc an array from the level arena aligned to 16 bytes
+ *
+ * @param  [out]ppMem The alloc'ed array
+ * @param  [ in]size  The array's size, in bytes
+ * @return            GFraMe return value
+ */
+static gfmRV particles_allocArray(void **ppMem, size_t size) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The unaligned block */
+    char *pMem;
+
+    rv = arena_alloc((void**)&pMem, &(pGlobal->levelArena), size + 15);
+    ASSERT(rv == GFMRV_OK, rv);
+    *ppMem = (void*)(((uintptr_t)pMem + 15) & ~(uintptr_t)15);
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Release the particle system (it belongs to the level arena, so this only
+ * clears the reference)
+ *
+ * @param  [ in]ppCtx The particle system
+ */
+void particles_free(particles **ppCtx) {
+    if (!ppCtx) {
+        return;
+    }
+
+    *ppCtx = 0;
+}
+
+/**
+ * Alloc a new particle system from the level arena
+ *
+ * @param  [out]ppCtx        The alloc'ed particle system
+ * @param  [ in]maxParticles How many particles may be alive at once
+ * @return                   GFraMe return value
+ */
+gfmRV particles_getNew(particles **ppCtx, int maxParticles) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The new particle system */
+    particles *pCtx;
+
+/** Alloc one of the particles' arrays */
+#define ALLOC_ARRAY(arr) \
+    rv = particles_allocArray((void**)&(pCtx->arr), \
+            sizeof(*(pCtx->arr)) * maxParticles); \
+    ASSERT(rv == GFMRV_OK, rv)
+
+    ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(maxParticles > 0, GFMRV_ARGUMENTS_BAD);
+
+    rv = arena_alloc((void**)&pCtx, &(pGlobal->levelArena), sizeof(particles));
+    ASSERT(rv == GFMRV_OK, rv);
+
+    /* Round it up, so whole groups may always be processed */
+    maxParticles = (maxParticles + PARTICLES_LANES - 1) & ~(PARTICLES_LANES - 1);
+    ALLOC_ARRAY(pX);
+    ALLOC_ARRAY(pY);
+    ALLOC_ARRAY(pVx);
+    ALLOC_ARRAY(pVy);
+    ALLOC_ARRAY(pAx);
+    ALLOC_ARRAY(pAy);
+    ALLOC_ARRAY(pTtl);
+    ALLOC_ARRAY(pTile);
+    pCtx->maxParticles = maxParticles;
+    pCtx->limit = maxParticles;
+
+#undef ALLOC_ARRAY
+
+    *ppCtx = pCtx;
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Spawn many particles at once; If there's no space for all of them (or if it
+ * would go over the limit), only as many as fit are spawned
+ *
+ * @param  [ in]pCtx     The particle system
+ * @param  [ in]pEmitter How the particles are spawned
+ * @param  [ in]count    How many particles should be spawned
+ * @return               GFraMe return value
+ */
+gfmRV particles_emit(particles *pCtx, emitter *pEmitter, int count) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the new particles */
+    int i, last;
+    /** Range of each attribute */
+    float vxRange, vyRange, ttlRange;
+    /** The particles' random stream */
+    rng *pRng;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pEmitter, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pEmitter->numTiles > 0, GFMRV_ARGUMENTS_BAD);
+
+    last = pCtx->count + count;
+    if (last > pCtx->limit) {
+        last = pCtx->limit;
+    }
+    if (last <= pCtx->count) {
+        /* Already over the limit */
+        rv = GFMRV_OK;
+        goto __ret;
+    }
+
+    vxRange = pEmitter->vxMax - pEmitter->vxMin;
+    vyRange = pEmitter->vyMax - pEmitter->vyMin;
+    ttlRange = (float)(pEmitter->ttlMax - pEmitter->ttlMin);
+    pRng = &(pGlobal->pRng[RNG_PARTICLES]);
+
+    /* Fill every array in turn, so each one is written sequentially */
+    i = pCtx->count;
+    while (i < last) {
+        pCtx->pX[i] = pEmitter->x;
+        pCtx->pY[i] = pEmitter->y;
+        pCtx->pAx[i] = pEmitter->ax;
+        pCtx->pAy[i] = pEmitter->ay;
+        i++;
+    }
+    i = pCtx->count;
+    while (i < last) {
+        pCtx->pVx[i] = pEmitter->vxMin + vxRange * rng_nextFloat(pRng);
+        pCtx->pVy[i] = pEmitter->vyMin + vyRange * rng_nextFloat(pRng);
+        pCtx->pTtl[i] = (float)pEmitter->ttlMin + ttlRange *
+                rng_nextFloat(pRng);
+        pCtx->pTile[i] = (short)rng_range(pRng, pEmitter->firstTile,
+                pEmitter->firstTile + pEmitter->numTiles - 1);
+        i++;
+    }
+    pCtx->count = last;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Set how many particles may be alive at once (clamped to the capacity);
+ * Particles already alive over the limit are kept until they die
+ *
+ * @param  [ in]pCtx  The particle system
+ * @param  [ in]limit The new limit
+ * @return            GFraMe return value
+ */
+gfmRV particles_setLimit(particles *pCtx, int limit) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(limit >= 0, GFMRV_ARGUMENTS_BAD);
+
+    if (limit > pCtx->maxParticles) {
+        limit = pCtx->maxParticles;
+    }
+    pCtx->limit = limit;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Integrate every particle and remove the ones that died (or left the screen)
+ *
+ * @param  [ in]pCtx    The particle system
+ * @param  [ in]elapsed Time elapsed since the previous update, in miliseconds
+ * @return              GFraMe return value
+ */
+gfmRV particles_update(particles *pCtx, int elapsed) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the particles */
+    int i;
+    /** Where the next live particle is moved to */
+    int dst;
+    /** Elapsed time, in seconds */
+    float dt;
+    /** Bounds outside of which particles die (a particle is 2x2 pixels) */
+    float minX, minY, maxX, maxY;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+
+    dt = (float)elapsed / 1000.0f;
+    minX = -2.0f;
+    minY = -2.0f;
+    maxX = (float)V_WIDTH;
+    maxY = (float)V_HEIGHT;
+
+    dst = 0;
+    i = 0;
+    while (i < pCtx->count) {
+        /** Bit mask of the particles (within the group) that died */
+        int dead;
+        /** Iterate through the group */
+        int j, last;
+
+#if defined(__SSE2__)
+        __m128 x, y, vx, vy, ttl, mask;
+
+        /* Integrate the velocity, then the position (semi-implicit Euler) */
+        vx = _mm_load_ps(pCtx->pVx + i);
+        vy = _mm_load_ps(pCtx->pVy + i);
+        vx = _mm_add_ps(vx, _mm_mul_ps(_mm_load_ps(pCtx->pAx + i),
+                _mm_set1_ps(dt)));
+        vy = _mm_add_ps(vy, _mm_mul_ps(_mm_load_ps(pCtx->pAy + i),
+                _mm_set1_ps(dt)));
+        x = _mm_add_ps(_mm_load_ps(pCtx->pX + i),
+                _mm_mul_ps(vx, _mm_set1_ps(dt)));
+        y = _mm_add_ps(_mm_load_ps(pCtx->pY + i),
+                _mm_mul_ps(vy, _mm_set1_ps(dt)));
+        ttl = _mm_sub_ps(_mm_load_ps(pCtx->pTtl + i),
+                _mm_set1_ps((float)elapsed));
+        _mm_store_ps(pCtx->pVx + i, vx);
+        _mm_store_ps(pCtx->pVy + i, vy);
+        _mm_store_ps(pCtx->pX + i, x);
+        _mm_store_ps(pCtx->pY + i, y);
+        _mm_store_ps(pCtx->pTtl + i, ttl);
+
+        /* Check which died */
+        mask = _mm_cmple_ps(ttl, _mm_setzero_ps());
+        mask = _mm_or_ps(mask, _mm_cmple_ps(x, _mm_set1_ps(minX)));
+        mask = _mm_or_ps(mask, _mm_cmple_ps(y, _mm_set1_ps(minY)));
+        mask = _mm_or_ps(mask, _mm_cmpge_ps(x, _mm_set1_ps(maxX)));
+        mask = _mm_or_ps(mask, _mm_cmpge_ps(y, _mm_set1_ps(maxY)));
+        dead = _mm_movemask_ps(mask);
+#else
+        dead = 0;
+        j = 0;
+        while (j < PARTICLES_LANES) {
+            /** The current particle */
+            int k;
+
+            k = i + j;
+            pCtx->pVx[k] += pCtx->pAx[k] * dt;
+            pCtx->pVy[k] += pCtx->pAy[k] * dt;
+            pCtx->pX[k] += pCtx->pVx[k] * dt;
+            pCtx->pY[k] += pCtx->pVy[k] * dt;
+            pCtx->pTtl[k] -= (float)elapsed;
+            if (pCtx->pTtl[k] <= 0.0f || pCtx->pX[k] <= minX ||
+                    pCtx->pY[k] <= minY || pCtx->pX[k] >= maxX ||
+                    pCtx->pY[k] >= maxY) {
+                dead |= 1 << j;
+            }
+            j++;
+        }
+#endif
+
+        /* Ignore anything past the last particle (on the last group) */
+        last = pCtx->count - i;
+        if (last > PARTICLES_LANES) {
+            last = PARTICLES_LANES;
+        }
+
+        if (dead == 0 && dst == i && last == PARTICLES_LANES) {
+            /* Nothing died so far, so nothing has to be moved */
+            dst += PARTICLES_LANES;
+        }
+        else {
+            /* Pack the live particles */
+            j = 0;
+            while (j < last) {
+                if (!(dead & (1 << j))) {
+                    /** The current particle */
+                    int k;
+
+                    k = i + j;
+                    pCtx->pX[dst] = pCtx->pX[k];
+                    pCtx->pY[dst] = pCtx->pY[k];
+                    pCtx->pVx[dst] = pCtx->pVx[k];
+                    pCtx->pVy[dst] = pCtx->pVy[k];
+                    pCtx->pAx[dst] = pCtx->pAx[k];
+                    pCtx->pAy[dst] = pCtx->pAy[k];
+                    pCtx->pTtl[dst] = pCtx->pTtl[k];
+                    pCtx->pTile[dst] = pCtx->pTile[k];
+                    dst++;
+                }
+                j++;
+            }
+        }
+
+        i += PARTICLES_LANES;
+    }
+    pCtx->count = dst;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Record every particle into the draw list, as a single batch
+ *
+ * @param  [ in]pCtx The particle system
+ * @param  [ in]sset The particles' spriteset
+ * @return           GFraMe return value
+ */
+gfmRV particles_draw(particles *pCtx, spritesetId sset) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The recorded batch */
+    short *pX, *pY, *pTiles;
+    /** Iterate through the particles */
+    int i;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+
+    if (pCtx->count == 0) {
+        rv = GFMRV_OK;
+        goto __ret;
+    }
+
+    rv = drawlist_pushBatch(&pX, &pY, &pTiles, pGlobal->pDrawList, sset,
+            pCtx->count);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    i = 0;
+#if defined(__SSE2__)
+    /* Convert 8 positions at a time (every particle is on screen, so they
+     * always fit into a short) */
+    while (i + 8 <= pCtx->count) {
+        __m128i lo, hi;
+
+        lo = _mm_cvttps_epi32(_mm_load_ps(pCtx->pX + i));
+        hi = _mm_cvttps_epi32(_mm_load_ps(pCtx->pX + i + 4));
+        _mm_storeu_si128((__m128i*)(pX + i), _mm_packs_epi32(lo, hi));
+        lo = _mm_cvttps_epi32(_mm_load_ps(pCtx->pY + i));
+        hi = _mm_cvttps_epi32(_mm_load_ps(pCtx->pY + i + 4));
+        _mm_storeu_si128((__m128i*)(pY + i), _mm_packs_epi32(lo, hi));
+        i += 8;
+    }
+#endif
+    while (i < pCtx->count) {
+        pX[i] = (short)pCtx->pX[i];
+        pY[i] = (short)pCtx->pY[i];
+        i++;
+    }
+
+    i = 0;
+    while (i < pCtx->count) {
+        pTiles[i] = pCtx->pTile[i];
+        i++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Retrieve how many particles are alive
+ *
+ * @param  [ in]pCtx The particle system
+ * @return           The number of particles
+ */
+int particles_getCount(particles *pCtx) {
+    return pCtx->count;
+}
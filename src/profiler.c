@@ -0,0 +1,201 @@
+/**
+ * @file src/profiler.c
+ *
+ * Measures how long each phase of a frame takes (with a monotonic clock) and
+ * reports its percentiles on exit
+ *
+ * Each phase has its own ring of samples, written only by the main loop; Since
+ * there's a single writer per ring (and the write position is only advanced
+ * after the sample is stored), no lock is ever required
+ */
+#include <base/game_ctx.h>
+#include <base/profiler.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+#if defined(__WIN32) || defined(__WIN32__)
+#  include <windows.h>
+#else
+#  include <time.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Names written on the report (must match enProfPhase) */
+static char *pPhaseStr[PROF_MAX] = {
+    "events",
+    "input",
+    "update",
+    "animate",
+    "draw",
+    "render",
+    "present",
+    "gesture",
+    "collision",
+    "scroll",
+    "tilemap",
+    "objects",
+    "cauldron",
+    "fire"
+};
+
+struct stProfiler {
+    /** Time when each phase started */
+    unsigned long long pStart[PROF_MAX];
+    /** Total number of samples written for each phase (the position on the
+     * ring is this masked by PROF_RING_SIZE - 1) */
+    unsigned int pCount[PROF_MAX];
+    /** Duration of the last PROF_RING_SIZE samples, in nanoseconds */
+    unsigned int pRing[PROF_MAX][PROF_RING_SIZE];
+};
+typedef struct stProfiler profiler;
+
+/** The profiler's only instance */
+static profiler prof;
+
+/**
+ * Retrieve the current time from a monotonic clock
+ *
+ * @return The time, in nanoseconds
+ */
+unsigned long long profiler_getTime() {
+#if defined(__WIN32) || defined(__WIN32__)
+    /** Performance counter's frequency (constant since boot) */
+    static LARGE_INTEGER freq;
+    /** Current tick */
+    LARGE_INTEGER tick;
+
+    if (freq.QuadPart == 0) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&tick);
+
+    return (unsigned long long)(tick.QuadPart / freq.QuadPart) * 1000000000ull
+            + (unsigned long long)(tick.QuadPart % freq.QuadPart) *
+            1000000000ull / freq.QuadPart;
+#else
+    /** Current time */
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (unsigned long long)ts.tv_sec * 1000000000ull +
+            (unsigned long long)ts.tv_nsec;
+#endif
+}
+
+/**
+ * Start measuring a phase. Does nothing if GAME_PROFILE isn't set
+ *
+ * @param  [ in]phase The phase
+ */
+void profiler_begin(profPhase phase) {
+    if (!(pGame->flags & GAME_PROFILE)) {
+        return;
+    }
+
+    prof.pStart[phase] = profiler_getTime();
+}
+
+/**
+ * Stop measuring a phase and store its sample. Does nothing if GAME_PROFILE
+ * isn't set
+ *
+ * @param  [ in]phase The phase
+ */
+void profiler_end(profPhase phase) {
+    /** Duration of the phase */
+    unsigned long long dt;
+
+    if (!(pGame->flags & GAME_PROFILE)) {
+        return;
+    }
+
+    dt = profiler_getTime() - prof.pStart[phase];
+    if (dt > 0xffffffffull) {
+        /* Saturate anything longer than ~4s */
+        dt = 0xffffffffull;
+    }
+
+    prof.pRing[phase][prof.pCount[phase] & (PROF_RING_SIZE - 1)] =
+            (unsigned int)dt;
+    prof.pCount[phase]++;
+}
+
+/**
+ * Compare two samples, for qsort
+ */
+static int profiler_cmpSample(const void *pA, const void *pB) {
+    unsigned int a, b;
+
+    a = *((unsigned int*)pA);
+    b = *((unsigned int*)pB);
+    return (a > b) - (a < b);
+}
+
+/**
+ * Write the p50, p95, p99 and max of every phase (in microseconds) to a CSV
+ * file
+ *
+ * @param  [ in]pFilename The CSV file
+ * @return                GFraMe return value
+ */
+gfmRV profiler_writeReport(char *pFilename) {
+    /** Sorted copy of a phase's samples */
+    unsigned int *pSorted;
+    /** The report */
+    FILE *pFile;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the phases */
+    int i;
+
+    pSorted = 0;
+    pFile = 0;
+
+    ASSERT(pFilename, GFMRV_ARGUMENTS_BAD);
+
+    pSorted = (unsigned int*)malloc(sizeof(unsigned int) * PROF_RING_SIZE);
+    ASSERT(pSorted, GFMRV_ALLOC_FAILED);
+    pFile = fopen(pFilename, "w");
+    ASSERT(pFile, GFMRV_COULDNT_OPEN_FILE);
+
+    fprintf(pFile, "phase,samples,p50_us,p95_us,p99_us,max_us\n");
+    i = 0;
+    while (i < PROF_MAX) {
+        /** Number of samples still on the ring */
+        int num;
+
+        num = (int)prof.pCount[i];
+        if (prof.pCount[i] > PROF_RING_SIZE) {
+            num = PROF_RING_SIZE;
+        }
+
+        if (num > 0) {
+            memcpy(pSorted, prof.pRing[i], sizeof(unsigned int) * num);
+            qsort(pSorted, num, sizeof(unsigned int), profiler_cmpSample);
+
+#define PERCENTILE(p) (pSorted[((num - 1) * (p)) / 100] / 1000.0)
+            fprintf(pFile, "%s,%u,%.3f,%.3f,%.3f,%.3f\n", pPhaseStr[i],
+                    prof.pCount[i], PERCENTILE(50), PERCENTILE(95),
+                    PERCENTILE(99), pSorted[num - 1] / 1000.0);
+#undef PERCENTILE
+        }
+        else {
+            fprintf(pFile, "%s,0,,,,\n", pPhaseStr[i]);
+        }
+
+        i++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    if (pFile) {
+        fclose(pFile);
+    }
+    free(pSorted);
+
+    return rv;
+}
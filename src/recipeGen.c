@@ -0,0 +1,498 @@
+/**
+ * @file src/recipeGen.c
+ *
+ * Generates recipes from the files under data/ (on the root given to the
+ * generator). Every file is parsed once, into flat arrays that reference one
+ * another by index (templates and items referenced more than once are only
+ * parsed the first time), so generating a recipe is only a matter of walking
+ * those arrays and drawing the picks
+ */
+#include <base/rng.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+#include <gen/recipeGen.h>
+
+#include <ggj16/type.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Longest path (or identifier) on the data files */
+#define RECIPEGEN_MAX_PATH        256
+/** Longest root, prepended to every path */
+#define RECIPEGEN_MAX_ROOT        1024
+/** Most (distinct) items */
+#define RECIPEGEN_MAX_ITEMS       32
+/** Most ingredients, summed over every item */
+#define RECIPEGEN_MAX_INGREDIENTS 256
+/** Most (distinct) templates, counting each variant */
+#define RECIPEGEN_MAX_TEMPLATES   64
+/** Most items, summed over every template */
+#define RECIPEGEN_MAX_ENTRIES     512
+/** Most slots, summed over every recipe */
+#define RECIPEGEN_MAX_SLOTS       64
+/** Most variants, summed over every slot */
+#define RECIPEGEN_MAX_VARIANTS    256
+
+/** File from which each recipe is parsed (indexed by recipeId) */
+static char *pRecipeFiles[RECIPE_MAX] = {
+    "data/recipes/recipe_tutorial.txt",
+    "data/recipes/recipe_fase1.txt"
+};
+
+/** A range of entries on one of the generator's arrays */
+struct stRecipeGenRange {
+    /** Index of the first entry */
+    int first;
+    /** Number of entries */
+    int num;
+};
+typedef struct stRecipeGenRange recipeGenRange;
+
+/** An item, either a fixed ingredient or a random pick among a few */
+struct stRecipeGenItem {
+    /** The item's ingredients (on pIngredients) */
+    recipeGenRange ingredients;
+    /** Whether an ingredient is picked (otherwise, it's always the first) */
+    int isRandom;
+};
+typedef struct stRecipeGenItem recipeGenItem;
+
+struct stRecipeGen {
+    /** Directory that holds data/ (with a trailing separator) */
+    char pRoot[RECIPEGEN_MAX_ROOT];
+    /** Path of every parsed item (to find items referenced many times) */
+    char pItemPaths[RECIPEGEN_MAX_ITEMS][RECIPEGEN_MAX_PATH];
+    /** Path of every parsed template */
+    char pTemplatePaths[RECIPEGEN_MAX_TEMPLATES][RECIPEGEN_MAX_PATH];
+    /** Every item */
+    recipeGenItem pItems[RECIPEGEN_MAX_ITEMS];
+    /** Every item's ingredients */
+    int pIngredients[RECIPEGEN_MAX_INGREDIENTS];
+    /** Every template's items (on pEntries) */
+    recipeGenRange pTemplates[RECIPEGEN_MAX_TEMPLATES];
+    /** Every template's items, as indices into pItems */
+    int pEntries[RECIPEGEN_MAX_ENTRIES];
+    /** Every slot's variants (on pVariants) */
+    recipeGenRange pSlots[RECIPEGEN_MAX_SLOTS];
+    /** Every slot's variants, as indices into pTemplates */
+    int pVariants[RECIPEGEN_MAX_VARIANTS];
+    /** Every recipe's slots (on pSlots), indexed by recipeId */
+    recipeGenRange pRecipes[RECIPE_MAX];
+    /** Most items each recipe may generate */
+    int pMaxLength[RECIPE_MAX];
+    /** Number of used entries on each array */
+    int numItems;
+    int numIngredients;
+    int numTemplates;
+    int numEntries;
+    int numSlots;
+    int numVariants;
+};
+
+/**
+ * Open one of the data files
+ *
+ * @param  [out]ppFile The opened file
+ * @param  [ in]pCtx   The generator
+ * @param  [ in]pPath  The file, relative to the generator's root
+ * @return             GFraMe return value
+ */
+static gfmRV recipeGen_open(FILE **ppFile, recipeGen *pCtx, char *pPath) {
+    /** The file's full path */
+    char pFullPath[RECIPEGEN_MAX_ROOT + RECIPEGEN_MAX_PATH];
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(snprintf(pFullPath, sizeof(pFullPath), "%s%s", pCtx->pRoot, pPath)
+            < (int)sizeof(pFullPath), GFMRV_ARGUMENTS_BAD);
+    *ppFile = fopen(pFullPath, "rt");
+    ASSERT(*ppFile, GFMRV_COULDNT_OPEN_FILE);
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Parse an item, unless it was already parsed
+ *
+ * @param  [out]pIndex The item's index
+ * @param  [ in]pCtx   The generator
+ * @param  [ in]pPath  The item's file
+ * @return             GFraMe return value
+ */
+static gfmRV recipeGen_loadItem(int *pIndex, recipeGen *pCtx, char *pPath) {
+    /** The item's identifier (unused) */
+    char pId[RECIPEGEN_MAX_PATH];
+    /** The parsed item */
+    recipeGenItem *pItem;
+    /** The item's file */
+    FILE *pFile;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The item's type */
+    int type;
+    /** Iterate through the items and the ingredients */
+    int i;
+
+    pFile = 0;
+
+    /* Check whether it was already parsed */
+    i = 0;
+    while (i < pCtx->numItems) {
+        if (strcmp(pCtx->pItemPaths[i], pPath) == 0) {
+            *pIndex = i;
+            rv = GFMRV_OK;
+            goto __ret;
+        }
+        i++;
+    }
+    ASSERT(pCtx->numItems < RECIPEGEN_MAX_ITEMS, GFMRV_INTERNAL_ERROR);
+    ASSERT(strlen(pPath) < RECIPEGEN_MAX_PATH, GFMRV_ARGUMENTS_BAD);
+
+    rv = recipeGen_open(&pFile, pCtx, pPath);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    pItem = &(pCtx->pItems[pCtx->numItems]);
+    ASSERT(fscanf(pFile, "%255s %i %i", pId, &type,
+            &(pItem->ingredients.num)) == 3, GFMRV_READ_ERROR);
+    ASSERT(pItem->ingredients.num > 0, GFMRV_READ_ERROR);
+    ASSERT(pCtx->numIngredients + pItem->ingredients.num <=
+            RECIPEGEN_MAX_INGREDIENTS, GFMRV_INTERNAL_ERROR);
+    pItem->isRandom = (type != 0);
+    pItem->ingredients.first = pCtx->numIngredients;
+
+    i = 0;
+    while (i < pItem->ingredients.num) {
+        ASSERT(fscanf(pFile, "%i",
+                &(pCtx->pIngredients[pCtx->numIngredients])) == 1,
+                GFMRV_READ_ERROR);
+        pCtx->numIngredients++;
+        i++;
+    }
+
+    strcpy(pCtx->pItemPaths[pCtx->numItems], pPath);
+    *pIndex = pCtx->numItems;
+    pCtx->numItems++;
+
+    rv = GFMRV_OK;
+__ret:
+    if (pFile) {
+        fclose(pFile);
+    }
+
+    return rv;
+}
+
+/**
+ * Parse a template (and every item on it), unless it was already parsed
+ *
+ * @param  [out]pIndex The template's index
+ * @param  [ in]pCtx   The generator
+ * @param  [ in]pPath  The template's file
+ * @return             GFraMe return value
+ */
+static gfmRV recipeGen_loadTemplate(int *pIndex, recipeGen *pCtx,
+        char *pPath) {
+    /** The template's identifier (unused) and the current item's file */
+    char pId[RECIPEGEN_MAX_PATH];
+    /** The parsed template */
+    recipeGenRange *pTemplate;
+    /** The template's file */
+    FILE *pFile;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The template's type (unused) */
+    int type;
+    /** Iterate through the templates and the items */
+    int i;
+
+    pFile = 0;
+
+    /* Check whether it was already parsed */
+    i = 0;
+    while (i < pCtx->numTemplates) {
+        if (strcmp(pCtx->pTemplatePaths[i], pPath) == 0) {
+            *pIndex = i;
+            rv = GFMRV_OK;
+            goto __ret;
+        }
+        i++;
+    }
+    ASSERT(pCtx->numTemplates < RECIPEGEN_MAX_TEMPLATES,
+            GFMRV_INTERNAL_ERROR);
+
+    rv = recipeGen_open(&pFile, pCtx, pPath);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    pTemplate = &(pCtx->pTemplates[pCtx->numTemplates]);
+    ASSERT(fscanf(pFile, "%255s %i %i", pId, &type, &(pTemplate->num)) == 3,
+            GFMRV_READ_ERROR);
+    ASSERT(pTemplate->num >= 0, GFMRV_READ_ERROR);
+    ASSERT(pCtx->numEntries + pTemplate->num <= RECIPEGEN_MAX_ENTRIES,
+            GFMRV_INTERNAL_ERROR);
+    pTemplate->first = pCtx->numEntries;
+    /* Reserve the entries before parsing any item */
+    pCtx->numEntries += pTemplate->num;
+
+    i = 0;
+    while (i < pTemplate->num) {
+        ASSERT(fscanf(pFile, "%255s", pId) == 1, GFMRV_READ_ERROR);
+        rv = recipeGen_loadItem(&(pCtx->pEntries[pTemplate->first + i]),
+                pCtx, pId);
+        ASSERT(rv == GFMRV_OK, rv);
+        i++;
+    }
+
+    strcpy(pCtx->pTemplatePaths[pCtx->numTemplates], pPath);
+    *pIndex = pCtx->numTemplates;
+    pCtx->numTemplates++;
+
+    rv = GFMRV_OK;
+__ret:
+    if (pFile) {
+        fclose(pFile);
+    }
+
+    return rv;
+}
+
+/**
+ * Parse a recipe (and every variant of every template on it)
+ *
+ * @param  [ in]pCtx   The generator
+ * @param  [ in]recipe The recipe
+ * @return             GFraMe return value
+ */
+static gfmRV recipeGen_loadRecipe(recipeGen *pCtx, recipeId recipe) {
+    /** The recipe's identifier (unused) and the current template's path */
+    char pId[RECIPEGEN_MAX_PATH];
+    /** The current variant's file */
+    char pPath[RECIPEGEN_MAX_PATH];
+    /** The parsed recipe */
+    recipeGenRange *pRecipe;
+    /** The recipe's file */
+    FILE *pFile;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the slots and their variants */
+    int i, j;
+
+    pFile = 0;
+
+    rv = recipeGen_open(&pFile, pCtx, pRecipeFiles[recipe]);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    pRecipe = &(pCtx->pRecipes[recipe]);
+    ASSERT(fscanf(pFile, "%255s %i", pId, &(pRecipe->num)) == 2,
+            GFMRV_READ_ERROR);
+    ASSERT(pRecipe->num >= 0, GFMRV_READ_ERROR);
+    ASSERT(pCtx->numSlots + pRecipe->num <= RECIPEGEN_MAX_SLOTS,
+            GFMRV_INTERNAL_ERROR);
+    pRecipe->first = pCtx->numSlots;
+    pCtx->pMaxLength[recipe] = 0;
+
+    /* Only the declared number of slots are read (anything after those is
+     * ignored) */
+    i = 0;
+    while (i < pRecipe->num) {
+        /** The parsed slot */
+        recipeGenRange *pSlot;
+        /** Type of the slot's template (part of its variants' paths) */
+        int type;
+        /** Most items on any of the slot's variants */
+        int maxItems;
+
+        pSlot = &(pCtx->pSlots[pCtx->numSlots]);
+        ASSERT(fscanf(pFile, "%255s %i %i", pId, &type, &(pSlot->num)) == 3,
+                GFMRV_READ_ERROR);
+        /* A slot without variants always uses the first one */
+        if (pSlot->num < 1) {
+            pSlot->num = 1;
+        }
+        ASSERT(pCtx->numVariants + pSlot->num <= RECIPEGEN_MAX_VARIANTS,
+                GFMRV_INTERNAL_ERROR);
+        pSlot->first = pCtx->numVariants;
+
+        maxItems = 0;
+        j = 0;
+        while (j < pSlot->num) {
+            /** The variant's template */
+            int template;
+
+            ASSERT(snprintf(pPath, sizeof(pPath), "%s_%i_%i.txt", pId, type,
+                    j) < (int)sizeof(pPath), GFMRV_READ_ERROR);
+            rv = recipeGen_loadTemplate(&template, pCtx, pPath);
+            ASSERT(rv == GFMRV_OK, rv);
+
+            pCtx->pVariants[pCtx->numVariants] = template;
+            pCtx->numVariants++;
+            if (pCtx->pTemplates[template].num > maxItems) {
+                maxItems = pCtx->pTemplates[template].num;
+            }
+            j++;
+        }
+
+        pCtx->pMaxLength[recipe] += maxItems;
+        pCtx->numSlots++;
+        i++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    if (pFile) {
+        fclose(pFile);
+    }
+
+    return rv;
+}
+
+/**
+ * Release the generator and its cache
+ *
+ * @param  [ in]ppCtx The generator
+ */
+void recipeGen_free(recipeGen **ppCtx) {
+    if (!ppCtx || !*ppCtx) {
+        return;
+    }
+
+    free(*ppCtx);
+    *ppCtx = 0;
+}
+
+/**
+ * Alloc a new generator, parsing every recipe (as well as every template and
+ * item they reference) into its cache
+ *
+ * @param  [out]ppCtx The alloc'ed generator
+ * @param  [ in]pRoot Directory that holds data/ (with a trailing separator)
+ * @return            GFraMe return value
+ */
+gfmRV recipeGen_getNew(recipeGen **ppCtx, char *pRoot) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the recipes */
+    int i;
+
+    ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pRoot, GFMRV_ARGUMENTS_BAD);
+    ASSERT(strlen(pRoot) < RECIPEGEN_MAX_ROOT, GFMRV_ARGUMENTS_BAD);
+
+    *ppCtx = (recipeGen*)malloc(sizeof(recipeGen));
+    ASSERT(*ppCtx, GFMRV_ALLOC_FAILED);
+    memset(*ppCtx, 0x0, sizeof(recipeGen));
+    strcpy((*ppCtx)->pRoot, pRoot);
+
+    i = 0;
+    while (i < RECIPE_MAX) {
+        rv = recipeGen_loadRecipe(*ppCtx, (recipeId)i);
+        ASSERT(rv == GFMRV_OK, rv);
+        i++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    if (rv != GFMRV_OK) {
+        recipeGen_free(ppCtx);
+    }
+
+    return rv;
+}
+
+/**
+ * Retrieve the most items a recipe may generate
+ *
+ * @param  [ in]pCtx   The generator
+ * @param  [ in]recipe The recipe
+ * @return             The number of items
+ */
+int recipeGen_getMaxLength(recipeGen *pCtx, recipeId recipe) {
+    return pCtx->pMaxLength[recipe];
+}
+
+/**
+ * Generate a recipe. Ingredients that can't be on a recipe (e.g., the
+ * cauldron) are still picked (so the stream advances the same), but skipped
+ *
+ * @param  [out]pItems The generated items
+ * @param  [out]pLen   How many items were generated
+ * @param  [ in]maxLen How many items fit into pItems (at least
+ *                     recipeGen_getMaxLength)
+ * @param  [ in]pCtx   The generator
+ * @param  [ in]recipe The recipe
+ * @param  [ in]pRng   Stream from which every pick is drawn
+ * @return             GFraMe return value
+ */
+gfmRV recipeGen_generate(itemType *pItems, int *pLen, int maxLen,
+        recipeGen *pCtx, recipeId recipe, rng *pRng) {
+    /** Template picked for each of the recipe's slots */
+    int pPicks[RECIPEGEN_MAX_SLOTS];
+    /** The recipe */
+    recipeGenRange *pRecipe;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the slots and their items */
+    int i, j;
+
+    /* Sanitize arguments */
+    ASSERT(pItems, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pLen, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(recipe >= 0 && recipe < RECIPE_MAX, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pRng, GFMRV_ARGUMENTS_BAD);
+    ASSERT(maxLen >= pCtx->pMaxLength[recipe], GFMRV_ARGUMENTS_BAD);
+
+    pRecipe = &(pCtx->pRecipes[recipe]);
+
+    /* Pick every slot's variant before any of the ingredients */
+    i = 0;
+    while (i < pRecipe->num) {
+        /** The slot */
+        recipeGenRange *pSlot;
+
+        pSlot = &(pCtx->pSlots[pRecipe->first + i]);
+        pPicks[i] = pCtx->pVariants[pSlot->first +
+                rng_range(pRng, 0, pSlot->num - 1)];
+        i++;
+    }
+
+    *pLen = 0;
+    i = 0;
+    while (i < pRecipe->num) {
+        /** The slot's template */
+        recipeGenRange *pTemplate;
+
+        pTemplate = &(pCtx->pTemplates[pPicks[i]]);
+        j = 0;
+        while (j < pTemplate->num) {
+            /** The item */
+            recipeGenItem *pItem;
+            /** The picked ingredient */
+            int ingredient;
+
+            pItem = &(pCtx->pItems[pCtx->pEntries[pTemplate->first + j]]);
+            ingredient = pItem->ingredients.first;
+            if (pItem->isRandom) {
+                ingredient += rng_range(pRng, 0, pItem->ingredients.num - 1);
+            }
+            ingredient = pCtx->pIngredients[ingredient];
+
+            if (ingredient >= T_RAT_TAIL && ingredient < T_MAX) {
+                pItems[*pLen] = (itemType)ingredient;
+                (*pLen)++;
+            }
+            j++;
+        }
+        i++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
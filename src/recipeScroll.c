@@ -4,6 +4,9 @@
  * Manages the recipe of the current level. It displays a scrolling list and 
  * keep track of the current "expected input".
  */
+#include <base/arena.h>
+#include <base/drawlist.h>
+#include <base/game_const.h>
 #include <base/game_ctx.h>
 
 #include <GFraMe/gfmAssert.h>
@@ -15,6 +18,7 @@
 #include <ggj16/type.h>
 
 
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -24,19 +28,78 @@ static char *dictStr[] = { "dummy" };
 static int dictType[] = { 0 };
 static int dictLen = sizeof(dictType) / sizeof(int);
 
+/** Position of the mask */
+#define MASK_X (15 * 8)
+#define MASK_Y 0
+/** Vertical distance between items */
+#define RECIPE_ITEM_HEIGHT 16
+/** Number of items kept in the window (there are never more than
+ * V_HEIGHT / RECIPE_ITEM_HEIGHT + 1 visible, and it must be a power of 2) */
+#define RECIPE_RING 16
+/** First tile of the items (each one has a normal and a highlighted tile,
+ * in the same order as itemType) */
+#define RECIPE_FIRST_TILE 352
+/** Vertical position where items are activated and judged */
+#define RECIPE_JUDGE_Y 52
+/** Rate at which the recipe accelerates upward, in pixels-per-second^2 */
+#define RECIPE_ACCELERATION 1.0
+/** Speed from which the recipe stops accelerating, in pixels-per-second */
+#define RECIPE_MAX_SPEED -64.0
+
+/** Events on each item's timeline, in the order they happen */
+enum enRecipeEvent {
+    /** The item becomes the expected one (as it reaches the judging line) */
+    RE_ACTIVATE = 0,
+    /** The item is highlighted (one pixel past the line) */
+    RE_HIGHLIGHT,
+    /** The expected gesture is checked (as the item leaves the line) */
+    RE_JUDGE,
+    RE_MAX
+};
+
 struct stRecipeScroll {
-    /** Tilemap used for rendering the current state */
-    gfmTilemap *pRecipe;
+    /** Window of the items around the visible area, indexed by the item's
+     * position on the recipe (modulo RECIPE_RING) */
+    itemType pRing[RECIPE_RING];
+    /** When each event of the items within the window happens, in
+     * miliseconds since the recipe was loaded (computed as they are
+     * retrieved) */
+    double pTimeline[RECIPE_RING][RE_MAX];
+    /** Retrieves the items, as they scroll into the window */
+    recipeSource source;
+    /** Context passed to the source */
+    void *pSourceCtx;
+    /** Items loaded through recipeScroll_load (not copied) */
+    itemType *pItems;
     /** Mask that hides the incoming items */
     gfmTilemap *pMask;
-    /** Recipe's vertical position (must be manually integrated) */
+    /** Recipe's vertical position (a function of the time since it was
+     * loaded) */
     double recipeY;
-    /** Recipe's vertical speed */
+    /** Recipe's vertical position on the previous step (for interpolation) */
+    double lastRecipeY;
+    /** Recipe's initial vertical position */
+    double startY;
+    /** Recipe's initial vertical speed */
     double recipeSpeed;
+    /** Time since the recipe was loaded, in miliseconds */
+    int time;
     /** Recipe's horizontal position */
     int recipeX;
-    /** Number of items on the recipe */
+    /** Number of items on the recipe (only for recipeScroll_load) */
     int numItems;
+    /** First item still within the window (the previous ones scrolled off) */
+    int first;
+    /** Number of items retrieved from the source so far */
+    int numPulled;
+    /** Whether the source ran out of items */
+    int isOver;
+    /** Item currently highlighted (-1, if none) */
+    int highlight;
+    /** Item whose next event is on the timeline */
+    int cursor;
+    /** The next event of that item */
+    enum enRecipeEvent nextEvent;
     /** If the item was sucessfully added */
     int done;
     /* Flag when errors happen */
@@ -46,7 +109,8 @@ struct stRecipeScroll {
 };
 
 /**
- * Releases all memory
+ * Releases the scroller's mask (the scroller itself belongs to the level
+ * arena, so it's only released when the arena is reset)
  *
  * @param  [ in]ppScroll The object to be released
  */
@@ -57,18 +121,14 @@ void recipeScroll_free(recipeScroll **ppScroll) {
     }
 
     /* Release the object and all of its attributes */
-    if ((*ppScroll)->pRecipe) {
-        gfmTilemap_free(&((*ppScroll)->pRecipe));
-    }
     if ((*ppScroll)->pMask) {
         gfmTilemap_free(&((*ppScroll)->pMask));
     }
-    free(*ppScroll);
     *ppScroll = 0;
 }
 
 /**
- * Alloc a new recipe scroller
+ * Alloc a new recipe scroller from the level arena
  *
  * @param  [out]ppScroll The alloc'ed object
  * @return               GFraMe return value
@@ -79,17 +139,14 @@ gfmRV recipeScroll_getNew(recipeScroll **ppScroll) {
     /** The new object */
     recipeScroll *pScroll;
 
+    pScroll = 0;
+
     /* Alloc the object */
-    pScroll = (recipeScroll*)malloc(sizeof(recipeScroll));
-    ASSERT(pScroll, GFMRV_ALLOC_FAILED);
-    memset(pScroll, 0x0, sizeof(recipeScroll));
+    rv = arena_alloc((void**)&pScroll, &(pGlobal->levelArena),
+            sizeof(recipeScroll));
+    ASSERT(rv == GFMRV_OK, rv);
 
     /* Initialize the object's data */
-    rv = gfmTilemap_getNew(&(pScroll->pRecipe));
-    ASSERT(rv == GFMRV_OK, rv);
-    rv = gfmTilemap_init(pScroll->pRecipe, pGfx->pSset8x8, 1/*w*/, 1/*h*/,
-            -1/*defTile*/); 
-    ASSERT(rv == GFMRV_OK, rv);
     rv = gfmTilemap_getNew(&(pScroll->pMask));
     ASSERT(rv == GFMRV_OK, rv);
     rv = gfmTilemap_init(pScroll->pMask, pGfx->pSset8x8, 3/*w*/, 20/*h*/,
@@ -99,11 +156,13 @@ gfmRV recipeScroll_getNew(recipeScroll **ppScroll) {
             "map/scrollMask.gfm", dictStr, dictType, dictLen);
     ASSERT(rv == GFMRV_OK, rv);
 
-    rv = gfmTilemap_setPosition(pScroll->pMask, 15 * 8, 0);
+    rv = gfmTilemap_setPosition(pScroll->pMask, MASK_X, MASK_Y);
     ASSERT(rv == GFMRV_OK, rv);
 
     pScroll->recipeX = 16 * 8;
-    pScroll->recipeY = 8 * 8;
+    pScroll->startY = 8 * 8;
+    pScroll->recipeY = pScroll->startY;
+    pScroll->lastRecipeY = pScroll->recipeY;
     pScroll->recipeSpeed = 4;
 
     *ppScroll = pScroll;
@@ -117,49 +176,225 @@ __ret:
 }
 
 /**
- * Loads a new recipe into the scroller
+ * Retrieve an item from the list given to recipeScroll_load
+ *
+ * @param  [ in]pCtx  The scroller
+ * @param  [ in]index The item's position on the recipe
+ * @return            The item (T_NONE, after the last one)
+ */
+static itemType recipeScroll_getListItem(void *pCtx, int index) {
+    /** The scroller */
+    recipeScroll *pScroll;
+
+    pScroll = (recipeScroll*)pCtx;
+    if (index >= pScroll->numItems) {
+        return T_NONE;
+    }
+    return pScroll->pItems[index];
+}
+
+/**
+ * Retrieve for how long the recipe accelerates and the speed at which it
+ * scrolls from then on
+ *
+ * @param  [out]pDuration How long it accelerates, in seconds
+ * @param  [out]pSpeed    The final speed, in pixels-per-second
+ * @param  [ in]pScroll   The object
+ */
+static void recipeScroll_getAcceleration(double *pDuration, double *pSpeed,
+        recipeScroll *pScroll) {
+    if (pScroll->recipeSpeed > RECIPE_MAX_SPEED) {
+        *pDuration = (pScroll->recipeSpeed - RECIPE_MAX_SPEED) /
+                RECIPE_ACCELERATION;
+        *pSpeed = RECIPE_MAX_SPEED;
+    }
+    else {
+        *pDuration = 0;
+        *pSpeed = pScroll->recipeSpeed;
+    }
+}
+
+/**
+ * Calculate the recipe's vertical position at a given time. It accelerates
+ * upward at a constant rate, until it reaches its maximum speed
  *
  * @param  [ in]pScroll The object
- * @param  [ in]pItems  List of types in this recipe
- * @param  [ in]length  Number of entries in the types list
+ * @param  [ in]time    Time since the recipe was loaded, in miliseconds
+ * @return              The position
+ */
+static double recipeScroll_getPosition(recipeScroll *pScroll, double time) {
+    /** How long the recipe accelerates, in seconds */
+    double duration;
+    /** Speed after accelerating */
+    double speed;
+    /** The time, in seconds */
+    double t;
+
+    recipeScroll_getAcceleration(&duration, &speed, pScroll);
+    t = time / 1000.0;
+    if (t <= duration) {
+        return pScroll->startY + pScroll->recipeSpeed * t -
+                RECIPE_ACCELERATION * t * t / 2;
+    }
+    return pScroll->startY + pScroll->recipeSpeed * duration -
+            RECIPE_ACCELERATION * duration * duration / 2 +
+            speed * (t - duration);
+}
+
+/**
+ * Calculate when the recipe first reaches (or goes above) a given vertical
+ * position (the inverse of recipeScroll_getPosition)
+ *
+ * @param  [ in]pScroll The object
+ * @param  [ in]y       The position
+ * @return              The time, in miliseconds since the recipe was loaded
+ */
+static double recipeScroll_getTime(recipeScroll *pScroll, double y) {
+    /** How long the recipe accelerates, in seconds */
+    double duration;
+    /** Speed after accelerating */
+    double speed;
+    /** The time, in seconds */
+    double t;
+
+    if (y >= pScroll->startY) {
+        return 0;
+    }
+
+    recipeScroll_getAcceleration(&duration, &speed, pScroll);
+    /* Solve startY + v*t - a*t^2/2 = y (the greater root, as the position
+     * is above y before the smaller one) */
+    t = (pScroll->recipeSpeed + sqrt(pScroll->recipeSpeed *
+            pScroll->recipeSpeed + 2 * RECIPE_ACCELERATION *
+            (pScroll->startY - y))) / RECIPE_ACCELERATION;
+    if (t > duration) {
+        t = duration + (y - recipeScroll_getPosition(pScroll,
+                duration * 1000.0)) / speed;
+    }
+
+    return t * 1000.0;
+}
+
+/**
+ * Retrieve every item that scrolled into the window (and drop the ones that
+ * scrolled off it), calculating the timeline of the new ones. Items are also
+ * retrieved (and kept) if their events are due, even if they were never
+ * visible (e.g., on a very long step)
+ *
+ * @param  [ in]pScroll The object
+ */
+static void recipeScroll_fillWindow(recipeScroll *pScroll) {
+    /* Drop the items that are no longer visible (even when interpolating
+     * between the last two steps) */
+    while (pScroll->first < pScroll->cursor &&
+            pScroll->lastRecipeY + (pScroll->first + 1) * RECIPE_ITEM_HEIGHT
+            <= 0 && pScroll->recipeY + (pScroll->first + 1) *
+            RECIPE_ITEM_HEIGHT <= 0) {
+        pScroll->first++;
+    }
+
+    /* Pull the items that became visible */
+    while (!pScroll->isOver &&
+            pScroll->numPulled - pScroll->first < RECIPE_RING &&
+            (pScroll->numPulled <= pScroll->cursor ||
+            pScroll->recipeY + pScroll->numPulled * RECIPE_ITEM_HEIGHT <
+            V_HEIGHT)) {
+        /** The retrieved item */
+        itemType item;
+        /** The item's slot on the window */
+        int slot;
+        /** Position where the item reaches the judging line */
+        double y;
+
+        item = pScroll->source(pScroll->pSourceCtx, pScroll->numPulled);
+        if (item < T_RAT_TAIL || item >= T_MAX) {
+            pScroll->isOver = 1;
+            break;
+        }
+        slot = pScroll->numPulled & (RECIPE_RING - 1);
+        pScroll->pRing[slot] = item;
+
+        y = RECIPE_JUDGE_Y - pScroll->numPulled * RECIPE_ITEM_HEIGHT;
+        pScroll->pTimeline[slot][RE_ACTIVATE] = recipeScroll_getTime(pScroll,
+                y);
+        pScroll->pTimeline[slot][RE_HIGHLIGHT] = recipeScroll_getTime(pScroll,
+                y - 1);
+        pScroll->pTimeline[slot][RE_JUDGE] = recipeScroll_getTime(pScroll,
+                y - (RECIPE_ITEM_HEIGHT - 1));
+
+        pScroll->numPulled++;
+    }
+}
+
+/**
+ * Loads a new recipe into the scroller, retrieving its items as they scroll
+ * into view (so a recipe may be arbitrarily long, or even endless)
+ *
+ * @param  [ in]pScroll The object
+ * @param  [ in]source  Retrieves each of the recipe's items
+ * @param  [ in]pCtx    Context passed to the source
  * @param  [ in]speed   Recipe' scrolling speed (in pixels-per-second)
  * @return              GFraMe return value
  */
-gfmRV recipeScroll_load(recipeScroll *pScroll, itemType *pItems, int length,
-        double speed) {
-    /* Recipe's tile data */
-    int *pData;
+gfmRV recipeScroll_loadSource(recipeScroll *pScroll, recipeSource source,
+        void *pCtx, double speed) {
     /** GFraMe return value */
     gfmRV rv;
-    /** Iterate through the items */
-    int i;
 
-    /* Update the visible recipe */
-    rv = gfmTilemap_init(pScroll->pRecipe, pGfx->pSset8x8, 1/*w*/,
-            length * 2/*h*/, 352/*defTile*/); 
-    rv = gfmTilemap_getData(&pData, pScroll->pRecipe);
-    ASSERT(rv == GFMRV_OK, rv);
-    pScroll->numItems = length;
+    ASSERT(pScroll, GFMRV_ARGUMENTS_BAD);
+    ASSERT(source, GFMRV_ARGUMENTS_BAD);
 
-    i = 0;
-    while (i < length) {
-        /* All types were set sequentially on the tile set, with the first on
-         * tile 352. Since each one spawns two tiles (the normal and a
-         * highlighted version), retrieveing the tile is a simple matter of
-         * calculating the correct index */
-        pData[i * 2 + 0] = 352 + (pItems[i] - T_RAT_TAIL) * 2;
-        pData[i * 2 + 1] = -1;
-        i++;
-    }
+    pScroll->source = source;
+    pScroll->pSourceCtx = pCtx;
+    pScroll->first = 0;
+    pScroll->numPulled = 0;
+    pScroll->isOver = 0;
+    pScroll->highlight = -1;
+    pScroll->cursor = 0;
+    pScroll->nextEvent = RE_ACTIVATE;
 
     /* Reset the recipe's position */
     pScroll->recipeX = 16 * 8;
-    pScroll->recipeY = 8 * 8;
+    pScroll->startY = 8 * 8;
+    pScroll->recipeY = pScroll->startY;
+    pScroll->lastRecipeY = pScroll->recipeY;
     pScroll->recipeSpeed = speed;
+    pScroll->time = 0;
 
     pScroll->expected = T_NONE;
     pScroll->error = GFMRV_FALSE;
 
+    recipeScroll_fillWindow(pScroll);
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Loads a new recipe into the scroller
+ *
+ * @param  [ in]pScroll The object
+ * @param  [ in]pItems  List of types in this recipe (it isn't copied, so it
+ *                      must be kept alive while the recipe is loaded)
+ * @param  [ in]length  Number of entries in the types list
+ * @param  [ in]speed   Recipe' scrolling speed (in pixels-per-second)
+ * @return              GFraMe return value
+ */
+gfmRV recipeScroll_load(recipeScroll *pScroll, itemType *pItems, int length,
+        double speed) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(pScroll, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pItems || length == 0, GFMRV_ARGUMENTS_BAD);
+
+    pScroll->pItems = pItems;
+    pScroll->numItems = length;
+    rv = recipeScroll_loadSource(pScroll, recipeScroll_getListItem, pScroll,
+            speed);
+    ASSERT(rv == GFMRV_OK, rv);
+
     rv = GFMRV_OK;
 __ret:
     return rv;
@@ -201,64 +436,48 @@ gfmRV recipeScroll_didFail(recipeScroll *pScroll) {
  * @return              GFraMe return value
  */
 gfmRV recipeScroll_update(recipeScroll *pScroll) {
-    /* Recipe's tile data */
-    int *pData;
     /** GFraMe return value */
     gfmRV rv;
-    /** Iterate through the items */
-    int i;
 
     /* Sanitize arguments */
     ASSERT(pScroll, GFMRV_ARGUMENTS_BAD);
 
-    if (pScroll->recipeSpeed > -64) {
-        pScroll->recipeSpeed -= 1 * ((double)pGame->elapsed) / 1000.0;
-    }
-
-    /* Integrate the recipe's position */
-    pScroll->recipeY += pScroll->recipeSpeed *
-            ((double)pGame->elapsed / 1000.0);
-    rv = gfmTilemap_setPosition(pScroll->pRecipe, pScroll->recipeX,
-            (int)pScroll->recipeY);
-    rv = gfmTilemap_setPosition(pScroll->pRecipe, pScroll->recipeX, (int)pScroll->recipeY);
-    ASSERT(rv == GFMRV_OK, rv);
+    /* Calculate the recipe's position (instead of integrating it, so it's
+     * the same on any update rate) */
+    pScroll->time += pGame->elapsed;
+    pScroll->lastRecipeY = pScroll->recipeY;
+    pScroll->recipeY = recipeScroll_getPosition(pScroll,
+            (double)pScroll->time);
+
+    /* Slide the window along with the recipe */
+    recipeScroll_fillWindow(pScroll);
+
+    /* Run every event that's due, in order (even if a single step skipped
+     * over many of them) */
+    while (pScroll->cursor < pScroll->numPulled) {
+        /** The item's slot on the window */
+        int slot;
+
+        slot = pScroll->cursor & (RECIPE_RING - 1);
+        if (pScroll->time < pScroll->pTimeline[slot][pScroll->nextEvent]) {
+            break;
+        }
 
-    /* Clear the previous highlight in a lazy way */
-    rv = gfmTilemap_getData(&pData, pScroll->pRecipe);
-    ASSERT(rv == GFMRV_OK, rv);
-    i = 0;
-    while (i < pScroll->numItems) {
-        pData[i * 2 + 0] &= 0xfffffffe;
-        i++;
-    }
-    if ((int)pScroll->recipeY < 52) {
-        /** Current active tile */
-        int tile;
-        /** Position within the valid area */
-        int pos;
-
-#define MAX_H_BLA 16
-        tile = (int)(52 - pScroll->recipeY) / MAX_H_BLA;
-        pos  = (int)(52 - pScroll->recipeY) % MAX_H_BLA;
-
-        /* Check if it's still a valid item */
-        if ((pos == 0 || (pScroll->expected >= T_RAT_TAIL &&
-                pScroll->expected < T_MAX)) && tile < pScroll->numItems) {
-            if (pos == 0) {
-                /* First frame when the item can be "done" */
+        switch (pScroll->nextEvent) {
+            case RE_ACTIVATE: {
+                /* First step when the item can be "done" */
                 pScroll->done = 0;
 
                 /* Set expected item */
-                pScroll->expected  = (pData[tile * 2 + 0] - 352) / 2 +
-                        T_RAT_TAIL;
+                pScroll->expected = pScroll->pRing[slot];
                 /* Clear motion */
                 gesture_reset(pGlobal->pGesture);
-            }
-            else if (pos >= 1 && pos < MAX_H_BLA - 1) {
+            } break;
+            case RE_HIGHLIGHT: {
                 /* Highlight the current item */
-                pData[tile *  2 + 0] |= 1;
-            }
-            else if (pos == MAX_H_BLA - 1) {
+                pScroll->highlight = pScroll->cursor;
+            } break;
+            case RE_JUDGE: {
                 if (!pScroll->done) {
                     /** All possibles actions states */
                     itemType pActions[4];
@@ -291,15 +510,22 @@ gfmRV recipeScroll_update(recipeScroll *pScroll) {
                     /* Clean the state */
                     pScroll->expected = T_NONE;
                 }
-            }
+                pScroll->highlight = -1;
+            } break;
+            default: {}
         }
-        else {
-            /* TODO Set finished */
+
+        pScroll->nextEvent++;
+        if (pScroll->nextEvent == RE_MAX) {
+            /* Move on to the next item (retrieving it, if it's due but was
+             * never visible) */
+            pScroll->nextEvent = RE_ACTIVATE;
+            pScroll->cursor++;
+            recipeScroll_fillWindow(pScroll);
         }
     }
+    /* TODO Set finished (once the cursor passes the last item) */
 
-    rv = gfmTilemap_update(pScroll->pRecipe, pGame->pCtx);
-    ASSERT(rv == GFMRV_OK, rv);
     rv = gfmTilemap_update(pScroll->pMask, pGame->pCtx);
     ASSERT(rv == GFMRV_OK, rv);
 
@@ -309,7 +535,7 @@ __ret:
 }
 
 /**
- * Draw the scroller
+ * Record the scroller into the draw list
  *
  * @param  [ in]pScroll The object
  * @return              GFraMe return value
@@ -317,11 +543,36 @@ __ret:
 gfmRV recipeScroll_draw(recipeScroll *pScroll) {
     /** GFraMe return value */
     gfmRV rv;
+    /** Recipe's position, interpolated between the last two steps */
+    int y;
+    /** Iterate through the items within the window */
+    int i;
+
+    y = (int)(pScroll->lastRecipeY + (pScroll->recipeY -
+            pScroll->lastRecipeY) * pGame->alpha);
 
     /* Draw the recipe bellow the mask, so it's partially hidden */
-    rv = gfmTilemap_draw(pScroll->pRecipe, pGame->pCtx);
-    ASSERT(rv == GFMRV_OK, rv);
-    rv = gfmTilemap_draw(pScroll->pMask, pGame->pCtx);
+    drawlist_setLayer(pGlobal->pDrawList, DRAW_LAYER_RECIPE);
+    i = pScroll->first;
+    while (i < pScroll->numPulled) {
+        /** The item's vertical position */
+        int itemY;
+
+        itemY = y + i * RECIPE_ITEM_HEIGHT;
+        if (itemY > -8 && itemY < V_HEIGHT) {
+            /* All types were set sequentially on the tile set, each with a
+             * normal and a highlighted version */
+            rv = drawlist_pushTile(pGlobal->pDrawList, SSET_8x8,
+                    pScroll->recipeX, itemY, RECIPE_FIRST_TILE +
+                    (pScroll->pRing[i & (RECIPE_RING - 1)] - T_RAT_TAIL) * 2 +
+                    (i == pScroll->highlight), 0/*isFlipped*/);
+            ASSERT(rv == GFMRV_OK, rv);
+        }
+        i++;
+    }
+    drawlist_setLayer(pGlobal->pDrawList, DRAW_LAYER_MASK);
+    rv = drawlist_pushTilemap(pGlobal->pDrawList, SSET_8x8, pScroll->pMask,
+            MASK_X, MASK_Y);
     ASSERT(rv == GFMRV_OK, rv);
 
     rv = GFMRV_OK;
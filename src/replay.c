@@ -0,0 +1,353 @@
+/**
+ * @file src/replay.c
+ *
+ * Records the input of every frame into a compact binary log, so it may be
+ * later replayed deterministically
+ */
+#include <base/game_ctx.h>
+#include <base/replay.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Log's magic number */
+#define REPLAY_MAGIC    "GGJR"
+/** Log's version */
+#define REPLAY_VERSION  3
+/** Number of buttons in pButton */
+#define NUM_BUTTONS     ((int)(sizeof(buttonCtx) / sizeof(button)))
+/** Maximum number of buttons that fits on the 'changed' mask */
+#define MAX_BUTTONS     8
+
+struct stReplay {
+    /** The log */
+    FILE *pFile;
+    /** Whether the log is being written */
+    int isRecording;
+    /** Number of buttons on the log (may differ between DEBUG and release) */
+    int numButtons;
+    /** Previous pointer sample */
+    unsigned int lastTime;
+    int lastX;
+    int lastY;
+    /** Buttons' states on the previous frame */
+    int pLastState[MAX_BUTTONS];
+    int pLastNumPressed[MAX_BUTTONS];
+};
+
+/**
+ * Write an unsigned value, 7 bits at a time (the MSB is set on every byte but
+ * the last)
+ *
+ * @param  [ in]pFile The log
+ * @param  [ in]val   The value
+ */
+static void replay_writeVarint(FILE *pFile, unsigned int val) {
+    while (val >= 0x80) {
+        fputc((int)((val & 0x7f) | 0x80), pFile);
+        val >>= 7;
+    }
+    fputc((int)val, pFile);
+}
+
+/**
+ * Read an unsigned value written by replay_writeVarint
+ *
+ * @param  [out]pVal  The value
+ * @param  [ in]pFile The log
+ * @return            GFMRV_TRUE, GFMRV_FALSE (reached the end of the log),
+ *                    GFMRV_READ_ERROR (the value was truncated or didn't fit
+ *                    into an unsigned int)
+ */
+static gfmRV replay_readVarint(unsigned int *pVal, FILE *pFile) {
+    /** Current byte */
+    int c;
+    /** Position of the current 7 bits */
+    int shift;
+
+    *pVal = 0;
+    shift = 0;
+    do {
+        if (shift >= 32) {
+            /* Too many continuation bytes; The log is corrupted */
+            return GFMRV_READ_ERROR;
+        }
+        c = fgetc(pFile);
+        if (c == EOF) {
+            /* Only the end of the log if no byte was read */
+            return (shift == 0) ? GFMRV_FALSE : GFMRV_READ_ERROR;
+        }
+        *pVal |= ((unsigned int)(c & 0x7f)) << shift;
+        shift += 7;
+    } while (c & 0x80);
+
+    return GFMRV_TRUE;
+}
+
+/** Map signed values to unsigned ones, so small negatives are still short */
+#define ZIGZAG_ENCODE(n)  ((((unsigned int)(n)) << 1) ^ (unsigned int)((n) >> 31))
+#define ZIGZAG_DECODE(n)  ((int)((n) >> 1) ^ -((int)((n) & 1)))
+
+/**
+ * Release the replay, closing its file
+ *
+ * @param  [ in]ppCtx The replay
+ */
+void replay_free(replay **ppCtx) {
+    if (!ppCtx || !*ppCtx) {
+        return;
+    }
+
+    if ((*ppCtx)->pFile) {
+        fclose((*ppCtx)->pFile);
+    }
+    free(*ppCtx);
+    *ppCtx = 0;
+}
+
+/**
+ * Alloc a new replay and open its log
+ *
+ * @param  [out]ppCtx       The alloc'ed replay
+ * @param  [ in]pFilename   The log's path
+ * @param  [ in]isRecording Whether the log should be written (1) or read (0)
+ * @return                  GFraMe return value
+ */
+gfmRV replay_getNew(replay **ppCtx, char *pFilename, int isRecording) {
+    /** Header read from the log */
+    char pHeader[sizeof(REPLAY_MAGIC) - 1];
+    /** The alloc'ed replay */
+    replay *pCtx;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the seed's bytes */
+    int i;
+
+    /* Sanitize arguments */
+    ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pFilename, GFMRV_ARGUMENTS_BAD);
+    ASSERT(NUM_BUTTONS <= MAX_BUTTONS, GFMRV_INTERNAL_ERROR);
+
+    pCtx = (replay*)malloc(sizeof(replay));
+    ASSERT(pCtx, GFMRV_ALLOC_FAILED);
+    memset(pCtx, 0x0, sizeof(replay));
+    pCtx->isRecording = isRecording;
+
+    if (isRecording) {
+        pCtx->pFile = fopen(pFilename, "wb");
+        ASSERT(pCtx->pFile, GFMRV_COULDNT_OPEN_FILE);
+
+        fwrite(REPLAY_MAGIC, 1, sizeof(REPLAY_MAGIC) - 1, pCtx->pFile);
+        fputc(REPLAY_VERSION, pCtx->pFile);
+        fputc(NUM_BUTTONS, pCtx->pFile);
+        pCtx->numButtons = NUM_BUTTONS;
+        /* Store the session seed, little-endian */
+        i = 0;
+        while (i < 8) {
+            fputc((int)((pGame->seed >> (i * 8)) & 0xff), pCtx->pFile);
+            i++;
+        }
+    }
+    else {
+        pCtx->pFile = fopen(pFilename, "rb");
+        ASSERT(pCtx->pFile, GFMRV_COULDNT_OPEN_FILE);
+
+        ASSERT(fread(pHeader, 1, sizeof(pHeader), pCtx->pFile) ==
+                sizeof(pHeader), GFMRV_READ_ERROR);
+        ASSERT(memcmp(pHeader, REPLAY_MAGIC, sizeof(pHeader)) == 0,
+                GFMRV_READ_ERROR);
+        ASSERT(fgetc(pCtx->pFile) == REPLAY_VERSION, GFMRV_READ_ERROR);
+        pCtx->numButtons = fgetc(pCtx->pFile);
+        ASSERT(pCtx->numButtons > 0 && pCtx->numButtons <= MAX_BUTTONS,
+                GFMRV_READ_ERROR);
+        /* Replace the session seed with the recorded one */
+        pGame->seed = 0;
+        i = 0;
+        while (i < 8) {
+            /** Current byte */
+            int c;
+
+            c = fgetc(pCtx->pFile);
+            ASSERT(c != EOF, GFMRV_READ_ERROR);
+            pGame->seed |= ((uint64_t)c) << (i * 8);
+            i++;
+        }
+    }
+
+    *ppCtx = pCtx;
+    rv = GFMRV_OK;
+__ret:
+    if (rv != GFMRV_OK) {
+        replay_free(&pCtx);
+    }
+
+    return rv;
+}
+
+/**
+ * Write the current frame's input (i.e., pButton, the pointer samples and the
+ * elapsed time) to the log
+ *
+ * @param  [ in]pCtx The replay
+ * @return           GFraMe return value
+ */
+gfmRV replay_recordFrame(replay *pCtx) {
+    /** List of buttons, used to easily iterate through all of pButton's
+     * members */
+    button *pButtonList;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Buttons that changed since the previous frame */
+    int changed;
+    /** Iterate through all buttons and samples */
+    int i;
+
+    /* Sanitize arguments */
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pCtx->isRecording, GFMRV_ARGUMENTS_BAD);
+
+    replay_writeVarint(pCtx->pFile, (unsigned int)pGame->elapsed);
+
+    replay_writeVarint(pCtx->pFile, (unsigned int)pGame->numSamples);
+    i = 0;
+    while (i < pGame->numSamples) {
+        /** The sample */
+        pointerSample *pSample;
+
+        pSample = &(pGame->pSamples[i]);
+        replay_writeVarint(pCtx->pFile, pSample->time - pCtx->lastTime);
+        replay_writeVarint(pCtx->pFile,
+                ZIGZAG_ENCODE(pSample->x - pCtx->lastX));
+        replay_writeVarint(pCtx->pFile,
+                ZIGZAG_ENCODE(pSample->y - pCtx->lastY));
+        pCtx->lastTime = pSample->time;
+        pCtx->lastX = pSample->x;
+        pCtx->lastY = pSample->y;
+        i++;
+    }
+
+    /* Only store the buttons that changed */
+    pButtonList = (button*)pButton;
+    changed = 0;
+    i = 0;
+    while (i < NUM_BUTTONS) {
+        if ((int)pButtonList[i].state != pCtx->pLastState[i] ||
+                pButtonList[i].numPressed != pCtx->pLastNumPressed[i]) {
+            changed |= 1 << i;
+        }
+        i++;
+    }
+    fputc(changed, pCtx->pFile);
+
+    i = 0;
+    while (i < NUM_BUTTONS) {
+        if (changed & (1 << i)) {
+            replay_writeVarint(pCtx->pFile,
+                    (unsigned int)pButtonList[i].state);
+            replay_writeVarint(pCtx->pFile,
+                    (unsigned int)pButtonList[i].numPressed);
+            pCtx->pLastState[i] = (int)pButtonList[i].state;
+            pCtx->pLastNumPressed[i] = pButtonList[i].numPressed;
+        }
+        i++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Overwrite the current frame's input (i.e., pButton, the pointer samples and
+ * the elapsed time) with the next one from the log
+ *
+ * @param  [ in]pCtx The replay
+ * @return           GFMRV_TRUE (read a frame), GFMRV_FALSE (reached the end of
+ *                   the log), ...
+ */
+gfmRV replay_playFrame(replay *pCtx) {
+    /** List of buttons, used to easily iterate through all of pButton's
+     * members */
+    button *pButtonList;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Value read from the log */
+    unsigned int val;
+    /** Buttons that changed since the previous frame */
+    int changed;
+    /** Iterate through all buttons and samples */
+    int i;
+
+    /* Sanitize arguments */
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(!pCtx->isRecording, GFMRV_ARGUMENTS_BAD);
+
+    /* Reaching the end of the log on a frame boundary is expected */
+    rv = replay_readVarint(&val, pCtx->pFile);
+    if (rv == GFMRV_FALSE) {
+        goto __ret;
+    }
+    ASSERT(rv == GFMRV_TRUE, rv);
+    pGame->elapsed = (int)val;
+
+    rv = replay_readVarint(&val, pCtx->pFile);
+    ASSERT(rv == GFMRV_TRUE, GFMRV_READ_ERROR);
+    ASSERT(val <= MAX_POINTER_SAMPLES, GFMRV_READ_ERROR);
+    pGame->numSamples = (int)val;
+    i = 0;
+    while (i < pGame->numSamples) {
+        /** The sample */
+        pointerSample *pSample;
+
+        rv = replay_readVarint(&val, pCtx->pFile);
+        ASSERT(rv == GFMRV_TRUE, GFMRV_READ_ERROR);
+        pCtx->lastTime += val;
+        rv = replay_readVarint(&val, pCtx->pFile);
+        ASSERT(rv == GFMRV_TRUE, GFMRV_READ_ERROR);
+        pCtx->lastX += ZIGZAG_DECODE(val);
+        rv = replay_readVarint(&val, pCtx->pFile);
+        ASSERT(rv == GFMRV_TRUE, GFMRV_READ_ERROR);
+        pCtx->lastY += ZIGZAG_DECODE(val);
+
+        pSample = &(pGame->pSamples[i]);
+        pSample->time = pCtx->lastTime;
+        pSample->x = pCtx->lastX;
+        pSample->y = pCtx->lastY;
+        i++;
+    }
+    pGame->mouseX = pCtx->lastX;
+    pGame->mouseY = pCtx->lastY;
+
+    changed = fgetc(pCtx->pFile);
+    ASSERT(changed != EOF, GFMRV_READ_ERROR);
+
+    i = 0;
+    while (i < pCtx->numButtons) {
+        if (changed & (1 << i)) {
+            rv = replay_readVarint(&val, pCtx->pFile);
+            ASSERT(rv == GFMRV_TRUE, GFMRV_READ_ERROR);
+            pCtx->pLastState[i] = (int)val;
+            rv = replay_readVarint(&val, pCtx->pFile);
+            ASSERT(rv == GFMRV_TRUE, GFMRV_READ_ERROR);
+            pCtx->pLastNumPressed[i] = (int)val;
+        }
+        i++;
+    }
+
+    /* Buttons that were only recorded on another build are ignored */
+    pButtonList = (button*)pButton;
+    i = 0;
+    while (i < NUM_BUTTONS && i < pCtx->numButtons) {
+        pButtonList[i].state = (gfmInputState)pCtx->pLastState[i];
+        pButtonList[i].numPressed = pCtx->pLastNumPressed[i];
+        i++;
+    }
+
+    rv = GFMRV_TRUE;
+__ret:
+    return rv;
+}
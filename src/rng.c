@@ -0,0 +1,177 @@
+/**
+ * @file src/rng.c
+ *
+ * Seedable pseudo-random number generator (xoshiro256**). Each subsystem draws
+ * from its own stream, derived from a single session seed, so they're
+ * reproducible and don't disturb one another
+ *
+ * The session seed is expanded into the initial state with splitmix64 (so even
+ * seeds such as 0 or 1 produce a good state) and each stream is then moved
+ * forward by the generator's jump function
+ */
+#include <base/rng.h>
+
+#include <stdint.h>
+
+/** Rotate a 64 bits value to the left */
+#define ROTL(x, k) (((x) << (k)) | ((x) >> (64 - (k))))
+
+/**
+ * Retrieve the next value from a splitmix64 sequence
+ *
+ * @param  [ in]pSeed The sequence's state
+ * @return            The value
+ */
+static uint64_t rng_splitmix64(uint64_t *pSeed) {
+    /** The value */
+    uint64_t z;
+
+    *pSeed += 0x9e3779b97f4a7c15ull;
+    z = *pSeed;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Initialize one of the streams derived from a session seed; Every stream
+ * starts 2^128 numbers after the previous one, so they never overlap
+ *
+ * @param  [ in]pCtx   The generator
+ * @param  [ in]seed   The session seed
+ * @param  [ in]stream Which stream should be used
+ */
+void rng_init(rng *pCtx, uint64_t seed, rngStream stream) {
+    /** Iterate through the state and the streams */
+    int i;
+
+    i = 0;
+    while (i < 4) {
+        pCtx->pState[i] = rng_splitmix64(&seed);
+        i++;
+    }
+
+    i = 0;
+    while (i < (int)stream) {
+        rng_jump(pCtx);
+        i++;
+    }
+}
+
+/**
+ * Retrieve the next number
+ *
+ * @param  [ in]pCtx The generator
+ * @return           A number within [0, 2^64)
+ */
+uint64_t rng_next(rng *pCtx) {
+    /** The state */
+    uint64_t *s;
+    /** The number and a temporary */
+    uint64_t res, t;
+
+    s = pCtx->pState;
+    res = ROTL(s[1] * 5, 7) * 9;
+    t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = ROTL(s[3], 45);
+
+    return res;
+}
+
+/**
+ * Retrieve a number within a range (without the modulo bias)
+ *
+ * @param  [ in]pCtx The generator
+ * @param  [ in]min  The lowest value (inclusive)
+ * @param  [ in]max  The highest value (inclusive)
+ * @return           A number within [min, max]
+ */
+int rng_range(rng *pCtx, int min, int max) {
+    /** Number of possible values */
+    uint32_t range;
+    /** Scaled number */
+    uint64_t m;
+
+    if (max <= min) {
+        return min;
+    }
+
+    /* Scale a 32 bits number into the range by multiplying it; The few low
+     * results that would be picked once more than the others are rejected */
+    range = (uint32_t)max - (uint32_t)min + 1;
+    if (range == 0) {
+        /* Every 32 bits value is within the range */
+        return (int)(uint32_t)(rng_next(pCtx) >> 32);
+    }
+    m =(rng_next(pCtx) >> 32) * range;
+    if ((uint32_t)m < range) {
+        /** Lowest acceptable (low half of the) result */
+        uint32_t threshold;
+
+        threshold = (uint32_t)(-range) % range;
+        while ((uint32_t)m < threshold) {
+            m = (rng_next(pCtx) >> 32) * range;
+        }
+    }
+
+    return (int)((uint32_t)min + (uint32_t)(m >> 32));
+}
+
+/**
+ * Retrieve a number within [0, 1)
+ *
+ * @param  [ in]pCtx The generator
+ * @return           The number
+ */
+float rng_nextFloat(rng *pCtx) {
+    /* Only the top 24 bits fit into the mantissa */
+    return (float)(rng_next(pCtx) >> 40) * (1.0f / 16777216.0f);
+}
+
+/**
+ * Advance the generator by 2^128 numbers
+ *
+ * @param  [ in]pCtx The generator
+ */
+void rng_jump(rng *pCtx) {
+    /** The jump polynomial */
+    static const uint64_t pJump[4] = {
+        0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+        0xa9582618e03fc9aaull, 0x39abdc4529b1661cull
+    };
+    /** The new state */
+    uint64_t s0, s1, s2, s3;
+    /** Iterate through the polynomial */
+    int i, b;
+
+    s0 = 0;
+    s1 = 0;
+    s2 = 0;
+    s3 = 0;
+    i = 0;
+    while (i < 4) {
+        b = 0;
+        while (b < 64) {
+            if (pJump[i] & (1ull << b)) {
+                s0 ^= pCtx->pState[0];
+                s1 ^= pCtx->pState[1];
+                s2 ^= pCtx->pState[2];
+                s3 ^= pCtx->pState[3];
+            }
+            rng_next(pCtx);
+            b++;
+        }
+        i++;
+    }
+
+    pCtx->pState[0] = s0;
+    pCtx->pState[1] = s1;
+    pCtx->pState[2] = s2;
+    pCtx->pState[3] = s3;
+}
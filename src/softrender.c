@@ -0,0 +1,730 @@
+/**
+ * @file src/softrender.c
+ *
+ * In-memory (software) video backend. Rasterizes the draw list into the
+ * V_WIDTH x V_HEIGHT virtual framebuffer, straight from the texture atlas
+ * (color-keyed blits, 4 pixels at a time with SSE, if available), and upscales
+ * it by an integer factor (nearest neighbour). Nothing is ever presented, but
+ * frames may be dumped to disk (e.g., for image diffs)
+ *
+ * Each frame may be rendered as a few regions (e.g., only what changed since
+ * the previous frame): everything is clipped to the current region, and only
+ * that region is cleared and upscaled
+ *
+ * Every pixel is stored as 0x00RRGGBB, so the atlas' transparent pixels are
+ * exactly COLORKEY and are skipped by comparing whole pixels
+ */
+#include <base/drawlist.h>
+#include <base/game_const.h>
+#include <base/softrender.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+/** Number of pixels on the (unscaled) framebuffer */
+#define SOFTRENDER_PIXELS (V_WIDTH * V_HEIGHT)
+
+struct stSoftRender {
+    /** The atlas' pixels */
+    unsigned int *pAtlas;
+    /** The virtual framebuffer */
+    unsigned int *pFrame;
+    /** The upscaled framebuffer (the same as pFrame, if not upscaling) */
+    unsigned int *pScaled;
+    /** Pixels of the last static batch (COLORKEY wherever it's transparent) */
+    unsigned int *pCache;
+    /** Where tiles are currently blitted into (pFrame or pCache) */
+    unsigned int *pTarget;
+    /** Row of a dumped frame, converted to RGB */
+    unsigned char *pDumpRow;
+    /** Tiles of the cached static batch */
+    short *pCachedData;
+    /** Number of tiles on the cached static batch */
+    int cachedNum;
+    /** Spriteset of the cached static batch */
+    int cachedSset;
+    /** Atlas' dimensions */
+    int atlasWidth;
+    int atlasHeight;
+    /** Factor by which the framebuffer is upscaled */
+    int scale;
+    /** Region being rendered (the last row and column are exclusive) */
+    int clipX0;
+    int clipY0;
+    int clipX1;
+    int clipY1;
+};
+
+/**
+ * Read a little-endian value from a buffer
+ *
+ * @param  [ in]pBuf The buffer
+ * @param  [ in]len  Number of bytes in the value
+ * @return           The value
+ */
+static unsigned int softrender_readLE(unsigned char *pBuf, int len) {
+    /** The value */
+    unsigned int val;
+
+    val = 0;
+    while (len > 0) {
+        len--;
+        val = (val << 8) | pBuf[len];
+    }
+
+    return val;
+}
+
+/**
+ * Load the atlas from an uncompressed 24 or 32 bits bitmap (either bottom-up
+ * or top-down)
+ *
+ * @param  [ in]pCtx      The renderer
+ * @param  [ in]pFilename The bitmap
+ * @return                GFraMe return value
+ */
+static gfmRV softrender_loadAtlas(softRender *pCtx, char *pFilename) {
+    /** Bitmap's headers (up to the compression) */
+    unsigned char pHeader[34];
+    /** A row of the bitmap, as stored on the file */
+    unsigned char *pRow;
+    /** The bitmap */
+    FILE *pFile;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Position of the pixels on the file */
+    long offset;
+    /** Bitmap's height (negative, if top-down) */
+    int height;
+    /** Bytes per pixel and per row (padded to 4 bytes) */
+    int bpp, stride;
+    /** Iterate through the pixels */
+    int x, y;
+
+    pRow = 0;
+    pFile = fopen(pFilename, "rb");
+    ASSERT(pFile, GFMRV_COULDNT_OPEN_FILE);
+
+    ASSERT(fread(pHeader, sizeof(pHeader), 1, pFile) == 1, GFMRV_READ_ERROR);
+    ASSERT(pHeader[0] == 'B' && pHeader[1] == 'M', GFMRV_READ_ERROR);
+    offset = (long)softrender_readLE(pHeader + 10, 4);
+    pCtx->atlasWidth = (int)softrender_readLE(pHeader + 18, 4);
+    height = (int)softrender_readLE(pHeader + 22, 4);
+    bpp = (int)softrender_readLE(pHeader + 28, 2) / 8;
+    /* Only BI_RGB is supported */
+    ASSERT(softrender_readLE(pHeader + 30, 4) == 0, GFMRV_READ_ERROR);
+    ASSERT(bpp == 3 || bpp == 4, GFMRV_READ_ERROR);
+    pCtx->atlasHeight = (height < 0) ? -height : height;
+    ASSERT(pCtx->atlasWidth > 0 && pCtx->atlasHeight > 0, GFMRV_READ_ERROR);
+
+    stride = (pCtx->atlasWidth * bpp + 3) & ~3;
+    pRow = (unsigned char*)malloc(stride);
+    ASSERT(pRow, GFMRV_ALLOC_FAILED);
+    pCtx->pAtlas = (unsigned int*)malloc(sizeof(unsigned int) *
+            pCtx->atlasWidth * pCtx->atlasHeight);
+    ASSERT(pCtx->pAtlas, GFMRV_ALLOC_FAILED);
+
+    ASSERT(fseek(pFile, offset, SEEK_SET) == 0, GFMRV_READ_ERROR);
+    y = 0;
+    while (y < pCtx->atlasHeight) {
+        /** Row on the atlas (bottom-up bitmaps start at the last one) */
+        unsigned int *pDst;
+
+        ASSERT(fread(pRow, stride, 1, pFile) == 1, GFMRV_READ_ERROR);
+        if (height > 0) {
+            pDst = pCtx->pAtlas + (pCtx->atlasHeight - 1 - y) *
+                    pCtx->atlasWidth;
+        }
+        else {
+            pDst = pCtx->pAtlas + y * pCtx->atlasWidth;
+        }
+
+        /* Pixels are stored as BGR(A), and the alpha is ignored */
+        x = 0;
+        while (x < pCtx->atlasWidth) {
+            pDst[x] = ((unsigned int)pRow[x * bpp + 2] << 16) |
+                    ((unsigned int)pRow[x * bpp + 1] << 8) |
+                    (unsigned int)pRow[x * bpp];
+            x++;
+        }
+        y++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    free(pRow);
+    if (pFile) {
+        fclose(pFile);
+    }
+
+    return rv;
+}
+
+/**
+ * Release the renderer
+ *
+ * @param  [ in]ppCtx The renderer
+ */
+void softrender_free(softRender **ppCtx) {
+    if (!ppCtx || !*ppCtx) {
+        return;
+    }
+
+    free((*ppCtx)->pAtlas);
+    free((*ppCtx)->pFrame);
+    if ((*ppCtx)->pScaled != (*ppCtx)->pFrame) {
+        free((*ppCtx)->pScaled);
+    }
+    free((*ppCtx)->pCache);
+    free((*ppCtx)->pDumpRow);
+    free(*ppCtx);
+    *ppCtx = 0;
+}
+
+/**
+ * Alloc a new renderer, loading its atlas from a (24 or 32 bits, uncompressed)
+ * bitmap
+ *
+ * @param  [out]ppCtx     The alloc'ed renderer
+ * @param  [ in]pFilename The atlas
+ * @param  [ in]scale     Factor by which every frame is upscaled (within [1,
+ *                        SOFTRENDER_MAX_SCALE])
+ * @return                GFraMe return value
+ */
+gfmRV softrender_getNew(softRender **ppCtx, char *pFilename, int scale) {
+    /** The alloc'ed renderer */
+    softRender *pCtx;
+    /** GFraMe return value */
+    gfmRV rv;
+
+    /* Sanitize arguments */
+    ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pFilename, GFMRV_ARGUMENTS_BAD);
+    ASSERT(scale >= 1 && scale <= SOFTRENDER_MAX_SCALE, GFMRV_ARGUMENTS_BAD);
+
+    pCtx = (softRender*)malloc(sizeof(softRender));
+    ASSERT(pCtx, GFMRV_ALLOC_FAILED);
+    memset(pCtx, 0x0, sizeof(softRender));
+    pCtx->scale = scale;
+
+    rv = softrender_loadAtlas(pCtx, pFilename);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    pCtx->pFrame = (unsigned int*)malloc(sizeof(unsigned int) *
+            SOFTRENDER_PIXELS);
+    ASSERT(pCtx->pFrame, GFMRV_ALLOC_FAILED);
+    pCtx->pCache = (unsigned int*)malloc(sizeof(unsigned int) *
+            SOFTRENDER_PIXELS);
+    ASSERT(pCtx->pCache, GFMRV_ALLOC_FAILED);
+    if (scale > 1) {
+        pCtx->pScaled = (unsigned int*)malloc(sizeof(unsigned int) *
+                SOFTRENDER_PIXELS * scale * scale);
+        ASSERT(pCtx->pScaled, GFMRV_ALLOC_FAILED);
+    }
+    else {
+        pCtx->pScaled = pCtx->pFrame;
+    }
+    pCtx->pDumpRow = (unsigned char*)malloc(V_WIDTH * scale * 3);
+    ASSERT(pCtx->pDumpRow, GFMRV_ALLOC_FAILED);
+
+    memset(pCtx->pFrame, 0x0, sizeof(unsigned int) * SOFTRENDER_PIXELS);
+    pCtx->pTarget = pCtx->pFrame;
+    pCtx->clipX1 = V_WIDTH;
+    pCtx->clipY1 = V_HEIGHT;
+    softrender_clearCache(pCtx);
+
+    *ppCtx = pCtx;
+    rv = GFMRV_OK;
+__ret:
+    if (rv != GFMRV_OK) {
+        softrender_free(&pCtx);
+    }
+
+    return rv;
+}
+
+/**
+ * Forget every cached static batch (e.g., because the level that owned them
+ * was released)
+ *
+ * @param  [ in]pCtx The renderer
+ */
+void softrender_clearCache(softRender *pCtx) {
+    pCtx->pCachedData = 0;
+    pCtx->cachedNum = 0;
+    pCtx->cachedSset = -1;
+}
+
+/**
+ * Start rendering a region of the frame, clearing it to the background color;
+ * Everything is clipped to the region until it's finished
+ *
+ * @param  [ in]pCtx   The renderer
+ * @param  [ in]x      The region's horizontal position
+ * @param  [ in]y      The region's vertical position
+ * @param  [ in]width  The region's width
+ * @param  [ in]height The region's height
+ */
+void softrender_begin(softRender *pCtx, int x, int y, int width, int height) {
+    /** Iterate through the pixels */
+    int i, j;
+
+    pCtx->clipX0 = (x < 0) ? 0 : x;
+    pCtx->clipY0 = (y < 0) ? 0 : y;
+    pCtx->clipX1 = (x + width > V_WIDTH) ? V_WIDTH : x + width;
+    pCtx->clipY1 = (y + height > V_HEIGHT) ? V_HEIGHT : y + height;
+
+    j = pCtx->clipY0;
+    while (j < pCtx->clipY1) {
+        i = pCtx->clipX0;
+        while (i < pCtx->clipX1) {
+            pCtx->pFrame[j * V_WIDTH + i] = BG_COLOR & 0xFFFFFF;
+            i++;
+        }
+        j++;
+    }
+}
+
+/**
+ * Copy every pixel that isn't COLORKEY
+ *
+ * @param  [ in]pDst The destination
+ * @param  [ in]pSrc The source
+ * @param  [ in]len  Number of pixels
+ */
+static void softrender_blitRow(unsigned int *pDst, const unsigned int *pSrc,
+        int len) {
+    /** Iterate through the pixels */
+    int i;
+
+    i = 0;
+#if defined(__SSE2__)
+    {
+        /** The transparent color */
+        __m128i key;
+
+        key = _mm_set1_epi32(COLORKEY);
+        while (i + 4 <= len) {
+            /** Source and destination pixels */
+            __m128i src, dst;
+            /** Which source pixels are transparent */
+            __m128i mask;
+
+            src = _mm_loadu_si128((const __m128i*)(pSrc + i));
+            dst = _mm_loadu_si128((const __m128i*)(pDst + i));
+            mask = _mm_cmpeq_epi32(src, key);
+            dst = _mm_or_si128(_mm_and_si128(mask, dst),
+                    _mm_andnot_si128(mask, src));
+            _mm_storeu_si128((__m128i*)(pDst + i), dst);
+            i += 4;
+        }
+    }
+#endif
+    while (i < len) {
+        if (pSrc[i] != COLORKEY) {
+            pDst[i] = pSrc[i];
+        }
+        i++;
+    }
+}
+
+/**
+ * Copy every pixel that isn't COLORKEY, reading the source backwards
+ *
+ * @param  [ in]pDst The destination
+ * @param  [ in]pSrc The source's last pixel (i.e., the first one copied)
+ * @param  [ in]len  Number of pixels
+ */
+static void softrender_blitRowFlipped(unsigned int *pDst,
+        const unsigned int *pSrc, int len) {
+    /** Iterate through the pixels */
+    int i;
+
+    i = 0;
+#if defined(__SSE2__)
+    {
+        /** The transparent color */
+        __m128i key;
+
+        key = _mm_set1_epi32(COLORKEY);
+        while (i + 4 <= len) {
+            /** Source and destination pixels */
+            __m128i src, dst;
+            /** Which source pixels are transparent */
+            __m128i mask;
+
+            src = _mm_loadu_si128((const __m128i*)(pSrc - i - 3));
+            src = _mm_shuffle_epi32(src, _MM_SHUFFLE(0, 1, 2, 3));
+            dst = _mm_loadu_si128((const __m128i*)(pDst + i));
+            mask = _mm_cmpeq_epi32(src, key);
+            dst = _mm_or_si128(_mm_and_si128(mask, dst),
+                    _mm_andnot_si128(mask, src));
+            _mm_storeu_si128((__m128i*)(pDst + i), dst);
+            i += 4;
+        }
+    }
+#endif
+    while (i < len) {
+        if (pSrc[-i] != COLORKEY) {
+            pDst[i] = pSrc[-i];
+        }
+        i++;
+    }
+}
+
+/**
+ * Blit a single tile (clipped to the current region)
+ *
+ * @param  [ in]pCtx      The renderer
+ * @param  [ in]sset      The tile's spriteset
+ * @param  [ in]x         The tile's horizontal position
+ * @param  [ in]y         The tile's vertical position
+ * @param  [ in]tile      The tile
+ * @param  [ in]isFlipped Whether the tile is horizontally flipped
+ * @return                GFraMe return value
+ */
+gfmRV softrender_drawTile(softRender *pCtx, spritesetId sset, int x, int y,
+        int tile, int isFlipped) {
+    /** First pixel of the tile on the atlas */
+    unsigned int *pSrc;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Tile's dimensions, in pixels */
+    int size;
+    /** Number of tiles on each row of the atlas */
+    int tilesPerRow;
+    /** Visible area of the tile, on the framebuffer */
+    int x0, y0, x1, y1;
+
+    ASSERT(sset >= SSET_2x2 && sset < SSET_MAX, GFMRV_ARGUMENTS_BAD);
+    size = SSET_TILE_SIZE(sset);
+    tilesPerRow = pCtx->atlasWidth / size;
+    ASSERT(tile >= 0 && tile < tilesPerRow * (pCtx->atlasHeight / size),
+            GFMRV_INVALID_INDEX);
+
+    /* Clip the tile to the current region */
+    x0 = (x < pCtx->clipX0) ? pCtx->clipX0 : x;
+    y0 = (y < pCtx->clipY0) ? pCtx->clipY0 : y;
+    x1 = (x + size > pCtx->clipX1) ? pCtx->clipX1 : x + size;
+    y1 = (y + size > pCtx->clipY1) ? pCtx->clipY1 : y + size;
+    if (x0 >= x1 || y0 >= y1) {
+        rv = GFMRV_OK;
+        goto __ret;
+    }
+
+    pSrc = pCtx->pAtlas + (tile / tilesPerRow) * size * pCtx->atlasWidth +
+            (tile % tilesPerRow) * size;
+    pSrc += (y0 - y) * pCtx->atlasWidth;
+    if (isFlipped) {
+        /* The leftmost visible pixel comes from the opposite side */
+        pSrc += size - 1 - (x0 - x);
+    }
+    else {
+        pSrc += x0 - x;
+    }
+
+    while (y0 < y1) {
+        if (isFlipped) {
+            softrender_blitRowFlipped(pCtx->pTarget + y0 * V_WIDTH + x0, pSrc,
+                    x1 - x0);
+        }
+        else {
+            softrender_blitRow(pCtx->pTarget + y0 * V_WIDTH + x0, pSrc,
+                    x1 - x0);
+        }
+        pSrc += pCtx->atlasWidth;
+        y0++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Blit a number (each digit uses the atlas' ASCII glyphs, which start at tile 0
+ * for ' '), padded with zeros to numDigits digits
+ *
+ * @param  [ in]pCtx      The renderer
+ * @param  [ in]sset      The digits' spriteset
+ * @param  [ in]x         The number's horizontal position
+ * @param  [ in]y         The number's vertical position
+ * @param  [ in]num       The number
+ * @param  [ in]numDigits How many digits should be rendered
+ * @return                GFraMe return value
+ */
+gfmRV softrender_drawNumber(softRender *pCtx, spritesetId sset, int x, int y,
+        int num, int numDigits) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The number, without its sign */
+    unsigned int val;
+    /** Iterate through the digits (from the last one) */
+    int i;
+
+    ASSERT(sset >= SSET_2x2 && sset < SSET_MAX, GFMRV_ARGUMENTS_BAD);
+
+    val = (num < 0) ? -(unsigned int)num : (unsigned int)num;
+    i = numDigits - 1;
+    while (i >= 0) {
+        rv = softrender_drawTile(pCtx, sset, x + i * SSET_TILE_SIZE(sset), y,
+                '0' - ' ' + (int)(val % 10), 0/*isFlipped*/);
+        ASSERT(rv == GFMRV_OK, rv);
+        val /= 10;
+        i--;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Blit a static batch of tiles. It's rasterized only the first time it's seen
+ * (into a cached layer), and the cached pixels are blitted from then on
+ *
+ * @param  [ in]pCtx  The renderer
+ * @param  [ in]sset  The tiles' spriteset
+ * @param  [ in]pData The tiles, as planes (every horizontal position, every
+ *                    vertical position and then every tile)
+ * @param  [ in]num   How many tiles there are in the batch
+ * @return            GFraMe return value
+ */
+gfmRV softrender_drawStatic(softRender *pCtx, spritesetId sset, short *pData,
+        int num) {
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the rows */
+    int y;
+
+    ASSERT(pData, GFMRV_ARGUMENTS_BAD);
+
+    /* Only the last static batch is kept (there's usually a single one, the
+     * background) */
+    if (pData != pCtx->pCachedData || num != pCtx->cachedNum ||
+            (int)sset != pCtx->cachedSset) {
+        /** The current region */
+        int clipX0, clipY0, clipX1, clipY1;
+        /** Iterate through the pixels and tiles */
+        int i;
+
+        i = 0;
+        while (i < SOFTRENDER_PIXELS) {
+            pCtx->pCache[i] = COLORKEY;
+            i++;
+        }
+
+        /* The whole batch is cached, regardless of the current region */
+        clipX0 = pCtx->clipX0;
+        clipY0 = pCtx->clipY0;
+        clipX1 = pCtx->clipX1;
+        clipY1 = pCtx->clipY1;
+        pCtx->clipX0 = 0;
+        pCtx->clipY0 = 0;
+        pCtx->clipX1 = V_WIDTH;
+        pCtx->clipY1 = V_HEIGHT;
+        pCtx->pTarget = pCtx->pCache;
+        rv = GFMRV_OK;
+        i = 0;
+        while (i < num) {
+            rv = softrender_drawTile(pCtx, sset, pData[i], pData[num + i],
+                    pData[2 * num + i], 0/*isFlipped*/);
+            if (rv != GFMRV_OK) {
+                break;
+            }
+            i++;
+        }
+        pCtx->pTarget = pCtx->pFrame;
+        pCtx->clipX0 = clipX0;
+        pCtx->clipY0 = clipY0;
+        pCtx->clipX1 = clipX1;
+        pCtx->clipY1 = clipY1;
+        ASSERT(rv == GFMRV_OK, rv);
+
+        pCtx->pCachedData = pData;
+        pCtx->cachedNum = num;
+        pCtx->cachedSset = (int)sset;
+    }
+
+    /* The cache has the same layout as the framebuffer */
+    y = pCtx->clipY0;
+    while (y < pCtx->clipY1) {
+        softrender_blitRow(pCtx->pFrame + y * V_WIDTH + pCtx->clipX0,
+                pCtx->pCache + y * V_WIDTH + pCtx->clipX0,
+                pCtx->clipX1 - pCtx->clipX0);
+        y++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Finish rendering the current region, upscaling it
+ *
+ * @param  [ in]pCtx The renderer
+ */
+void softrender_end(softRender *pCtx) {
+    /** Upscaled row's width */
+    int width;
+    /** Iterate through the rows and pixels */
+    int x, y;
+    /** Factor by which the framebuffer is upscaled */
+    int scale;
+
+    scale = pCtx->scale;
+    if (scale == 1) {
+        return;
+    }
+
+    width = V_WIDTH * scale;
+    y = pCtx->clipY0;
+    while (y < pCtx->clipY1) {
+        /** The source row */
+        unsigned int *pSrc;
+        /** The first upscaled row */
+        unsigned int *pDst;
+        /** Iterate through the copies of the row */
+        int i;
+
+        pSrc = pCtx->pFrame + y * V_WIDTH;
+        pDst = pCtx->pScaled + y * scale * width;
+
+        x = pCtx->clipX0;
+#if defined(__SSE2__)
+        if (scale == 2) {
+            /* Duplicate every pixel of a group of 4 */
+            while (x + 4 <= pCtx->clipX1) {
+                /** The source pixels */
+                __m128i src;
+
+                src = _mm_loadu_si128((const __m128i*)(pSrc + x));
+                _mm_storeu_si128((__m128i*)(pDst + x * 2),
+                        _mm_unpacklo_epi32(src, src));
+                _mm_storeu_si128((__m128i*)(pDst + x * 2 + 4),
+                        _mm_unpackhi_epi32(src, src));
+                x += 4;
+            }
+        }
+        else if (scale >= 4) {
+            /* Broadcast each pixel 4 at a time (the last store may overlap
+             * the previous one, but never the next pixel) */
+            while (x < pCtx->clipX1) {
+                /** The broadcast pixel */
+                __m128i px;
+                /** Iterate through the copies of the pixel */
+                int j;
+
+                px = _mm_set1_epi32((int)pSrc[x]);
+                j = 0;
+                while (j + 4 < scale) {
+                    _mm_storeu_si128((__m128i*)(pDst + x * scale + j), px);
+                    j += 4;
+                }
+                _mm_storeu_si128((__m128i*)(pDst + x * scale + scale - 4),
+                        px);
+                x++;
+            }
+        }
+#endif
+        while (x < pCtx->clipX1) {
+            /** Iterate through the copies of the pixel */
+            int j;
+
+            j = 0;
+            while (j < scale) {
+                pDst[x * scale + j] = pSrc[x];
+                j++;
+            }
+            x++;
+        }
+
+        /* Replicate the expanded row */
+        pDst += pCtx->clipX0 * scale;
+        i = 1;
+        while (i < scale) {
+            memcpy(pDst + i * width, pDst, sizeof(unsigned int) *
+                    (pCtx->clipX1 - pCtx->clipX0) * scale);
+            i++;
+        }
+        y++;
+    }
+}
+
+/**
+ * Retrieve the last finished (upscaled) frame
+ *
+ * @param  [out]ppPixels The frame's pixels, in 0x00RRGGBB format
+ * @param  [out]pWidth   The frame's width
+ * @param  [out]pHeight  The frame's height
+ * @param  [ in]pCtx     The renderer
+ */
+void softrender_getFrame(unsigned int **ppPixels, int *pWidth, int *pHeight,
+        softRender *pCtx) {
+    *ppPixels = pCtx->pScaled;
+    *pWidth = V_WIDTH * pCtx->scale;
+    *pHeight = V_HEIGHT * pCtx->scale;
+}
+
+/**
+ * Write the last finished (upscaled) frame into a binary PPM (P6) image
+ *
+ * @param  [ in]pCtx      The renderer
+ * @param  [ in]pFilename The image
+ * @return                GFraMe return value
+ */
+gfmRV softrender_dumpFrame(softRender *pCtx, char *pFilename) {
+    /** The image */
+    FILE *pFile;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Frame's dimensions */
+    int width, height;
+    /** Iterate through the pixels */
+    int x, y;
+
+    pFile = 0;
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pFilename, GFMRV_ARGUMENTS_BAD);
+
+    pFile = fopen(pFilename, "wb");
+    ASSERT(pFile, GFMRV_COULDNT_OPEN_FILE);
+
+    width = V_WIDTH * pCtx->scale;
+    height = V_HEIGHT * pCtx->scale;
+    fprintf(pFile, "P6\n%d %d\n255\n", width, height);
+    y = 0;
+    while (y < height) {
+        /** The row being written */
+        unsigned int *pSrc;
+
+        pSrc = pCtx->pScaled + y * width;
+        x = 0;
+        while (x < width) {
+            pCtx->pDumpRow[x * 3] = (unsigned char)(pSrc[x] >> 16);
+            pCtx->pDumpRow[x * 3 + 1] = (unsigned char)(pSrc[x] >> 8);
+            pCtx->pDumpRow[x * 3 + 2] = (unsigned char)pSrc[x];
+            x++;
+        }
+        ASSERT(fwrite(pCtx->pDumpRow, width * 3, 1, pFile) == 1,
+                GFMRV_INTERNAL_ERROR);
+        y++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    if (pFile) {
+        fclose(pFile);
+    }
+
+    return rv;
+}
@@ -0,0 +1,289 @@
+/**
+ * @file src/staticmap.c
+ *
+ * Tilemap whose static tiles are baked (once) into a static batch, so only the
+ * few animated ones are recorded every frame
+ *
+ * A tile is considered animated if it's any frame of any of the tilemap's
+ * animations; Since animations only ever switch between their frames, every
+ * other tile stays the same for as long as the tilemap is loaded
+ */
+#include <base/arena.h>
+#include <base/drawlist.h>
+#include <base/game_const.h>
+#include <base/game_ctx.h>
+#include <base/staticmap.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+#include <GFraMe/gfmTilemap.h>
+
+struct stStaticMap {
+    /** The tilemap (from which the animated tiles are read) */
+    gfmTilemap *pTMap;
+    /** Baked tiles, as planes (horizontal positions, vertical positions and
+     * tiles) */
+    short *pStatic;
+    /** Animated tiles' horizontal position */
+    short *pAnimX;
+    /** Animated tiles' vertical position */
+    short *pAnimY;
+    /** Animated tiles' index on the tilemap's data */
+    int *pAnimIdx;
+    /** Number of baked tiles */
+    int numStatic;
+    /** Number of animated tiles */
+    int numAnimated;
+    /** The tilemap's spriteset */
+    spritesetId sset;
+};
+
+/**
+ * Check whether a tile is a frame of any animation
+ *
+ * @param  [ in]tile      The tile
+ * @param  [ in]pAnimData The animations
+ * @param  [ in]animLen   Number of integers in pAnimData
+ * @return                GFMRV_TRUE, GFMRV_FALSE
+ */
+static gfmRV staticmap_isAnimated(int tile, int *pAnimData, int animLen) {
+    /** Iterate through the animations */
+    int i;
+
+    i = 0;
+    while (i < animLen) {
+        /** Number of frames in the current animation */
+        int len;
+        /** Iterate through the frames */
+        int j;
+
+        /* Skip the header (len, fps and loop) */
+        len = pAnimData[i];
+        j = 0;
+        while (j < len) {
+            if (pAnimData[i + 3 + j] == tile) {
+                return GFMRV_TRUE;
+            }
+            j++;
+        }
+        i += 3 + len;
+    }
+
+    return GFMRV_FALSE;
+}
+
+/** How a tile is handled */
+enum enStaticTile {
+    /** Empty (negative) or off the screen */
+    ST_SKIP = 0,
+    /** Baked */
+    ST_STATIC,
+    /** Recorded every frame */
+    ST_ANIMATED
+};
+
+/**
+ * Classify a tile
+ *
+ * @param  [ in]tile      The tile
+ * @param  [ in]x         The tile's horizontal position
+ * @param  [ in]y         The tile's vertical position
+ * @param  [ in]size      The tile's dimensions
+ * @param  [ in]pAnimData The animations
+ * @param  [ in]animLen   Number of integers in pAnimData
+ * @return                How the tile is handled
+ */
+static enum enStaticTile staticmap_classify(int tile, int x, int y, int size,
+        int *pAnimData, int animLen) {
+    if (tile < 0 || x <= -size || x >= V_WIDTH || y <= -size ||
+            y >= V_HEIGHT) {
+        return ST_SKIP;
+    }
+    else if (staticmap_isAnimated(tile, pAnimData, animLen) == GFMRV_TRUE) {
+        return ST_ANIMATED;
+    }
+    return ST_STATIC;
+}
+
+/**
+ * Release the static map (it belongs to the level arena, so this only clears
+ * the reference)
+ *
+ * @param  [ in]ppCtx The static map
+ */
+void staticmap_free(staticMap **ppCtx) {
+    if (!ppCtx) {
+        return;
+    }
+
+    *ppCtx = 0;
+}
+
+/**
+ * Alloc a new static map from the level arena
+ *
+ * @param  [out]ppCtx The alloc'ed static map
+ * @return            GFraMe return value
+ */
+gfmRV staticmap_getNew(staticMap **ppCtx) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
+
+    rv = arena_alloc((void**)ppCtx, &(pGlobal->levelArena), sizeof(staticMap));
+    ASSERT(rv == GFMRV_OK, rv);
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Bake every visible tile that's never animated; The tilemap must be kept
+ * alive, as the animated tiles are read from it when drawing
+ *
+ * @param  [ in]pCtx      The static map
+ * @param  [ in]pTMap     The tilemap
+ * @param  [ in]sset      The tilemap's spriteset
+ * @param  [ in]x         The tilemap's horizontal position
+ * @param  [ in]y         The tilemap's vertical position
+ * @param  [ in]pAnimData The tilemap's animations (on the same format as
+ *                        gfmTilemap_addAnimations)
+ * @param  [ in]animLen   Number of integers in pAnimData
+ * @return                GFraMe return value
+ */
+gfmRV staticmap_init(staticMap *pCtx, gfmTilemap *pTMap, spritesetId sset,
+        int x, int y, int *pAnimData, int animLen) {
+    /** Tilemap's tiles */
+    int *pData;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Tilemap's dimensions, in tiles */
+    int width, height;
+    /** Tile's dimensions, in pixels */
+    int size;
+    /** Iterate through the tiles */
+    int i;
+    /** Number of tiles stored so far */
+    int numStatic, numAnimated;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pTMap, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pAnimData || animLen == 0, GFMRV_ARGUMENTS_BAD);
+
+    size = SSET_TILE_SIZE(sset);
+    rv = gfmTilemap_getDimension(&width, &height, pTMap);
+    ASSERT(rv == GFMRV_OK, rv);
+    width /= size;
+    height /= size;
+    rv = gfmTilemap_getData(&pData, pTMap);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    pCtx->pTMap = pTMap;
+    pCtx->sset = sset;
+
+/** Classify the i-th tile */
+#define CLASSIFY(i) \
+    staticmap_classify(pData[i], x + ((i) % width) * size, \
+            y + ((i) / width) * size, size, pAnimData, animLen)
+
+    /* Count the tiles, so exactly as much as needed is alloc'ed */
+    pCtx->numStatic = 0;
+    pCtx->numAnimated = 0;
+    i = 0;
+    while (i < width * height) {
+        switch (CLASSIFY(i)) {
+            case ST_STATIC: pCtx->numStatic++; break;
+            case ST_ANIMATED: pCtx->numAnimated++; break;
+            default: {}
+        }
+        i++;
+    }
+
+    rv = arena_alloc((void**)&(pCtx->pStatic), &(pGlobal->levelArena),
+            sizeof(short) * 3 * pCtx->numStatic);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = arena_alloc((void**)&(pCtx->pAnimX), &(pGlobal->levelArena),
+            sizeof(short) * pCtx->numAnimated);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = arena_alloc((void**)&(pCtx->pAnimY), &(pGlobal->levelArena),
+            sizeof(short) * pCtx->numAnimated);
+    ASSERT(rv == GFMRV_OK, rv);
+    rv = arena_alloc((void**)&(pCtx->pAnimIdx), &(pGlobal->levelArena),
+            sizeof(int) * pCtx->numAnimated);
+    ASSERT(rv == GFMRV_OK, rv);
+
+    /* Bake the static tiles (as planes) and store where the animated are */
+    numStatic = 0;
+    numAnimated = 0;
+    i = 0;
+    while (i < width * height) {
+        /** The tile's position */
+        short tx, ty;
+
+        tx = (short)(x + (i % width) * size);
+        ty = (short)(y + (i / width) * size);
+        switch (CLASSIFY(i)) {
+            case ST_STATIC: {
+                pCtx->pStatic[numStatic] = tx;
+                pCtx->pStatic[pCtx->numStatic + numStatic] = ty;
+                pCtx->pStatic[2 * pCtx->numStatic + numStatic] =
+                        (short)pData[i];
+                numStatic++;
+            } break;
+            case ST_ANIMATED: {
+                pCtx->pAnimX[numAnimated] = tx;
+                pCtx->pAnimY[numAnimated] = ty;
+                pCtx->pAnimIdx[numAnimated] = i;
+                numAnimated++;
+            } break;
+            default: {}
+        }
+        i++;
+    }
+
+#undef CLASSIFY
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Record the baked tiles (as a single static batch) and the current frame of
+ * every animated tile
+ *
+ * @param  [ in]pCtx The static map
+ * @return           GFraMe return value
+ */
+gfmRV staticmap_draw(staticMap *pCtx) {
+    /** Tilemap's tiles */
+    int *pData;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Iterate through the animated tiles */
+    int i;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+
+    if (pCtx->numStatic > 0) {
+        rv = drawlist_pushStatic(pGlobal->pDrawList, pCtx->sset,
+                pCtx->pStatic, pCtx->numStatic);
+        ASSERT(rv == GFMRV_OK, rv);
+    }
+
+    rv = gfmTilemap_getData(&pData, pCtx->pTMap);
+    ASSERT(rv == GFMRV_OK, rv);
+    i = 0;
+    while (i < pCtx->numAnimated) {
+        rv = drawlist_pushTile(pGlobal->pDrawList, pCtx->sset, pCtx->pAnimX[i],
+                pCtx->pAnimY[i], pData[pCtx->pAnimIdx[i]], 0/*isFlipped*/);
+        ASSERT(rv == GFMRV_OK, rv);
+        i++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
@@ -0,0 +1,689 @@
+/**
+ * @file src/templates.c
+ *
+ * Template-matching gesture engine (in the style of the $1 recognizer). Every
+ * template is resampled into a fixed number of points, translated to its
+ * centroid and uniformly scaled (and optionally rotated to its indicative
+ * angle) once, when it's added. Strokes are normalized the same way and scored
+ * against every template by their mean squared distance
+ *
+ * Since the pointer may keep on gesturing for as long as it wants (e.g.,
+ * spinning many times), a stroke is also tried from a few points along its
+ * path, so only its most recent part has to match a template
+ *
+ * The recognized gestures are gameplay state (they judge the recipe), so
+ * everything is computed in fixed point: the same stroke is classified the
+ * same way regardless of the compiler, the libm or the instruction set
+ */
+#include <base/arena.h>
+#include <base/game_ctx.h>
+
+#include <GFraMe/gfmAssert.h>
+#include <GFraMe/gfmError.h>
+
+#include <ggj16/templates.h>
+#include <ggj16/type.h>
+
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+/** Number of points along the stroke from which it's tried */
+#define TEMPLATES_WINDOWS     16
+/** Fractional bits of a position before it's normalized (i.e., 1/16 pixel) */
+#define TEMPLATES_SUBPIXEL    4
+/** Shortest (part of a) stroke that is classified, in pixels */
+#define TEMPLATES_MIN_LENGTH  (24 << TEMPLATES_SUBPIXEL)
+/** Smallest (part of a) stroke that is classified, in pixels (so the pointer
+ * shaking a little isn't mistaken for a tiny gesture) */
+#define TEMPLATES_MIN_SIZE    (12 << TEMPLATES_SUBPIXEL)
+/** Size of the unit box into which every path is normalized */
+#define TEMPLATES_UNIT        1024
+/** Largest mean squared distance (after normalizing both into a unit box) at
+ * which a stroke matches a template (i.e., 0.04 units squared) */
+#define TEMPLATES_THRESHOLD   (TEMPLATES_UNIT * TEMPLATES_UNIT / 25)
+
+/** Angles are measured in fixed-point units, so a full turn is a power of two
+ * and wrapping around is simply an integer overflow */
+#define TEMPLATES_TURN    0x10000
+#define TEMPLATES_HALF    (TEMPLATES_TURN / 2)
+#define TEMPLATES_QUARTER (TEMPLATES_TURN / 4)
+/** Number of steps on the trigonometric tables (for ratios within [0, 1] and
+ * for angles within a quarter turn) */
+#define TEMPLATES_TRIG_STEPS 256
+/** Fixed-point one, as on the sine table */
+#define TEMPLATES_ONE     16384
+/** Arctangent of i / TEMPLATES_TRIG_STEPS, in TEMPLATES_TURN units (i.e., the
+ * first octant) */
+static const short pAtanTable[TEMPLATES_TRIG_STEPS + 1] = {
+       0,   41,   81,  122,  163,  204,  244,  285,  326,  367,
+     407,  448,  489,  529,  570,  610,  651,  692,  732,  773,
+     813,  854,  894,  935,  975, 1015, 1056, 1096, 1136, 1177,
+    1217, 1257, 1297, 1337, 1377, 1417, 1457, 1497, 1537, 1577,
+    1617, 1656, 1696, 1736, 1775, 1815, 1854, 1894, 1933, 1973,
+    2012, 2051, 2090, 2129, 2168, 2207, 2246, 2285, 2324, 2363,
+    2401, 2440, 2478, 2517, 2555, 2594, 2632, 2670, 2708, 2746,
+    2784, 2822, 2860, 2897, 2935, 2973, 3010, 3047, 3085, 3122,
+    3159, 3196, 3233, 3270, 3307, 3344, 3380, 3417, 3453, 3490,
+    3526, 3562, 3599, 3635, 3670, 3706, 3742, 3778, 3813, 3849,
+    3884, 3920, 3955, 3990, 4025, 4060, 4095, 4129, 4164, 4199,
+    4233, 4267, 4302, 4336, 4370, 4404, 4438, 4471, 4505, 4539,
+    4572, 4605, 4639, 4672, 4705, 4738, 4771, 4803, 4836, 4869,
+    4901, 4933, 4966, 4998, 5030, 5062, 5094, 5125, 5157, 5188,
+    5220, 5251, 5282, 5313, 5344, 5375, 5406, 5437, 5467, 5498,
+    5528, 5559, 5589, 5619, 5649, 5679, 5708, 5738, 5768, 5797,
+    5826, 5856, 5885, 5914, 5943, 5972, 6000, 6029, 6058, 6086,
+    6114, 6142, 6171, 6199, 6227, 6254, 6282, 6310, 6337, 6365,
+    6392, 6419, 6446, 6473, 6500, 6527, 6554, 6580, 6607, 6633,
+    6660, 6686, 6712, 6738, 6764, 6790, 6815, 6841, 6867, 6892,
+    6917, 6943, 6968, 6993, 7018, 7043, 7068, 7092, 7117, 7141,
+    7166, 7190, 7214, 7238, 7262, 7286, 7310, 7334, 7358, 7381,
+    7405, 7428, 7451, 7475, 7498, 7521, 7544, 7566, 7589, 7612,
+    7635, 7657, 7679, 7702, 7724, 7746, 7768, 7790, 7812, 7834,
+    7856, 7877, 7899, 7920, 7942, 7963, 7984, 8005, 8026, 8047,
+    8068, 8089, 8110, 8131, 8151, 8172, 8192
+};
+/** Sine of (i / TEMPLATES_TRIG_STEPS) quarter turns, in TEMPLATES_ONE units */
+static const short pSinTable[TEMPLATES_TRIG_STEPS + 1] = {
+        0,   101,   201,   302,   402,   503,   603,   704,   804,   904,
+     1005,  1105,  1205,  1306,  1406,  1506,  1606,  1706,  1806,  1906,
+     2006,  2105,  2205,  2305,  2404,  2503,  2603,  2702,  2801,  2900,
+     2999,  3098,  3196,  3295,  3393,  3492,  3590,  3688,  3786,  3883,
+     3981,  4078,  4176,  4273,  4370,  4467,  4563,  4660,  4756,  4852,
+     4948,  5044,  5139,  5235,  5330,  5425,  5520,  5614,  5708,  5803,
+     5897,  5990,  6084,  6177,  6270,  6363,  6455,  6547,  6639,  6731,
+     6823,  6914,  7005,  7096,  7186,  7276,  7366,  7456,  7545,  7635,
+     7723,  7812,  7900,  7988,  8076,  8163,  8250,  8337,  8423,  8509,
+     8595,  8680,  8765,  8850,  8935,  9019,  9102,  9186,  9269,  9352,
+     9434,  9516,  9598,  9679,  9760,  9841,  9921, 10001, 10080, 10159,
+    10238, 10316, 10394, 10471, 10549, 10625, 10702, 10778, 10853, 10928,
+    11003, 11077, 11151, 11224, 11297, 11370, 11442, 11514, 11585, 11656,
+    11727, 11797, 11866, 11935, 12004, 12072, 12140, 12207, 12274, 12340,
+    12406, 12472, 12537, 12601, 12665, 12729, 12792, 12854, 12916, 12978,
+    13039, 13100, 13160, 13219, 13279, 13337, 13395, 13453, 13510, 13567,
+    13623, 13678, 13733, 13788, 13842, 13896, 13949, 14001, 14053, 14104,
+    14155, 14206, 14256, 14305, 14354, 14402, 14449, 14497, 14543, 14589,
+    14635, 14680, 14724, 14768, 14811, 14854, 14896, 14937, 14978, 15019,
+    15059, 15098, 15137, 15175, 15213, 15250, 15286, 15322, 15357, 15392,
+    15426, 15460, 15493, 15525, 15557, 15588, 15619, 15649, 15679, 15707,
+    15736, 15763, 15791, 15817, 15843, 15868, 15893, 15917, 15941, 15964,
+    15986, 16008, 16029, 16049, 16069, 16088, 16107, 16125, 16143, 16160,
+    16176, 16192, 16207, 16221, 16235, 16248, 16261, 16273, 16284, 16295,
+    16305, 16315, 16324, 16332, 16340, 16347, 16353, 16359, 16364, 16369,
+    16373, 16376, 16379, 16381, 16383, 16384, 16384
+};
+
+/** A normalized template */
+struct stTemplate {
+    /** Every point, as interleaved positions within the unit box */
+    short pPoints[TEMPLATES_POINTS * 2];
+    /** Item recognized by the template */
+    itemType type;
+    /** TEMPLATES_ANY_ROTATION, or 0 */
+    int flags;
+};
+
+struct stTemplateSet {
+    /** Every template */
+    struct stTemplate pTemplates[TEMPLATES_MAX];
+    /** Number of templates */
+    int num;
+};
+
+/**
+ * Release the template set (it belongs to the level arena, so this only clears
+ * the reference)
+ *
+ * @param  [ in]ppCtx The template set
+ */
+void templates_free(templateSet **ppCtx) {
+    if (!ppCtx) {
+        return;
+    }
+
+    *ppCtx = 0;
+}
+
+/**
+ * Alloc a new (empty) template set from the level arena
+ *
+ * @param  [out]ppCtx The alloc'ed template set
+ * @return            GFraMe return value
+ */
+gfmRV templates_getNew(templateSet **ppCtx) {
+    /** GFraMe return value */
+    gfmRV rv;
+
+    ASSERT(ppCtx, GFMRV_ARGUMENTS_BAD);
+
+    rv = arena_alloc((void**)ppCtx, &(pGlobal->levelArena),
+            sizeof(templateSet));
+    ASSERT(rv == GFMRV_OK, rv);
+    (*ppCtx)->num = 0;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Calculate the (rounded down) square root of an integer
+ *
+ * @param  [ in]val The integer
+ * @return          The square root
+ */
+static int templates_sqrt(uint64_t val) {
+    /** The current bit of the result and the result */
+    uint64_t bit, res;
+
+    res = 0;
+    bit = (uint64_t)1 << 62;
+    while (bit > val) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (val >= res + bit) {
+            val -= res + bit;
+            res = (res >> 1) + bit;
+        }
+        else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (int)res;
+}
+
+/**
+ * Calculate the angle of a position around the origin. The arctangent is
+ * looked up on the first octant, and then mirrored into the position's octant
+ *
+ * @param  [ in]x The horizontal position
+ * @param  [ in]y The vertical position
+ * @return        The angle, in TEMPLATES_TURN units (from the horizontal axis
+ *                towards the vertical one)
+ */
+static unsigned short templates_getAngle(int x, int y) {
+    /** Absolute positions */
+    int absX, absY;
+    /** The smallest and the largest distance */
+    int num, den;
+    /** Whether the position is closer to the vertical axis */
+    int isSteep;
+    /** The angle */
+    int ang;
+
+    absX = (x < 0) ? -x : x;
+    absY = (y < 0) ? -y : y;
+
+    /* Reduce it to the first octant (i.e., a ratio within [0, 1]) */
+    isSteep = absY > absX;
+    num = isSteep ? absX : absY;
+    den = isSteep ? absY : absX;
+    /* The origin itself is arbitrarily at 0 */
+    den += (den == 0);
+    ang = pAtanTable[((int64_t)num * TEMPLATES_TRIG_STEPS + den / 2) / den];
+
+    /* Mirror it back into the position's octant */
+    ang = isSteep ? TEMPLATES_QUARTER - ang : ang;
+    ang = (x < 0) ? TEMPLATES_HALF - ang : ang;
+    ang = (y < 0) ? -ang : ang;
+
+    return (unsigned short)ang;
+}
+
+/**
+ * Look up the sine of an angle (on the closest step of the table)
+ *
+ * @param  [ in]ang The angle, in TEMPLATES_TURN units
+ * @return          The sine, in TEMPLATES_ONE units
+ */
+static int templates_getSin(unsigned short ang) {
+    /** Step within the angle's quarter turn */
+    int step;
+
+    step = ((ang % TEMPLATES_QUARTER) * TEMPLATES_TRIG_STEPS +
+            TEMPLATES_QUARTER / 2) / TEMPLATES_QUARTER;
+    switch (ang / TEMPLATES_QUARTER) {
+        case 0: return pSinTable[step];
+        case 1: return pSinTable[TEMPLATES_TRIG_STEPS - step];
+        case 2: return -pSinTable[step];
+        default: return -pSinTable[TEMPLATES_TRIG_STEPS - step];
+    }
+}
+
+/**
+ * Calculate the length of every segment of a path
+ *
+ * @param  [out]pSeg    Length of the segment that ends on each point (0 for
+ *                      the first one), in sub-pixels
+ * @param  [ in]pPoints The path, as interleaved positions
+ * @param  [ in]num     Number of points in the path
+ * @return              The path's length, in sub-pixels
+ */
+static int templates_getSegments(int *pSeg, const short *pPoints, int num) {
+    /** The path's length */
+    int length;
+    /** Iterate through the path */
+    int i;
+
+    pSeg[0] = 0;
+    length = 0;
+    i = 1;
+    while (i < num) {
+        /** Distance on each axis */
+        int64_t dx, dy;
+
+        dx = pPoints[i * 2] - pPoints[(i - 1) * 2];
+        dy = pPoints[i * 2 + 1] - pPoints[(i - 1) * 2 + 1];
+        pSeg[i] = templates_sqrt((uint64_t)(dx * dx + dy * dy) <<
+                (TEMPLATES_SUBPIXEL * 2));
+        length += pSeg[i];
+        i++;
+    }
+
+    return length;
+}
+
+/**
+ * Resample a path into TEMPLATES_POINTS points, evenly spaced along it
+ *
+ * @param  [out]pX      Horizontal position of every point, in sub-pixels
+ * @param  [out]pY      Vertical position of every point, in sub-pixels
+ * @param  [ in]pPoints The path, as interleaved positions
+ * @param  [ in]pSeg    Length of every segment of the path
+ * @param  [ in]num     Number of points in the path
+ * @param  [ in]length  The path's length (at least TEMPLATES_POINTS - 1)
+ */
+static void templates_resample(int *pX, int *pY, const short *pPoints,
+        const int *pSeg, int num, int length) {
+    /** Distance between resampled points */
+    int step;
+    /** Distance since the last resampled point */
+    int acc;
+    /** Number of resampled points */
+    int count;
+    /** Iterate through the path */
+    int i;
+
+    step = length / (TEMPLATES_POINTS - 1);
+    pX[0] = pPoints[0] << TEMPLATES_SUBPIXEL;
+    pY[0] = pPoints[1] << TEMPLATES_SUBPIXEL;
+    count = 1;
+    acc = 0;
+    i = 1;
+    while (i < num && count < TEMPLATES_POINTS) {
+        if (pSeg[i] > 0 && acc + pSeg[i] >= step) {
+            /** Segment's first point and direction */
+            int x, y, dx, dy;
+            /** Distance of the next resampled point into the segment */
+            int t;
+
+            x = pPoints[(i - 1) * 2] << TEMPLATES_SUBPIXEL;
+            y = pPoints[(i - 1) * 2 + 1] << TEMPLATES_SUBPIXEL;
+            dx = (pPoints[i * 2] << TEMPLATES_SUBPIXEL) - x;
+            dy = (pPoints[i * 2 + 1] << TEMPLATES_SUBPIXEL) - y;
+            /* Split the segment as many times as needed */
+            t = step - acc;
+            while (t <= pSeg[i] && count < TEMPLATES_POINTS) {
+                pX[count] = x + (int)((int64_t)dx * t / pSeg[i]);
+                pY[count] = y + (int)((int64_t)dy * t / pSeg[i]);
+                count++;
+                t += step;
+            }
+            acc = pSeg[i] - (t - step);
+        }
+        else {
+            acc += pSeg[i];
+        }
+        i++;
+    }
+    /* Rounding errors may leave the last few points out */
+    while (count < TEMPLATES_POINTS) {
+        pX[count] = pPoints[(num - 1) * 2] << TEMPLATES_SUBPIXEL;
+        pY[count] = pPoints[(num - 1) * 2 + 1] << TEMPLATES_SUBPIXEL;
+        count++;
+    }
+}
+
+/**
+ * Normalize a resampled path: translate it to its centroid, rotate it to its
+ * indicative angle (i.e., so its first point is on the right of the centroid,
+ * if requested) and scale it uniformly into a unit box
+ *
+ * @param  [out]pPoints The normalized path, as interleaved positions within
+ *                      the unit box
+ * @param  [ in]pX      Horizontal position of every point (modified)
+ * @param  [ in]pY      Vertical position of every point (modified)
+ * @param  [ in]flags   TEMPLATES_ANY_ROTATION, or 0
+ * @param  [ in]minSize Smallest accepted size (before scaling), in sub-pixels
+ * @return              GFMRV_TRUE, GFMRV_FALSE (the path is too small)
+ */
+static gfmRV templates_normalize(short *pPoints, int *pX, int *pY, int flags,
+        int minSize) {
+    /** Centroid */
+    int cx, cy;
+    /** Bounding box */
+    int minX, minY, maxX, maxY;
+    /** Size of the largest dimension */
+    int size;
+    /** Iterate through the points */
+    int i;
+
+    cx = 0;
+    cy = 0;
+    i = 0;
+    while (i < TEMPLATES_POINTS) {
+        cx += pX[i];
+        cy += pY[i];
+        i++;
+    }
+    cx /= TEMPLATES_POINTS;
+    cy /= TEMPLATES_POINTS;
+    i = 0;
+    while (i < TEMPLATES_POINTS) {
+        pX[i] -= cx;
+        pY[i] -= cy;
+        i++;
+    }
+
+    if (flags & TEMPLATES_ANY_ROTATION) {
+        /** Rotation that moves the first point onto the horizontal axis */
+        int64_t c, s;
+        /** The indicative angle */
+        unsigned short ang;
+
+        ang = templates_getAngle(pX[0], pY[0]);
+        c = templates_getSin((unsigned short)(ang + TEMPLATES_QUARTER));
+        s = templates_getSin(ang);
+        i = 0;
+        while (i < TEMPLATES_POINTS) {
+            /** The rotated point */
+            int x, y;
+
+            x = (int)((pX[i] * c + pY[i] * s) / TEMPLATES_ONE);
+            y = (int)((pY[i] * c - pX[i] * s) / TEMPLATES_ONE);
+            pX[i] = x;
+            pY[i] = y;
+            i++;
+        }
+    }
+
+    minX = pX[0];
+    maxX = pX[0];
+    minY = pY[0];
+    maxY = pY[0];
+    i = 1;
+    while (i < TEMPLATES_POINTS) {
+        minX = (pX[i] < minX) ? pX[i] : minX;
+        maxX = (pX[i] > maxX) ? pX[i] : maxX;
+        minY = (pY[i] < minY) ? pY[i] : minY;
+        maxY = (pY[i] > maxY) ? pY[i] : maxY;
+        i++;
+    }
+    size = (maxX - minX > maxY - minY) ? maxX - minX : maxY - minY;
+    if (size <= 0 || size < minSize) {
+        return GFMRV_FALSE;
+    }
+
+    /* Uniformly, so the proportions (e.g., of a straight line) are kept */
+    i = 0;
+    while (i < TEMPLATES_POINTS) {
+        pPoints[i * 2] = (short)((int64_t)pX[i] * TEMPLATES_UNIT / size);
+        pPoints[i * 2 + 1] = (short)((int64_t)pY[i] * TEMPLATES_UNIT / size);
+        i++;
+    }
+
+    return GFMRV_TRUE;
+}
+
+/**
+ * Calculate the mean squared distance between two normalized paths (4 points
+ * at a time with SSE2, if available). Since it's summed as integers, the
+ * result doesn't depend on the order of the sum
+ *
+ * @param  [ in]pPoints0 The first path, as interleaved positions
+ * @param  [ in]pPoints1 The second path, as interleaved positions
+ * @return               The distance
+ */
+static int templates_getDistance(const short *pPoints0,
+        const short *pPoints1) {
+    /** Sum of the squared distances */
+    int sum;
+    /** Iterate through the points */
+    int i;
+
+#if defined(__SSE2__)
+    /** Partial sums */
+    int pSum[4];
+    /** Accumulated partial sums */
+    __m128i acc;
+
+    acc = _mm_setzero_si128();
+    i = 0;
+    while (i < TEMPLATES_POINTS * 2) {
+        /** Distance on each axis (of 4 points) */
+        __m128i d;
+
+        d = _mm_sub_epi16(_mm_loadu_si128((const __m128i*)(pPoints0 + i)),
+                _mm_loadu_si128((const __m128i*)(pPoints1 + i)));
+        /* dx * dx + dy * dy of each point */
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+        i += 8;
+    }
+    _mm_storeu_si128((__m128i*)pSum, acc);
+    sum = pSum[0] + pSum[1] + pSum[2] + pSum[3];
+#else
+    sum = 0;
+    i = 0;
+    while (i < TEMPLATES_POINTS * 2) {
+        /** Distance on each axis */
+        int dx, dy;
+
+        dx = pPoints0[i] - pPoints1[i];
+        dy = pPoints0[i + 1] - pPoints1[i + 1];
+        sum += dx * dx + dy * dy;
+        i += 2;
+    }
+#endif
+
+    return sum / TEMPLATES_POINTS;
+}
+
+/**
+ * Normalize and add a template. A type may have as many templates as needed
+ * (e.g., to accept a gesture starting in any direction)
+ *
+ * @param  [ in]pCtx    The template set
+ * @param  [ in]type    Item recognized by the template
+ * @param  [ in]pPoints The template's path, as interleaved horizontal and
+ *                      vertical positions (in any scale)
+ * @param  [ in]num     Number of points in the path
+ * @param  [ in]flags   TEMPLATES_ANY_ROTATION, or 0
+ * @return              GFraMe return value
+ */
+gfmRV templates_add(templateSet *pCtx, itemType type, const short *pPoints,
+        int num, int flags) {
+    /** The path, resampled */
+    int pX[TEMPLATES_POINTS], pY[TEMPLATES_POINTS];
+    /** Length of every segment of the path */
+    int pSeg[TEMPLATES_MAX_STROKE];
+    /** The new template */
+    struct stTemplate *pTemplate;
+    /** GFraMe return value */
+    gfmRV rv;
+    /** The path's length */
+    int length;
+
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(type >= 0 && type < T_MAX, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pPoints, GFMRV_ARGUMENTS_BAD);
+    ASSERT(num > 1 && num <= TEMPLATES_MAX_STROKE, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pCtx->num < TEMPLATES_MAX, GFMRV_ARGUMENTS_BAD);
+
+    length = templates_getSegments(pSeg, pPoints, num);
+    ASSERT(length >= TEMPLATES_POINTS - 1, GFMRV_ARGUMENTS_BAD);
+
+    pTemplate = &(pCtx->pTemplates[pCtx->num]);
+    templates_resample(pX, pY, pPoints, pSeg, num, length);
+    rv = templates_normalize(pTemplate->pPoints, pX, pY, flags, 0);
+    ASSERT(rv == GFMRV_TRUE, GFMRV_ARGUMENTS_BAD);
+    pTemplate->type = type;
+    pTemplate->flags = flags;
+    pCtx->num++;
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}
+
+/**
+ * Classify a stroke, retrieving every type whose template matched it (ordered
+ * from the best match)
+ *
+ * @param  [out]pTypes  The matched types (T_NONE on the unused positions)
+ * @param  [ in]maxType How many types may be retrieved
+ * @param  [ in]pCtx    The template set
+ * @param  [ in]pPoints The stroke, as interleaved horizontal and vertical
+ *                      positions (in pixels)
+ * @param  [ in]num     Number of points in the stroke
+ * @return              GFraMe return value
+ */
+gfmRV templates_match(itemType *pTypes, int maxType, templateSet *pCtx,
+        const short *pPoints, int num) {
+    /** The stroke, resampled */
+    int pX[TEMPLATES_POINTS], pY[TEMPLATES_POINTS];
+    /** A copy of the resampled stroke (as normalizing modifies it) */
+    int pRotX[TEMPLATES_POINTS], pRotY[TEMPLATES_POINTS];
+    /** The stroke, normalized as is */
+    short pNorm[TEMPLATES_POINTS * 2];
+    /** The stroke, normalized and rotated to its indicative angle */
+    short pRotNorm[TEMPLATES_POINTS * 2];
+    /** Best distance to each type */
+    int pBest[T_MAX];
+    /** Length of every segment of the stroke */
+    int pSeg[TEMPLATES_MAX_STROKE];
+    /** GFraMe return value */
+    gfmRV rv;
+    /** Length of the stroke and up to the current starting point */
+    int length, start;
+    /** Whether each normalized stroke is valid */
+    int isValid, isRotValid;
+    /** The current and the previous starting point */
+    int first, lastFirst;
+    /** Iterate through the windows, templates and types */
+    int i, j;
+
+    ASSERT(pTypes, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pCtx, GFMRV_ARGUMENTS_BAD);
+    ASSERT(pPoints || num == 0, GFMRV_ARGUMENTS_BAD);
+    ASSERT(num <= TEMPLATES_MAX_STROKE, GFMRV_ARGUMENTS_BAD);
+
+    i = 0;
+    while (i < maxType) {
+        pTypes[i] = T_NONE;
+        i++;
+    }
+    i = 0;
+    while (i < T_MAX) {
+        pBest[i] = TEMPLATES_THRESHOLD;
+        i++;
+    }
+
+    length = 0;
+    if (num > 0) {
+        length = templates_getSegments(pSeg, pPoints, num);
+    }
+
+    /* Try the stroke from a few points along it (from the whole stroke to
+     * only its end) */
+    first = 0;
+    lastFirst = -1;
+    start = 0;
+    i = 0;
+    while (i < TEMPLATES_WINDOWS && length - start >= TEMPLATES_MIN_LENGTH) {
+        /** Where the current window should start */
+        int target;
+
+        target = (int)((int64_t)length * i / TEMPLATES_WINDOWS);
+        while (first < num - 1 && start + pSeg[first + 1] <= target) {
+            start += pSeg[first + 1];
+            first++;
+        }
+        i++;
+        if (first == lastFirst || length - start < TEMPLATES_MIN_LENGTH) {
+            continue;
+        }
+        lastFirst = first;
+
+        templates_resample(pX, pY, pPoints + first * 2, pSeg + first,
+                num - first, length - start);
+        j = 0;
+        while (j < TEMPLATES_POINTS) {
+            pRotX[j] = pX[j];
+            pRotY[j] = pY[j];
+            j++;
+        }
+        isValid = (templates_normalize(pNorm, pX, pY, 0,
+                TEMPLATES_MIN_SIZE) == GFMRV_TRUE);
+        isRotValid = (templates_normalize(pRotNorm, pRotX, pRotY,
+                TEMPLATES_ANY_ROTATION, TEMPLATES_MIN_SIZE) == GFMRV_TRUE);
+
+        j = 0;
+        while (j < pCtx->num) {
+            /** The template */
+            struct stTemplate *pTemplate;
+            /** Distance to the template */
+            int dist;
+
+            pTemplate = &(pCtx->pTemplates[j]);
+            j++;
+            if (pTemplate->flags & TEMPLATES_ANY_ROTATION) {
+                if (!isRotValid) {
+                    continue;
+                }
+                dist = templates_getDistance(pRotNorm, pTemplate->pPoints);
+            }
+            else {
+                if (!isValid) {
+                    continue;
+                }
+                dist = templates_getDistance(pNorm, pTemplate->pPoints);
+            }
+
+            if (dist < pBest[pTemplate->type]) {
+                pBest[pTemplate->type] = dist;
+            }
+        }
+    }
+
+    /* Retrieve the matched types, from the best one */
+    i = 0;
+    while (i < maxType) {
+        /** The best type not yet retrieved */
+        int best;
+
+        best = -1;
+        j = 0;
+        while (j < T_MAX) {
+            if (pBest[j] < TEMPLATES_THRESHOLD &&
+                    (best == -1 || pBest[j] < pBest[best])) {
+                best = j;
+            }
+            j++;
+        }
+        if (best == -1) {
+            break;
+        }
+        pTypes[i] = (itemType)best;
+        pBest[best] = TEMPLATES_THRESHOLD;
+        i++;
+    }
+
+    rv = GFMRV_OK;
+__ret:
+    return rv;
+}